@@ -0,0 +1,204 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <algorithm>
+#include "../src/core/ConfigManager.h"
+#include "../src/modules/AppsSearch.h"
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+// Load a catalog of 50k apps into Apps Search, in a new process for each run, from its JSON and from its snapshot.
+//
+// A JSON run starts without the snapshot: the catalog is parsed and indexed, and the snapshot is written. A snapshot run
+// maps the snapshot the previous runs wrote. Each run reports the time initialize takes and the resident memory it adds,
+// and their median and 95th percentile are printed for each kind of run.
+
+namespace
+{
+    constexpr auto LOAD_ARGUMENT = "--load";
+    constexpr int DEFAULT_RUN_COUNT = 10;
+    constexpr int APP_COUNT = 50000;
+
+    struct Sample
+    {
+        qint64 time; // In ns.
+        qint64 memory; // In bytes.
+    };
+
+    /**
+     * Get the resident memory of the process.
+     *
+     * @return The size in bytes; 0 if it is unknown.
+     */
+    qint64 residentMemory()
+    {
+#ifdef Q_OS_WIN
+        PROCESS_MEMORY_COUNTERS counters;
+        return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? static_cast<qint64>(counters.WorkingSetSize) : 0;
+#else
+        QFile statm("/proc/self/statm");
+        if (!statm.open(QIODevice::ReadOnly))
+            return 0;
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        return fields.size() > 1 ? fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE) : 0;
+#endif
+    }
+
+    /**
+     * Initialize Apps Search as the launcher does, and print the time it took and the resident memory it added.
+     *
+     * @param argc The argument count of the process.
+     * @param argv The arguments of the process.
+     * @return The exit code of the process.
+     */
+    int runLoad(int argc, char *argv[])
+    {
+        QCoreApplication app(argc, argv);
+        QCoreApplication::setApplicationName("Launcher");
+        QStandardPaths::setTestModeEnabled(true); // Keep away from the configuration of the installed launcher.
+
+        AppsSearch module;
+        const qint64 memoryBefore = residentMemory();
+        QElapsedTimer timer;
+        timer.start();
+        module.initialize();
+        const qint64 time = timer.nsecsElapsed();
+        QTextStream(stdout) << time << '\t' << residentMemory() - memoryBefore << '\n';
+        return 0;
+    }
+
+    /**
+     * Write a catalog of synthetic apps as the configuration of Apps Search.
+     *
+     * @return True if the catalog was written.
+     */
+    bool writeCatalog()
+    {
+        const QStringList vendors = {"Adobe", "Microsoft", "JetBrains", "Mozilla", "Google", "Autodesk", "Oracle", "Corel", "Valve", "Zoom"};
+        const QStringList products = {"Studio", "Viewer", "Editor", "Manager", "Player", "Designer", "Browser", "Console", "Monitor", "Assistant"};
+        QJsonArray appsArray;
+        for (int appIndex = 0; appIndex < APP_COUNT; ++appIndex)
+        {
+            const QString &vendor = vendors.at(appIndex % vendors.size());
+            const QString &product = products.at(appIndex / vendors.size() % products.size());
+            const QString name = QString("%1 %2 %3").arg(vendor, product).arg(appIndex);
+            QJsonObject appObject;
+            appObject["name"] = name;
+            appObject["path"] = QString("C:/Program Files/%1/%2 %3/app.exe").arg(vendor, product).arg(appIndex);
+            appObject["keywords"] = QJsonArray{QString("%1%2%3").arg(vendor.at(0), product.at(0)).arg(appIndex)};
+            appsArray.append(appObject);
+        }
+        QJsonObject rootObject;
+        rootObject["apps"] = appsArray;
+        const AppsSearch module;
+        return ConfigManager::saveConfig(&module, QJsonDocument(rootObject));
+    }
+
+    /**
+     * Run a load in a new process.
+     *
+     * @param program The path to this benchmark.
+     * @param sample Set to the time and the memory of the load.
+     * @return True if the process succeeded.
+     */
+    bool measureLoad(const QString &program, Sample &sample)
+    {
+        QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+        environment.insert("QT_LOGGING_RULES", "*.info=false");
+        QProcess process;
+        process.setProcessEnvironment(environment);
+        process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        process.start(program, {LOAD_ARGUMENT});
+        if (!process.waitForFinished(120000) || process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0)
+            return false;
+
+        const QList<QByteArray> fields = process.readAllStandardOutput().trimmed().split('\t');
+        if (fields.size() != 2)
+            return false;
+        sample = {fields.at(0).toLongLong(), fields.at(1).toLongLong()};
+        return true;
+    }
+
+    /**
+     * Get a percentile of samples, by the nearest rank.
+     *
+     * @param samples The samples, sorted.
+     * @param percentile The percentile, in (0, 100].
+     * @return The sample at the percentile.
+     */
+    qint64 percentileOf(const QVector<qint64> &samples, const int percentile)
+    {
+        const auto rank = static_cast<qsizetype>((samples.size() * percentile + 99) / 100);
+        return samples.at(std::max<qsizetype>(rank, 1) - 1);
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && qstrcmp(argv[1], LOAD_ARGUMENT) == 0)
+        return runLoad(argc, argv);
+
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Time the loading of a catalog of 50k apps from JSON and from the snapshot, and measure its resident memory.");
+    parser.addHelpOption();
+    const QCommandLineOption runsOption("runs", "The number of runs of each kind.", "count", QString::number(DEFAULT_RUN_COUNT));
+    parser.addOption(runsOption);
+    parser.process(app);
+    const int runCount = std::max(1, parser.value(runsOption).toInt());
+
+    // The configuration the runs use, as seen by them.
+    QCoreApplication::setApplicationName("Launcher");
+    QStandardPaths::setTestModeEnabled(true);
+    if (!writeCatalog())
+    {
+        qCritical() << "Apps catalog bench: failed to write the catalog";
+        return 1;
+    }
+    const QString configPath = ConfigManager::getConfigPath(R"(Modules\Apps Search.json)");
+    const QString snapshotPath = configPath.left(configPath.lastIndexOf('.')) + ".snapshot";
+
+    const QStringList kinds = {"JSON", "snapshot"};
+    QVector<qint64> times[2], memories[2];
+    for (const int isSnapshot : {0, 1})
+    {
+        for (int run = 0; run < runCount; ++run)
+        {
+            if (!isSnapshot)
+                QFile::remove(snapshotPath);
+            Sample sample;
+            if (!measureLoad(QCoreApplication::applicationFilePath(), sample))
+            {
+                qCritical() << "Apps catalog bench:" << kinds.at(isSnapshot) << "run" << run + 1 << "failed";
+                return 1;
+            }
+            times[isSnapshot].append(sample.time);
+            memories[isSnapshot].append(sample.memory);
+        }
+        std::sort(times[isSnapshot].begin(), times[isSnapshot].end());
+        std::sort(memories[isSnapshot].begin(), memories[isSnapshot].end());
+    }
+    QFile::remove(configPath);
+    QFile::remove(snapshotPath);
+
+    QTextStream out(stdout);
+    const auto toMilliseconds = [](const qint64 nanoseconds) { return QString::number(nanoseconds / 1e6, 'f', 1).rightJustified(10); };
+    const auto toMegabytes = [](const qint64 bytes) { return QString::number(bytes / 1048576.0, 'f', 1).rightJustified(10); };
+    out << QString("Loading %1 apps over %2 runs of each kind\n").arg(APP_COUNT).arg(runCount);
+    out << QString("%1%2%3%4  source\n").arg("median ms", 10).arg("p95 ms", 10).arg("median MB", 10).arg("p95 MB", 10);
+    for (const int isSnapshot : {0, 1})
+        out << toMilliseconds(percentileOf(times[isSnapshot], 50)) << toMilliseconds(percentileOf(times[isSnapshot], 95))
+            << toMegabytes(percentileOf(memories[isSnapshot], 50)) << toMegabytes(percentileOf(memories[isSnapshot], 95)) << "  " << kinds.at(isSnapshot)
+            << '\n';
+    return 0;
+}
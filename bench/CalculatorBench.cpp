@@ -0,0 +1,81 @@
+#include <QSignalSpy>
+#include <QStringList>
+#include <QTest>
+#include "../src/modules/Calculator.h"
+#include "../third-party/muparser/include/muParser.h"
+
+namespace
+{
+    // Searches for apps and commands, as the global Calculator sees them keystroke by keystroke.
+    const QStringList SEARCHES = {"firefox", "visual studio code", "notepad", "windows terminal", "control panel", "settings", "spotify", "shutdown"};
+} // namespace
+
+/**
+ * @class CalculatorBench
+ * @brief Compare the cost of the keystrokes of searches which are not math.
+ *
+ * Each benchmark runs every keystroke of the searches once; there are 84 of
+ * them. Calculator rejects them with its lexical pre-screen; before, each one
+ * built a new parser and threw from its evaluation.
+ */
+class CalculatorBench final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void parseEachKeystroke();
+    void preScreenEachKeystroke();
+
+private:
+    Calculator m_calculator;
+    QStringList m_keystrokes; // The texts of the keystrokes, in typing order.
+};
+
+void CalculatorBench::initTestCase()
+{
+    m_calculator.initialize();
+    for (const QString &search : SEARCHES)
+        for (qsizetype length = 1; length <= search.size(); ++length)
+            m_keystrokes.append(search.left(length));
+}
+
+/**
+ * Query as Calculator did before the pre-screen: a new parser for each keystroke,
+ * which throws as the text is not an expression.
+ */
+void CalculatorBench::parseEachKeystroke()
+{
+    QBENCHMARK
+    {
+        for (const QString &keystroke : std::as_const(m_keystrokes))
+        {
+            try
+            {
+                mu::Parser parser;
+                parser.SetExpr(keystroke.toStdWString());
+                parser.Eval();
+            }
+            catch (mu::Parser::exception_type &)
+            {
+            }
+        }
+    }
+}
+
+/**
+ * Query Calculator, which rejects each keystroke before any parser work.
+ */
+void CalculatorBench::preScreenEachKeystroke()
+{
+    const QSignalSpy spy(&m_calculator, &IModule::resultsReady);
+    QBENCHMARK
+    {
+        for (const QString &keystroke : std::as_const(m_keystrokes))
+            m_calculator.query(keystroke, QueryToken());
+    }
+    QCOMPARE(spy.count(), 0);
+}
+
+QTEST_MAIN(CalculatorBench)
+#include "CalculatorBench.moc"
@@ -0,0 +1,162 @@
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTest>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include "../src/modules/EverythingSearch.h"
+#include "../src/modules/filesearch/SyntheticFileSearchBackend.h"
+
+namespace
+{
+    constexpr int SYNTHETIC_FILE_COUNT = 1000000;
+    constexpr int CANCELLATION_RUN_COUNT = 30;
+
+    /**
+     * Run a query of a module to its end.
+     *
+     * @param module The module.
+     * @param text The search text.
+     * @param generation The generation of the query; the query is cancelled once it changes.
+     */
+    void runQuery(IModule *module, const QString &text, const std::shared_ptr<std::atomic<quint64>> &generation)
+    {
+        module->query(text, QueryToken(generation, generation->load()));
+    }
+} // namespace
+
+/**
+ * @class FileSearchBench
+ * @brief Search files with Everything Search, on the synthetic corpus of a million files.
+ *
+ * The latency of the first and the next page of a keystroke, the time a
+ * cancelled query keeps running, and the throughput of typing a search are
+ * measured through the module, as QueryDispatcher drives it.
+ */
+class FileSearchBench final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void firstPage_data();
+    void firstPage();
+    void nextPage();
+    void cancellation_data();
+    void cancellation();
+    void typing();
+
+private:
+    std::unique_ptr<EverythingSearch> m_module;
+    std::shared_ptr<std::atomic<quint64>> m_generation = std::make_shared<std::atomic<quint64>>(0);
+};
+
+void FileSearchBench::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    m_module = std::make_unique<EverythingSearch>(std::make_unique<SyntheticFileSearchBackend>(SYNTHETIC_FILE_COUNT));
+    m_module->initialize(); // Generates the corpus.
+}
+
+void FileSearchBench::firstPage_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addRow("common word") << "report";
+    QTest::addRow("two words") << "budget notes";
+    QTest::addRow("rare number") << "123456";
+    QTest::addRow("no match") << "qqq";
+}
+
+/**
+ * Search the first page of a keystroke, as every keystroke does.
+ */
+void FileSearchBench::firstPage()
+{
+    QFETCH(QString, text);
+    {
+        const QSignalSpy spy(m_module.get(), &IModule::resultsReady);
+        runQuery(m_module.get(), text, m_generation);
+        QCOMPARE(spy.count(), 1);
+    }
+
+    QBENCHMARK
+    {
+        runQuery(m_module.get(), text, m_generation);
+    }
+}
+
+/**
+ * Fetch the second page of a keystroke, as scrolling to the end of the list does.
+ */
+void FileSearchBench::nextPage()
+{
+    const QueryToken token(m_generation, m_generation->load());
+    QBENCHMARK
+    {
+        m_module->fetchMore("report", 10, token);
+    }
+}
+
+void FileSearchBench::cancellation_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addRow("common word") << "report";
+    QTest::addRow("two words") << "budget notes";
+}
+
+/**
+ * Cancel a query halfway, as the next keystroke does, and measure how long it keeps
+ * running. The result is the median over the runs, in ns.
+ */
+void FileSearchBench::cancellation()
+{
+    QFETCH(QString, text);
+
+    QElapsedTimer timer;
+    timer.start();
+    runQuery(m_module.get(), text, m_generation);
+    const qint64 queryDuration = timer.nsecsElapsed();
+
+    QVector<qint64> latencies;
+    for (int run = 0; run < CANCELLATION_RUN_COUNT; ++run)
+    {
+        std::atomic<qint64> returnedAt = 0;
+        QThread *thread = QThread::create(
+            [this, &text, &timer, &returnedAt]
+            {
+                runQuery(m_module.get(), text, m_generation);
+                returnedAt = timer.nsecsElapsed();
+            });
+        timer.restart();
+        thread->start();
+        QThread::usleep(static_cast<unsigned long>(queryDuration / 2000));
+        const qint64 cancelledAt = timer.nsecsElapsed();
+        m_generation->fetch_add(1);
+        thread->wait();
+        delete thread;
+        if (returnedAt > cancelledAt) // Otherwise the query ended before it was cancelled.
+            latencies.append(returnedAt - cancelledAt);
+    }
+    QVERIFY(!latencies.isEmpty());
+
+    std::sort(latencies.begin(), latencies.end());
+    QTest::setBenchmarkResult(static_cast<qreal>(latencies.at(latencies.size() / 2)), QTest::WalltimeNanoseconds);
+}
+
+/**
+ * Type a search keystroke by keystroke, each query running to its end.
+ */
+void FileSearchBench::typing()
+{
+    const QString text = "budget report 2024";
+    QBENCHMARK
+    {
+        for (qsizetype length = 1; length <= text.size(); ++length)
+            runQuery(m_module.get(), text.left(length), m_generation);
+    }
+}
+
+QTEST_MAIN(FileSearchBench)
+#include "FileSearchBench.moc"
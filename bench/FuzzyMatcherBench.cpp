@@ -0,0 +1,74 @@
+#include <QTest>
+#include <QVector>
+#include "../src/utils/FuzzyMatcher.h"
+
+namespace
+{
+    constexpr int APP_COUNT = 20000;
+} // namespace
+
+/**
+ * @class FuzzyMatcherBench
+ * @brief Match each keystroke of searches against a synthetic catalog of 20k app names.
+ *
+ * Each row is one keystroke, matched against every name as the scan for
+ * subsequence matches of Apps Search does, so its result is the latency of the
+ * keystroke in the worst case, without the trigram index narrowing the names.
+ */
+class FuzzyMatcherBench final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void keystroke_data();
+    void keystroke();
+
+private:
+    QVector<FuzzyMatcher::Target> m_targets;
+};
+
+void FuzzyMatcherBench::initTestCase()
+{
+    const QStringList vendors = {"Adobe", "Microsoft", "JetBrains", "Mozilla", "Google", "Autodesk", "Oracle", "Corel", "Valve", "Zoom"};
+    const QStringList products = {"Studio", "Viewer", "Editor", "Manager", "Player", "Designer", "Browser", "Console", "Monitor", "Assistant"};
+    m_targets.reserve(APP_COUNT);
+    for (int appIndex = 0; appIndex < APP_COUNT; ++appIndex)
+        m_targets.append(FuzzyMatcher::prepare(
+            QString("%1 %2 %3").arg(vendors.at(appIndex % vendors.size()), products.at(appIndex / vendors.size() % products.size())).arg(appIndex)));
+}
+
+void FuzzyMatcherBench::keystroke_data()
+{
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<bool>("isRejected");
+    QStringList keystrokes;
+    for (const QString &search : {QString("microsoft studio"), QString("mss"), QString("zoom player 1999")})
+        for (qsizetype length = 1; length <= search.size(); ++length)
+            keystrokes.append(search.left(length));
+    keystrokes.removeDuplicates();
+    for (const QString &keystroke : std::as_const(keystrokes))
+        QTest::addRow("%s", qPrintable(keystroke)) << keystroke << false;
+    QTest::addRow("rejected by the mask") << "xq" << true;
+}
+
+/**
+ * Match a keystroke against every name of the catalog.
+ */
+void FuzzyMatcherBench::keystroke()
+{
+    QFETCH(QString, pattern);
+    QFETCH(bool, isRejected);
+    const FuzzyMatcher matcher(pattern);
+    int matchCount = 0;
+    QBENCHMARK
+    {
+        matchCount = 0;
+        for (const FuzzyMatcher::Target &target : std::as_const(m_targets))
+            matchCount += matcher.match(target) > 0 ? 1 : 0;
+    }
+    QCOMPARE(matchCount == 0, isRejected);
+}
+
+QTEST_GUILESS_MAIN(FuzzyMatcherBench)
+#include "FuzzyMatcherBench.moc"
@@ -0,0 +1,152 @@
+#include <QListWidgetItem>
+#include <QMap>
+#include <QRandomGenerator>
+#include <QStandardPaths>
+#include <QTest>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "../src/core/HistoryManager.h"
+#include "../src/widgets/ResultListModel.h"
+
+namespace
+{
+    constexpr int RESULT_COUNT = 1000;
+    constexpr int BATCH_COUNT = 5; // About the number of global modules answering a keystroke.
+    constexpr double HISTORY_WEIGHT = 1.0;
+
+    /**
+     * Make results with varied priorities and scores, a fifth of them in history.
+     *
+     * @return The results, in arrival order.
+     */
+    QVector<ResultItem> makeResults()
+    {
+        QRandomGenerator random(42);
+        QVector<ResultItem> results;
+        results.reserve(RESULT_COUNT);
+        for (int index = 0; index < RESULT_COUNT; ++index)
+        {
+            ResultItem item;
+            item.title = QString("Result %1").arg(index);
+            item.subtitle = QString("C:\\Program Files\\Vendor %1\\result%2.exe").arg(index % 37).arg(index);
+            item.iconType = IconType::Font;
+            item.iconGlyph = QChar(0xe5c3);
+            item.key = QString("result_%1").arg(index);
+            item.payload = item.subtitle;
+            item.priority = QList<double>{0.5, 0.8, 1.0}.at(index % 3);
+            item.score = 1.0 + random.bounded(1.0);
+            results.append(item);
+        }
+        return results;
+    }
+} // namespace
+
+/**
+ * @class ResultListModelBench
+ * @brief Compare ranking results by a precomputed key against unpacking them at each comparison.
+ */
+class ResultListModelBench final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void sortByItemComparator();
+    void mergeByRankKey();
+    void mergeBatchesByRankKey();
+
+private:
+    QVector<ResultItem> m_results;
+};
+
+void ResultListModelBench::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    HistoryManager::initHistory(0.95, 10000, 1.0, HISTORY_WEIGHT);
+    m_results = makeResults();
+    for (int index = 0; index < RESULT_COUNT; index += 5)
+        HistoryManager::addHistory(m_results.at(index).key);
+}
+
+/**
+ * Sort as QListWidget sorted the former result items: each comparison copied the
+ * QVariant of both items and unpacked it six times, and looked up both history
+ * scores in a QMap by key and took their logarithm, as ResultItemWidget::operator<
+ * and HistoryManager::getHistoryScore did.
+ */
+void ResultListModelBench::sortByItemComparator()
+{
+    std::vector<QListWidgetItem> items;
+    items.reserve(m_results.size());
+    for (const ResultItem &item : std::as_const(m_results))
+        items.emplace_back().setData(Qt::UserRole, QVariant::fromValue(item));
+    QMap<QString, double> scores; // The history as it was kept, with the score of a single launch.
+    for (int index = 0; index < RESULT_COUNT; index += 5)
+        scores.insert(m_results.at(index).key, 1.0);
+
+    const auto historyScore = [&scores](const QString &key)
+    {
+        if (scores.contains(key))
+            return 1 + std::log(scores[key] + 1) * HISTORY_WEIGHT;
+        return 1.0;
+    };
+    const auto lessThan = [&historyScore](const QListWidgetItem *left, const QListWidgetItem *right)
+    {
+        const double leftPriority = left->data(Qt::UserRole).value<ResultItem>().priority;
+        const double rightPriority = right->data(Qt::UserRole).value<ResultItem>().priority;
+        const double leftScore = left->data(Qt::UserRole).value<ResultItem>().score;
+        const double rightScore = right->data(Qt::UserRole).value<ResultItem>().score;
+        const QString leftKey = left->data(Qt::UserRole).value<ResultItem>().key;
+        const QString rightKey = right->data(Qt::UserRole).value<ResultItem>().key;
+        const double leftHistoryScore = historyScore(leftKey);
+        const double rightHistoryScore = historyScore(rightKey);
+        return leftPriority * leftScore * leftHistoryScore < rightPriority * rightScore * rightHistoryScore;
+    };
+
+    QVector<const QListWidgetItem *> sorted;
+    QBENCHMARK
+    {
+        sorted.clear();
+        for (const QListWidgetItem &item : items)
+            sorted.append(&item);
+        std::stable_sort(sorted.begin(), sorted.end(), lessThan);
+    }
+}
+
+/**
+ * Rank the results once and merge them into an empty model, as one batch.
+ */
+void ResultListModelBench::mergeByRankKey()
+{
+    ResultListModel model;
+    QBENCHMARK
+    {
+        model.clear();
+        model.mergeBatches({m_results});
+    }
+    QCOMPARE(model.rowCount(), RESULT_COUNT);
+}
+
+/**
+ * Rank the results once and merge them into an empty model, split into the
+ * batches of several modules.
+ */
+void ResultListModelBench::mergeBatchesByRankKey()
+{
+    QVector<QVector<ResultItem>> batches(BATCH_COUNT);
+    for (int index = 0; index < m_results.size(); ++index)
+        batches[index % BATCH_COUNT].append(m_results.at(index));
+
+    ResultListModel model;
+    QBENCHMARK
+    {
+        model.clear();
+        model.mergeBatches(batches);
+    }
+    QCOMPARE(model.rowCount(), RESULT_COUNT);
+}
+
+QTEST_MAIN(ResultListModelBench)
+#include "ResultListModelBench.moc"
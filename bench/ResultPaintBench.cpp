@@ -0,0 +1,145 @@
+#include <QApplication>
+#include <QImage>
+#include <QListView>
+#include <QPixmapCache>
+#include <QStandardPaths>
+#include <QTest>
+#include "../src/common/Constants.h"
+#include "../src/common/IModule.h"
+#include "../src/core/HistoryManager.h"
+#include "../src/core/ThemeManager.h"
+#include "../src/widgets/ResultItemDelegate.h"
+#include "../src/widgets/ResultListModel.h"
+
+namespace
+{
+    constexpr int ROW_HEIGHT = PADDING_S + BUTTON_SIZE + PADDING_S + PADDING_S; // With the spacing of the list, as in Launcher.
+
+    /**
+     * @class BenchModule
+     * @brief A module providing the actions of the results, like Apps Search.
+     */
+    class BenchModule final : public IModule
+    {
+    public:
+        BenchModule()
+        {
+            Action openAction;
+            openAction.description = "Open";
+            Action openAdminAction;
+            openAdminAction.description = "Open as admin";
+            openAdminAction.iconGlyph = QChar(0xe9e0); // Shield.
+            Action copyPathAction;
+            copyPathAction.description = "Copy path";
+            copyPathAction.iconGlyph = QChar(0xe14d); // Copy.
+            m_actions = {openAction, openAdminAction, copyPathAction};
+        }
+
+        [[nodiscard]] QString name() const override { return "Bench"; }
+        [[nodiscard]] QChar iconGlyph() const override { return QChar(0xe5c3); }
+        [[nodiscard]] const QVector<Action> &actions(const ResultItem &item) const override
+        {
+            Q_UNUSED(item)
+            return m_actions;
+        }
+        void query(const QString &text, const QueryToken &token) override
+        {
+            Q_UNUSED(text)
+            Q_UNUSED(token)
+        }
+
+    private:
+        QVector<Action> m_actions;
+    };
+} // namespace
+
+/**
+ * @class ResultPaintBench
+ * @brief Paint a page of results offscreen, as the list of Launcher does on each keystroke.
+ *
+ * Icons come from a stand-in IconCache which has every icon loaded. A cold
+ * paint renders every row; a warm paint finds them in the row cache.
+ */
+class ResultPaintBench final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void paintRows_data();
+    void paintRows();
+
+private:
+    BenchModule m_module;
+};
+
+void ResultPaintBench::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    HistoryManager::initHistory(0.95, 10000, 1.0, 1.0);
+    ThemeManager::initTheme();
+}
+
+void ResultPaintBench::paintRows_data()
+{
+    QTest::addColumn<int>("rowCount");
+    QTest::addColumn<bool>("isCold");
+    QTest::addColumn<qreal>("devicePixelRatio");
+    for (const int rowCount : {5, 20})
+        for (const qreal devicePixelRatio : {1.0, 1.5})
+        {
+            QTest::addRow("%d rows, cold, %.1fx", rowCount, devicePixelRatio) << rowCount << true << devicePixelRatio;
+            QTest::addRow("%d rows, warm, %.1fx", rowCount, devicePixelRatio) << rowCount << false << devicePixelRatio;
+        }
+}
+
+void ResultPaintBench::paintRows()
+{
+    QFETCH(int, rowCount);
+    QFETCH(bool, isCold);
+    QFETCH(qreal, devicePixelRatio);
+
+    // Apps with icons, and commands with glyphs.
+    QVector<ResultItem> results;
+    for (int index = 0; index < rowCount; ++index)
+    {
+        ResultItem item;
+        item.title = QString("Result with a long enough title %1").arg(index);
+        item.subtitle = QString("C:\\Program Files\\Vendor %1\\Application\\result%1.exe").arg(index);
+        item.iconType = index % 3 == 2 ? IconType::Font : IconType::Thumbnail;
+        item.iconGlyph = QChar(0xe5c3);
+        item.iconPath = item.subtitle;
+        item.key = QString("result_%1").arg(index);
+        item.module = &m_module;
+        results.append(item);
+    }
+
+    ResultListModel model;
+    model.mergeBatches({results});
+    QListView view;
+    ResultItemDelegate delegate(&view);
+    view.setModel(&model);
+    view.setItemDelegate(&delegate);
+    view.setSpacing(PADDING_S / 2);
+    view.setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    view.setStyleSheet(QString("QListView { border: none; background: transparent; padding: %1px; }").arg(PADDING_S / 2));
+    view.resize(WINDOW_WIDTH, rowCount * ROW_HEIGHT + PADDING_S);
+    view.setCurrentIndex(model.index(0));
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    QImage image(view.size() * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(devicePixelRatio);
+    QPixmapCache::clear();
+    view.render(&image); // Loads the fonts, and fills the row cache for a warm paint.
+
+    QBENCHMARK
+    {
+        if (isCold)
+            QPixmapCache::clear();
+        view.render(&image);
+    }
+}
+
+QTEST_MAIN(ResultPaintBench)
+#include "ResultPaintBench.moc"
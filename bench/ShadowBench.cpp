@@ -0,0 +1,120 @@
+#include <QApplication>
+#include <QGraphicsDropShadowEffect>
+#include <QImage>
+#include <QPainter>
+#include <QPixmapCache>
+#include <QTest>
+#include <QVBoxLayout>
+#include "../src/common/Constants.h"
+#include "../src/utils/PaintUtils.h"
+
+namespace
+{
+    // The frames of the window of Launcher, with the default of 5 visible results.
+    constexpr int SEARCH_FRAME_HEIGHT = PADDING_S + PADDING_S + BUTTON_SIZE + PADDING_S + PADDING_S;
+    constexpr int RESULTS_LIST_HEIGHT = 5 * (PADDING_S + PADDING_S + BUTTON_SIZE + PADDING_S) + PADDING_S;
+    constexpr int WINDOW_HEIGHT = WINDOW_MARGIN + SEARCH_FRAME_HEIGHT + PADDING_L + RESULTS_LIST_HEIGHT + WINDOW_MARGIN;
+    constexpr int WINDOW_FULL_WIDTH = WINDOW_MARGIN + WINDOW_WIDTH + WINDOW_MARGIN;
+
+    const QRect SEARCH_FRAME_RECT(WINDOW_MARGIN, WINDOW_MARGIN, WINDOW_WIDTH, SEARCH_FRAME_HEIGHT);
+    const QRect RESULTS_LIST_RECT(WINDOW_MARGIN, WINDOW_MARGIN + SEARCH_FRAME_HEIGHT + PADDING_L, WINDOW_WIDTH, RESULTS_LIST_HEIGHT);
+} // namespace
+
+/**
+ * @class ShadowBench
+ * @brief Paint the shadows of the window of Launcher, as its paintEvent does.
+ *
+ * The nine-slice shadows are measured cold, blurring their pixmaps on each
+ * paint, and cached, as on every paint but the first. The drop shadow effects
+ * they replaced are measured at the same size.
+ */
+class ShadowBench final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void drawShadow_data();
+    void drawShadow();
+    void dropShadowEffect_data();
+    void dropShadowEffect();
+};
+
+void ShadowBench::drawShadow_data()
+{
+    QTest::addColumn<bool>("isCold");
+    QTest::addColumn<qreal>("devicePixelRatio");
+    for (const qreal devicePixelRatio : {1.0, 1.5})
+    {
+        QTest::addRow("cold, %.1fx", devicePixelRatio) << true << devicePixelRatio;
+        QTest::addRow("cached, %.1fx", devicePixelRatio) << false << devicePixelRatio;
+    }
+}
+
+void ShadowBench::drawShadow()
+{
+    QFETCH(bool, isCold);
+    QFETCH(qreal, devicePixelRatio);
+
+    QImage image(QSize(WINDOW_FULL_WIDTH, WINDOW_HEIGHT) * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(devicePixelRatio);
+    const QColor shadowColor = QColor::fromRgbF(0, 0, 0, SHADOW_OPACITY);
+    QPixmapCache::clear();
+
+    QBENCHMARK
+    {
+        if (isCold)
+            QPixmapCache::clear();
+        image.fill(Qt::transparent);
+        QPainter painter(&image);
+        for (const QRect &rect : {SEARCH_FRAME_RECT, RESULTS_LIST_RECT})
+        {
+            PaintUtils::drawShadow(&painter, rect, CORNER_RADIUS_L, SHADOW_BLUR_RADIUS, SHADOW_OFFSET_V, shadowColor);
+            PaintUtils::drawRoundedRect(&painter, rect, CORNER_RADIUS_L, Qt::white);
+        }
+    }
+}
+
+void ShadowBench::dropShadowEffect_data()
+{
+    QTest::addColumn<qreal>("devicePixelRatio");
+    QTest::addRow("1.0x") << 1.0;
+    QTest::addRow("1.5x") << 1.5;
+}
+
+void ShadowBench::dropShadowEffect()
+{
+    QFETCH(qreal, devicePixelRatio);
+
+    // The frames as laid out before, each blurred by its own effect on every paint.
+    QWidget window;
+    window.setAttribute(Qt::WA_TranslucentBackground);
+    auto *layout = new QVBoxLayout(&window);
+    layout->setContentsMargins(WINDOW_MARGIN, WINDOW_MARGIN, WINDOW_MARGIN, WINDOW_MARGIN);
+    layout->setSpacing(PADDING_L);
+    for (const int height : {SEARCH_FRAME_HEIGHT, RESULTS_LIST_HEIGHT})
+    {
+        auto *frame = new QWidget(&window);
+        frame->setFixedSize(WINDOW_WIDTH, height);
+        frame->setStyleSheet(QString("background: white; border-radius: %1px;").arg(CORNER_RADIUS_L));
+        auto *effect = new QGraphicsDropShadowEffect(frame);
+        effect->setBlurRadius(SHADOW_BLUR_RADIUS);
+        effect->setColor(QColor::fromRgbF(0, 0, 0, SHADOW_OPACITY));
+        effect->setOffset(0, SHADOW_OFFSET_V);
+        frame->setGraphicsEffect(effect);
+        layout->addWidget(frame);
+    }
+    window.resize(WINDOW_FULL_WIDTH, WINDOW_HEIGHT);
+    window.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&window));
+
+    QImage image(window.size() * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(devicePixelRatio);
+    QBENCHMARK
+    {
+        image.fill(Qt::transparent);
+        window.render(&image, QPoint(), QRegion(), QWidget::DrawChildren);
+    }
+}
+
+QTEST_MAIN(ShadowBench)
+#include "ShadowBench.moc"
@@ -0,0 +1,160 @@
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+#include <memory>
+#include "../src/utils/ShellLinkParser.h"
+#ifdef Q_OS_WIN
+#include <shlobj.h>
+#include <windows.h>
+#endif
+
+namespace
+{
+    constexpr int DIRECTORY_COUNT = 40;
+    constexpr int LINKS_PER_DIRECTORY = 25;
+
+    // The shortcuts of tests/data which name their target, so that every link of the corpus parses.
+    const QStringList SAMPLES = {"local.lnk", "unicode.lnk", "relative.lnk", "environment.lnk"};
+
+#ifdef Q_OS_WIN
+    /**
+     * Resolve a shortcut as Apps Search did before ShellLinkParser: through IShellLink, with COM initialized for each shortcut.
+     *
+     * @param shortcutPath The path to the shortcut.
+     * @param targetPath Set to the path of the target.
+     * @return True if the shortcut was resolved.
+     */
+    bool resolveThroughCom(const QString &shortcutPath, QString &targetPath)
+    {
+        if (FAILED(CoInitialize(nullptr)))
+            return false;
+
+        bool isResolved = false;
+        IShellLinkW *shellLink = nullptr;
+        IPersistFile *persistFile = nullptr;
+        if (SUCCEEDED(CoCreateInstance(CLSID_ShellLink, nullptr, CLSCTX_INPROC_SERVER, IID_IShellLinkW, reinterpret_cast<void **>(&shellLink))) &&
+            SUCCEEDED(shellLink->QueryInterface(IID_IPersistFile, reinterpret_cast<void **>(&persistFile))) &&
+            SUCCEEDED(persistFile->Load(shortcutPath.toStdWString().c_str(), STGM_READ)) &&
+            SUCCEEDED(shellLink->Resolve(nullptr, SLR_NO_UI | SLR_NOUPDATE | SLR_NOSEARCH | SLR_NOTRACK)))
+        {
+            wchar_t path[MAX_PATH];
+            if (SUCCEEDED(shellLink->GetPath(path, MAX_PATH, nullptr, SLGP_UNCPRIORITY)))
+                targetPath = QString::fromWCharArray(path);
+            isResolved = true;
+        }
+
+        if (persistFile)
+            persistFile->Release();
+        if (shellLink)
+            shellLink->Release();
+        CoUninitialize();
+        return isResolved;
+    }
+#endif
+} // namespace
+
+/**
+ * @class ShellLinkParserBench
+ * @brief Read the targets of a Start Menu of 1000 shortcuts, copied from the shortcuts of tests/data.
+ *
+ * The shortcuts are spread over 40 directories, as applications install them.
+ * The shortcuts are parsed one by one, and walked in parallel as Apps Search
+ * does; on Windows, they are also resolved through IShellLink as before.
+ */
+class ShellLinkParserBench final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void parseEach();
+    void scanDirectories();
+    void resolveEachThroughCom();
+
+private:
+    std::unique_ptr<QTemporaryDir> m_corpus;
+    QStringList m_shortcutPaths;
+};
+
+void ShellLinkParserBench::initTestCase()
+{
+    const QString dataPath = QFINDTESTDATA("../tests/data");
+    QVERIFY(!dataPath.isEmpty());
+    m_corpus = std::make_unique<QTemporaryDir>();
+    QVERIFY(m_corpus->isValid());
+
+    const QDir corpus(m_corpus->path());
+    for (int directoryIndex = 0; directoryIndex < DIRECTORY_COUNT; ++directoryIndex)
+    {
+        const QString directory = QString("Vendor %1").arg(directoryIndex);
+        QVERIFY(corpus.mkdir(directory));
+        for (int linkIndex = 0; linkIndex < LINKS_PER_DIRECTORY; ++linkIndex)
+        {
+            const QString &sample = SAMPLES.at(linkIndex % SAMPLES.size());
+            QVERIFY(QFile::copy(QDir(dataPath).filePath(sample), corpus.filePath(QString("%1/App %2.lnk").arg(directory).arg(linkIndex))));
+        }
+    }
+
+    QDirIterator iterator(m_corpus->path(), {"*.lnk"}, QDir::Files, QDirIterator::Subdirectories);
+    while (iterator.hasNext())
+        m_shortcutPaths.append(iterator.next());
+    QCOMPARE(m_shortcutPaths.size(), DIRECTORY_COUNT * LINKS_PER_DIRECTORY);
+}
+
+/**
+ * Parse the shortcuts one by one, on one thread.
+ */
+void ShellLinkParserBench::parseEach()
+{
+    qsizetype parsedCount = 0;
+    QBENCHMARK
+    {
+        parsedCount = 0;
+        for (const QString &shortcutPath : std::as_const(m_shortcutPaths))
+        {
+            ShellLinkParser::ShellLink link;
+            parsedCount += ShellLinkParser::parse(shortcutPath, link) ? 1 : 0;
+        }
+    }
+    QCOMPARE(parsedCount, m_shortcutPaths.size());
+}
+
+/**
+ * Walk the directories and parse their shortcuts in parallel, as Apps Search does to build its default catalog.
+ */
+void ShellLinkParserBench::scanDirectories()
+{
+    qsizetype parsedCount = 0;
+    QBENCHMARK
+    {
+        parsedCount = ShellLinkParser::scanDirectories({m_corpus->path()}).size();
+    }
+    QCOMPARE(parsedCount, m_shortcutPaths.size());
+}
+
+/**
+ * Resolve the shortcuts one by one through IShellLink, as Apps Search did before ShellLinkParser.
+ */
+void ShellLinkParserBench::resolveEachThroughCom()
+{
+#ifdef Q_OS_WIN
+    qsizetype resolvedCount = 0;
+    QBENCHMARK
+    {
+        resolvedCount = 0;
+        for (const QString &shortcutPath : std::as_const(m_shortcutPaths))
+        {
+            QString targetPath;
+            resolvedCount += resolveThroughCom(QDir::toNativeSeparators(shortcutPath), targetPath) ? 1 : 0;
+        }
+    }
+    QCOMPARE(resolvedCount, m_shortcutPaths.size());
+#else
+    QSKIP("IShellLink is only available on Windows");
+#endif
+}
+
+QTEST_GUILESS_MAIN(ShellLinkParserBench)
+#include "ShellLinkParserBench.moc"
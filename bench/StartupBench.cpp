@@ -0,0 +1,172 @@
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFontDatabase>
+#include <QHash>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QTimer>
+#include <algorithm>
+#include "../src/app/Launcher.h"
+#include "../src/core/StartupTrace.h"
+
+// Time the startup of Launcher, with the stand-in modules of stubs/ModuleRegistry.cpp, in a new process for each run.
+//
+// A cold run starts without a configuration folder, as on the first launch: every default configuration is generated
+// and written. A warm run starts with the configuration of the previous runs. The phases are read from StartupTrace,
+// and their median and 95th percentile are printed for each kind of run.
+
+namespace
+{
+    constexpr auto STARTUP_ARGUMENT = "--startup";
+    constexpr int DEFAULT_RUN_COUNT = 20;
+
+    using Durations = QVector<QPair<QString, qint64>>; // The phases of a run in the order they started, with their durations in ns.
+
+    /**
+     * Start Launcher as main does, and print its phases once every module is initialized.
+     *
+     * @param argc The argument count of the process.
+     * @param argv The arguments of the process.
+     * @return The exit code of the process.
+     */
+    int runStartup(int argc, char *argv[])
+    {
+        StartupTrace::start();
+        StartupTrace::Scope applicationScope("application");
+        QApplication app(argc, argv);
+        applicationScope.end();
+
+        QCoreApplication::setApplicationName("Launcher");
+        QStandardPaths::setTestModeEnabled(true); // Keep away from the configuration of the installed launcher.
+
+        {
+            const StartupTrace::Scope scope("fonts");
+            QFontDatabase::addApplicationFont(":/fonts/MaterialSymbolsRounded-Regular.ttf");
+        }
+
+        StartupTrace::Scope windowScope("window");
+        Launcher launcher;
+        windowScope.end();
+
+        QTimer finishTimer;
+        QObject::connect(&finishTimer, &QTimer::timeout, &app, [] {
+            if (StartupTrace::isFinished())
+                QCoreApplication::quit();
+        });
+        finishTimer.start(1);
+        QApplication::exec();
+
+        QTextStream out(stdout);
+        for (const StartupTrace::Phase &phase : StartupTrace::finishedPhases())
+            out << QString(2 * phase.depth, ' ') << phase.name << (phase.isMainThread ? "" : " (worker)") << '\t' << phase.end - phase.start << '\n';
+        return 0;
+    }
+
+    /**
+     * Run a startup in a new process.
+     *
+     * @param program The path to this benchmark.
+     * @return The phases of the startup; empty if the process failed.
+     */
+    Durations measureStartup(const QString &program)
+    {
+        QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+        environment.insert("QT_QPA_PLATFORM", "offscreen");
+        QProcess process;
+        process.setProcessEnvironment(environment);
+        process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        process.start(program, {STARTUP_ARGUMENT});
+        if (!process.waitForFinished(60000) || process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0)
+            return {};
+
+        Durations durations;
+        for (const QString &line : QString::fromUtf8(process.readAllStandardOutput()).split('\n', Qt::SkipEmptyParts))
+            if (const qsizetype separator = line.lastIndexOf('\t'); separator > 0)
+                durations.append({line.left(separator), line.mid(separator + 1).trimmed().toLongLong()});
+        return durations;
+    }
+
+    /**
+     * Get a percentile of samples, by the nearest rank.
+     *
+     * @param samples The samples, sorted.
+     * @param percentile The percentile, in (0, 100].
+     * @return The sample at the percentile.
+     */
+    qint64 percentileOf(const QVector<qint64> &samples, const int percentile)
+    {
+        const auto rank = static_cast<qsizetype>((samples.size() * percentile + 99) / 100);
+        return samples.at(std::max<qsizetype>(rank, 1) - 1);
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && qstrcmp(argv[1], STARTUP_ARGUMENT) == 0)
+        return runStartup(argc, argv);
+
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Time the startup of Launcher over repeated cold and warm runs.");
+    parser.addHelpOption();
+    const QCommandLineOption runsOption("runs", "The number of runs of each kind.", "count", QString::number(DEFAULT_RUN_COUNT));
+    parser.addOption(runsOption);
+    parser.process(app);
+    const int runCount = std::max(1, parser.value(runsOption).toInt());
+
+    // The configuration folder the runs use, as seen by them.
+    QCoreApplication::setApplicationName("Launcher");
+    QStandardPaths::setTestModeEnabled(true);
+    const QString configDirectory = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
+
+    // The samples of each phase, by kind of run; the phases are listed in the order of the first run.
+    QStringList phaseNames;
+    QHash<QString, QVector<qint64>> samples[2];
+    for (const int isWarm : {0, 1})
+    {
+        QDir(configDirectory).removeRecursively();
+        if (isWarm)
+            measureStartup(QCoreApplication::applicationFilePath()); // Writes the configuration.
+
+        for (int run = 0; run < runCount; ++run)
+        {
+            if (!isWarm)
+                QDir(configDirectory).removeRecursively();
+            const Durations durations = measureStartup(QCoreApplication::applicationFilePath());
+            if (durations.isEmpty())
+            {
+                qCritical() << "Startup bench: run" << run + 1 << "failed";
+                return 1;
+            }
+            for (const auto &[name, duration] : durations)
+            {
+                if (!phaseNames.contains(name))
+                    phaseNames.append(name);
+                samples[isWarm][name].append(duration);
+            }
+        }
+    }
+    QDir(configDirectory).removeRecursively();
+
+    QTextStream out(stdout);
+    const auto toMilliseconds = [](const qint64 nanoseconds) { return QString::number(nanoseconds / 1e6, 'f', 1).rightJustified(8); };
+    out << QString("Startup over %1 cold and %1 warm runs, in ms\n").arg(runCount);
+    out << QString("%1%2%3%4  phase\n").arg("cold median", 12).arg("p95", 8).arg("warm median", 12).arg("p95", 8);
+    for (const QString &name : std::as_const(phaseNames))
+    {
+        QString line;
+        for (QHash<QString, QVector<qint64>> &kindSamples : samples)
+        {
+            QVector<qint64> &phaseSamples = kindSamples[name];
+            std::sort(phaseSamples.begin(), phaseSamples.end());
+            if (phaseSamples.isEmpty())
+                line += QString(20, ' ');
+            else
+                line += QString("    %1%2").arg(toMilliseconds(percentileOf(phaseSamples, 50)), toMilliseconds(percentileOf(phaseSamples, 95)));
+        }
+        out << line << "  " << name << '\n';
+    }
+    return 0;
+}
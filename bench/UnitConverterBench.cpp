@@ -0,0 +1,101 @@
+#include <QStringList>
+#include <QTest>
+#include "../src/modules/UnitConverter.h"
+
+namespace
+{
+    // Conversions as they are typed, from the common to the unusual forms of a measurement.
+    const QStringList CONVERSIONS = {"100 floz to ml", "5 km in mi",    "1/2 cup to ml", "72 degF to degC", "3m/s to km/h",
+                                     "2.5 kg to lb",   "60 mph to km/h", "1e3 m to km",   "12 in to cm",     "500 cal to J"};
+} // namespace
+
+/**
+ * @class UnitConverterBench
+ * @brief Compare the cost of the keystrokes of typing conversions.
+ *
+ * Each benchmark runs every keystroke of the conversions once. Unit Converter
+ * parses the units through its caches, warmed at startup; before, each
+ * keystroke parsed the measurement and the unit from scratch.
+ */
+class UnitConverterBench final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void parseEachKeystroke();
+    void cacheEachKeystroke();
+
+private:
+    UnitConverter m_converter;
+    QStringList m_keystrokes; // The texts of the keystrokes, in typing order.
+};
+
+void UnitConverterBench::initTestCase()
+{
+    m_converter.initialize();
+    for (const QString &conversion : CONVERSIONS)
+        for (qsizetype length = 1; length <= conversion.size(); ++length)
+            m_keystrokes.append(conversion.left(length));
+
+    // Every conversion of the corpus must succeed once typed.
+    QString title;
+    const QMetaObject::Connection connection =
+        connect(&m_converter, &IModule::resultsReady, this, [&title](const QVector<ResultItem> &results) { title = results.value(0).title; });
+    for (const QString &conversion : CONVERSIONS)
+    {
+        title.clear();
+        m_converter.query(conversion, QueryToken());
+        QVERIFY2(!title.isEmpty() && title != "Invalid unit conversion", qPrintable(conversion));
+    }
+    disconnect(connection);
+}
+
+/**
+ * Convert as Unit Converter did before its caches: the measurement and the unit
+ * of each keystroke which looks like a conversion are parsed from scratch.
+ */
+void UnitConverterBench::parseEachKeystroke()
+{
+    double total = 0.0;
+    QBENCHMARK
+    {
+        for (const QString &keystroke : std::as_const(m_keystrokes))
+        {
+            const QStringList list = keystroke.split(" ", Qt::SkipEmptyParts);
+            QString measurementText, unitText;
+            if (list.size() == 4 && (list.at(2) == "in" || list.at(2) == "to"))
+            {
+                measurementText = list.at(0) + " " + list.at(1);
+                unitText = list.at(3);
+            }
+            else if (list.size() == 3 && (list.at(1) == "in" || list.at(1) == "to"))
+            {
+                measurementText = list.at(0);
+                unitText = list.at(2);
+            }
+            else
+                continue;
+            const units::precise_measurement measurement = units::measurement_from_string(measurementText.toStdString());
+            const units::precise_unit unit = units::unit_from_string(unitText.toStdString());
+            if (measurement.units().is_convertible(unit))
+                total += measurement.value_as(unit);
+        }
+    }
+    QVERIFY(total != 0.0);
+}
+
+/**
+ * Query Unit Converter, which parses the units through its caches.
+ */
+void UnitConverterBench::cacheEachKeystroke()
+{
+    QBENCHMARK
+    {
+        for (const QString &keystroke : std::as_const(m_keystrokes))
+            m_converter.query(keystroke, QueryToken());
+    }
+}
+
+QTEST_MAIN(UnitConverterBench)
+#include "UnitConverterBench.moc"
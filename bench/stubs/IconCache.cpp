@@ -0,0 +1,36 @@
+#include "../../src/core/IconCache.h"
+#include <QApplication>
+#include <QColor>
+
+// A stand-in for the icon cache, which loads icons from the Windows shell: every icon is already loaded, as a plain square.
+
+IconCache *IconCache::instance()
+{
+    static auto *singleInstance = new IconCache(qApp);
+    return singleInstance;
+}
+
+IconCache::IconCache(QObject *parent) : QObject(parent) {}
+
+/**
+ * Get the stand-in icon of a file or an image.
+ *
+ * @param path The path to the file or the image.
+ * @param type The type of the icon.
+ * @param size The size of the icon in device-independent pixels.
+ * @param devicePixelRatio The device pixel ratio of the target.
+ * @return A square in a color derived from the path, the same pixmap for every call with the same arguments.
+ */
+QPixmap IconCache::icon(const QString &path, const IconType type, const int size, const qreal devicePixelRatio)
+{
+    Q_UNUSED(type)
+    const QString key = QString("%1|%2|%3").arg(path).arg(size).arg(devicePixelRatio);
+    if (const QPixmap *pixmap = m_pixmaps.object(key))
+        return *pixmap;
+
+    QPixmap pixmap(QSize(size, size) * devicePixelRatio);
+    pixmap.setDevicePixelRatio(devicePixelRatio);
+    pixmap.fill(QColor::fromHsv(static_cast<int>(qHash(path) % 360), 160, 200));
+    m_pixmaps.insert(key, new QPixmap(pixmap));
+    return pixmap;
+}
@@ -0,0 +1,71 @@
+#include "../../src/core/ModuleRegistry.h"
+#include <utility>
+#include "../../src/common/IModule.h"
+#include "../../src/utils/FuzzyMatcher.h"
+#include "../../src/utils/TrigramIndex.h"
+
+// Stand-ins for the modules, which mostly depend on Windows. Each one prepares and indexes a catalog of synthetic
+// entries while it initializes, sized after the data the module it replaces loads.
+
+namespace
+{
+    class StandInModule final : public IModule
+    {
+    public:
+        StandInModule(QString name, const QChar iconGlyph, const int catalogSize, QObject *parent) :
+            IModule(parent), m_name(std::move(name)), m_iconGlyph(iconGlyph), m_catalogSize(catalogSize)
+        {
+        }
+
+        [[nodiscard]] QString name() const override { return m_name; }
+        [[nodiscard]] QChar iconGlyph() const override { return m_iconGlyph; }
+
+        void initialize() override
+        {
+            m_targets.reserve(m_catalogSize);
+            for (int id = 0; id < m_catalogSize; ++id)
+            {
+                const QString text = QString("%1 Entry %2 Vendor %3").arg(m_name).arg(id).arg(id % 97);
+                m_targets.append(FuzzyMatcher::prepare(text));
+                m_index.insert(static_cast<quint32>(id), {text});
+            }
+        }
+
+        void query(const QString &text, const QueryToken &token) override
+        {
+            Q_UNUSED(text)
+            emit resultsReady({}, this, token.generation());
+        }
+
+    private:
+        QString m_name;
+        QChar m_iconGlyph;
+        int m_catalogSize;
+        QVector<FuzzyMatcher::Target> m_targets;
+        TrigramIndex m_index;
+    };
+
+    ModuleFactory standIn(const QString &name, const bool global, const double priority, const QChar prefix, const QChar iconGlyph, const int catalogSize)
+    {
+        return {name, true, global, priority, prefix, [=](QObject *parent) { return new StandInModule(name, iconGlyph, catalogSize, parent); }};
+    }
+} // namespace
+
+/**
+ * Get the factories of the stand-in modules, with the names and the defaults of the real ones.
+ *
+ * @return The factories.
+ */
+const QVector<ModuleFactory> &ModuleRegistry::factories()
+{
+    static const QVector<ModuleFactory> moduleFactories = {
+        standIn("Launcher Commands", true, 0.5, ':', QChar(0xe8b8), 10), //
+        standIn("Everything Search", false, 0.0, '@', QChar(0xe8b6), 0), //
+        standIn("Calculator", true, 1.0, '=', QChar(0xea5f), 100), //
+        standIn("Apps Search", true, 0.8, ' ', QChar(0xe5c3), 2000), //
+        standIn("System Commands", true, 1.0, ' ', QChar(0xe8ac), 20), //
+        standIn("Windows Terminal", true, 1.0, '>', QChar(0xeb8e), 10), //
+        standIn("Unit Converter", true, 1.0, ' ', QChar(0xeb3a), 200) //
+    };
+    return moduleFactories;
+}
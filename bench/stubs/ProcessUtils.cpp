@@ -0,0 +1,17 @@
+#include "../../src/utils/ProcessUtils.h"
+
+// A stand-in for starting processes, which the benchmarks never do.
+
+/**
+ * Ignore a process to start.
+ *
+ * @param path The path to the executable.
+ * @param arguments The command line arguments.
+ * @param isAdmin Whether to start the process with administrator privileges.
+ */
+void ProcessUtils::startDetached(const QString &path, const QStringList &arguments, const bool &isAdmin)
+{
+    Q_UNUSED(path)
+    Q_UNUSED(arguments)
+    Q_UNUSED(isAdmin)
+}
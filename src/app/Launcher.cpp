@@ -1,53 +1,87 @@
 #include "Launcher.h"
 #include <QApplication>
 #include <QBoxLayout>
-#include <QGraphicsDropShadowEffect>
+#include <QFileInfo>
 #include <QKeyEvent>
 #include <QLabel>
 #include <QLineEdit>
+#include <QListView>
+#include <QPainter>
+#include <algorithm>
+#include <utility>
 #include "../common/Constants.h"
 #include "../common/IModule.h"
 #include "../core/ConfigManager.h"
+#include "../core/ConfigWatcher.h"
 #include "../core/HistoryManager.h"
+#ifdef Q_OS_WIN
 #include "../core/HotkeyManager.h"
+#endif
+#include "../core/ModuleRegistry.h"
+#include "../core/QueryDispatcher.h"
+#include "../core/StartupTrace.h"
 #include "../core/ThemeManager.h"
-#include "../modules/AppsSearch.h"
-#include "../modules/Calculator.h"
-#include "../modules/EverythingSearch.h"
-#include "../modules/LauncherCommands.h"
-#include "../modules/SystemCommands.h"
-#include "../modules/UnitConverter.h"
-#include "../modules/WindowsTerminal.h"
 #include "../utils/DialogUtils.h"
+#include "../utils/PaintUtils.h"
 #include "../widgets/ResultItemDelegate.h"
-#include "../widgets/ResultItemWidget.h"
+#include "../widgets/ResultListModel.h"
 
 Launcher::Launcher(QWidget *parent) : QMainWindow(parent)
 {
     // Set window attributes.
     setWindowFlags(Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint | Qt::Tool);
     setAttribute(Qt::WA_TranslucentBackground);
+#ifdef Q_OS_WIN
     SetForegroundWindow(reinterpret_cast<HWND>(winId()));
+#endif
+
+    // Created before the modules so that it is destroyed first and waits for running queries.
+    m_queryDispatcher = new QueryDispatcher(this);
+    connect(m_queryDispatcher, &QueryDispatcher::resultsReady, this, &Launcher::onResultsReady);
+    connect(m_queryDispatcher, &QueryDispatcher::queryFinished, this, &Launcher::onQueryFinished);
+    connect(m_queryDispatcher, &QueryDispatcher::moreResultsAvailable, this, &Launcher::onMoreResultsAvailable);
+    m_commitTimer.setSingleShot(true);
+    m_commitTimer.setInterval(RESULTS_COMMIT_INTERVAL);
+    connect(&m_commitTimer, &QTimer::timeout, this, &Launcher::commitResults);
+    connect(m_queryDispatcher, &QueryDispatcher::moduleReady, this, &Launcher::onModuleReady);
+    connect(ConfigWatcher::instance(), &ConfigWatcher::configChanged, this, &Launcher::onConfigChanged); // Created on the GUI thread, before any module.
 
-    readConfiguration();
-
-    ThemeManager::initTheme();
-    HistoryManager::initHistory(m_historyDecay, m_historyMinScore, m_historyIncrement, m_historyScoreWeight);
+    {
+        const StartupTrace::Scope scope("readConfiguration");
+        readConfiguration();
+    }
+    {
+        const StartupTrace::Scope scope("initTheme");
+        ThemeManager::initTheme();
+    }
+    {
+        const StartupTrace::Scope scope("initHistory");
+        HistoryManager::initHistory(m_historyDecay, m_historyCapacity, m_historyIncrement, m_historyScoreWeight);
+    }
+    {
+        const StartupTrace::Scope scope("setupUi");
+        setupUi();
+    }
+    ConfigWatcher::instance()->watch();
 
-    setupUi();
+    // The startup report is written once every module constructed at startup is initialized.
+    for (const ModuleConfig &config : std::as_const(m_moduleConfigs))
+        m_startingModules.insert(config.module);
+    if (m_startingModules.isEmpty())
+        QTimer::singleShot(0, this, &StartupTrace::finish);
 }
 
 QJsonDocument Launcher::defaultConfig() const
 {
     QJsonObject modulesObject;
-    for (const ModuleConfig &config : m_moduleConfigs)
+    for (const ModuleFactory &factory : ModuleRegistry::factories())
     {
         QJsonObject moduleObject;
-        moduleObject["enabled"] = config.enabled;
-        moduleObject["global"] = config.global;
-        moduleObject["priority"] = config.priority;
-        moduleObject["prefix"] = QString(config.prefix);
-        modulesObject[ConfigManager::toCamelCase(config.name)] = moduleObject;
+        moduleObject["enabled"] = factory.enabled;
+        moduleObject["global"] = factory.global;
+        moduleObject["priority"] = factory.priority;
+        moduleObject["prefix"] = QString(factory.prefix);
+        modulesObject[ConfigManager::toCamelCase(factory.name)] = moduleObject;
     }
 
     // clang-format off
@@ -56,7 +90,7 @@ QJsonDocument Launcher::defaultConfig() const
         {"history", QJsonObject{
             {"decay", m_historyDecay},
             {"increment", m_historyIncrement},
-            {"minScore", m_historyMinScore},
+            {"capacity", m_historyCapacity},
             {"historyScoreWeight", m_historyScoreWeight}
         }},
         {"ui", QJsonObject{
@@ -72,12 +106,16 @@ QJsonDocument Launcher::defaultConfig() const
 /**
  * Use Windows API to register global Alt + Space hotkey.
  *
- * @return True if the hotkey is successfully registered; false otherwise.
+ * @return True if the hotkey is successfully registered; false otherwise, and always off Windows.
  */
 bool Launcher::registerHotkey() const
 {
+#ifdef Q_OS_WIN
     connect(HotkeyManager::instance(), &HotkeyManager::hotkeyPressed, this, &Launcher::onHotkeyPressed);
     return HotkeyManager::registerHotkey(MOD_ALT, VK_SPACE, 0);
+#else
+    return false;
+#endif
 }
 
 /**
@@ -90,8 +128,12 @@ void Launcher::setWindowVisibility(const bool &visibility)
     isWindowShown = visibility;
     if (!visibility)
     {
-        m_searchEdit->clear();
-        m_resultsList->clear();
+        {
+            const QSignalBlocker blocker(m_searchEdit); // Not an edit: neither a keystroke nor a query.
+            m_searchEdit->clear();
+        }
+        cancelQuery();
+        m_resultsModel->clear();
         m_resultsList->hide();
         QApplication::processEvents(); // Force the event loop to process the above changes.
                                        // The stale bitmap cached by the window manager should be updated before hiding the window.
@@ -99,8 +141,12 @@ void Launcher::setWindowVisibility(const bool &visibility)
     }
     else
     {
+        m_keystrokes = 0;
+        m_shownTimer.start();
         show();
+#ifdef Q_OS_WIN
         SetForegroundWindow(reinterpret_cast<HWND>(winId()));
+#endif
     }
 }
 
@@ -109,26 +155,16 @@ void Launcher::setWindowVisibility(const bool &visibility)
  */
 void Launcher::setupUi()
 {
-    // Shadow effects.
-    auto *searchFrameShadowEffect = new QGraphicsDropShadowEffect(this);
-    searchFrameShadowEffect->setBlurRadius(SHADOW_BLUR_RADIUS);
-    searchFrameShadowEffect->setColor(QColor::fromRgbF(0, 0, 0, SHADOW_OPACITY));
-    searchFrameShadowEffect->setOffset(0, SHADOW_OFFSET_V);
-    auto *resultsListShadowEffect = new QGraphicsDropShadowEffect(this);
-    resultsListShadowEffect->setBlurRadius(SHADOW_BLUR_RADIUS);
-    resultsListShadowEffect->setColor(QColor::fromRgbF(0, 0, 0, SHADOW_OPACITY));
-    resultsListShadowEffect->setOffset(0, SHADOW_OFFSET_V);
-
-    // Main layout.
+    // Main layout. The window follows the size of its content; the margins leave room for the shadows painted in paintEvent.
     const int maxResultsListHeight = m_maxVisibleResults * (PADDING_S + PADDING_S + BUTTON_SIZE + PADDING_S) + PADDING_S;
-    resize(WINDOW_MARGIN + WINDOW_WIDTH + WINDOW_MARGIN,
-           WINDOW_MARGIN + PADDING_S + BUTTON_SIZE + PADDING_S + PADDING_L + maxResultsListHeight + PADDING_S + WINDOW_MARGIN);
     m_centralWidget = new QWidget(this);
     setCentralWidget(m_centralWidget);
     m_mainLayout = new QVBoxLayout(m_centralWidget);
     m_mainLayout->setContentsMargins(WINDOW_MARGIN, WINDOW_MARGIN, WINDOW_MARGIN, WINDOW_MARGIN);
     m_mainLayout->setSpacing(PADDING_L);
+    m_mainLayout->setSizeConstraint(QLayout::SetFixedSize);
     m_centralWidget->setLayout(m_mainLayout);
+    layout()->setSizeConstraint(QLayout::SetFixedSize);
 
     // Search area.
     QFont iconFont;
@@ -137,9 +173,7 @@ void Launcher::setupUi()
     m_searchFrame = new QFrame(this);
     m_searchFrame->setFixedHeight(PADDING_S + PADDING_S + BUTTON_SIZE + PADDING_S + PADDING_S);
     m_searchFrame->setFixedWidth(WINDOW_WIDTH);
-    m_searchFrame->setStyleSheet(
-        QString("QFrame { border: none; border-radius: %1px; background-color: %2; }").arg(CORNER_RADIUS_L).arg(ThemeManager::defaultBackColorHex()));
-    m_searchFrame->setGraphicsEffect(searchFrameShadowEffect);
+    m_searchFrame->setStyleSheet("QFrame { border: none; background: transparent; }");
     m_searchLayout = new QHBoxLayout(m_searchFrame);
     m_searchLayout->setContentsMargins(PADDING_S + PADDING_S, PADDING_S + PADDING_S, PADDING_S + PADDING_S, PADDING_S + PADDING_S);
     m_searchLayout->setSpacing(PADDING_S);
@@ -149,43 +183,32 @@ void Launcher::setupUi()
     m_searchIcon->setFixedWidth(BUTTON_SIZE);
     m_searchIcon->setFixedHeight(BUTTON_SIZE);
     m_searchIcon->setAlignment(Qt::AlignCenter);
-    m_searchIcon->setStyleSheet(QString("QLabel { border: none; background: transparent; color: %1; }").arg(ThemeManager::defaultTextColorHex()));
     m_searchEdit = new QLineEdit(this);
     m_searchEdit->setPlaceholderText(m_placeholderText);
     m_searchEdit->setFixedHeight(BUTTON_SIZE);
     m_searchEdit->setFocus();
     m_searchEdit->setContextMenuPolicy(Qt::NoContextMenu);
-    m_searchEdit->setStyleSheet(QString("QLineEdit { border: none; background: transparent; color: %1; font-size: %2px; padding: 0px; }")
-                                    .arg(ThemeManager::defaultTextColorHex())
-                                    .arg(TITLE_FONT_SIZE));
     connect(m_searchEdit, &QLineEdit::textChanged, this, &Launcher::onInputTextChanged);
     m_actionDescription = new QLabel(this);
     m_actionDescription->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
     m_actionDescription->setFixedHeight(BUTTON_SIZE);
-    m_actionDescription->setStyleSheet(
-        QString("QLabel { border: none; border-radius: %1px; background: %2; color: %3; font-size: %4px; padding-left: %5px; padding-right: %5px; }")
-            .arg(CORNER_RADIUS_S)
-            .arg(ThemeManager::activeBackColorHex(), ThemeManager::defaultTextColorHex())
-            .arg(TITLE_FONT_SIZE)
-            .arg(PADDING_S));
     m_actionDescription->hide();
     m_searchLayout->addWidget(m_searchIcon);
     m_searchLayout->addWidget(m_searchEdit);
     m_searchLayout->addWidget(m_actionDescription);
 
     // Results list.
-    m_resultsList = new QListWidget(this);
+    m_resultsModel = new ResultListModel(this);
+    m_resultsList = new QListView(this);
+    m_resultsList->setModel(m_resultsModel);
+    connect(m_resultsModel, &ResultListModel::moreRequested, this, &Launcher::onMoreRequested);
     m_resultsList->setFixedWidth(WINDOW_WIDTH);
     m_resultsList->setFixedHeight(maxResultsListHeight);
     m_resultsList->setFocusPolicy(Qt::NoFocus);
     m_resultsList->setMouseTracking(true);
     m_resultsList->setSpacing(PADDING_S / 2); // Set spacing and padding separately to keep the spacing between items and the list widget padding the same.
     m_resultsList->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    m_resultsList->setStyleSheet(QString("QListWidget { border: none; border-radius: %1px; background-color: %2; padding: %3px; }")
-                                     .arg(CORNER_RADIUS_L)
-                                     .arg(ThemeManager::defaultBackColorHex())
-                                     .arg(PADDING_S / 2));
-    m_resultsList->setGraphicsEffect(resultsListShadowEffect);
+    m_resultsList->setStyleSheet(QString("QListView { border: none; background: transparent; padding: %1px; }").arg(PADDING_S / 2));
     m_resultsList->hide();
 
     // Set custom delegate for results list.
@@ -200,71 +223,215 @@ void Launcher::setupUi()
 
     m_mainLayout->addWidget(m_searchFrame);
     m_mainLayout->addWidget(m_resultsList);
-    m_mainLayout->addStretch(1);
 
-    // Move to the center of screen.
+    applyTheme();
+    centerWindow();
+}
+
+/**
+ * Apply the colors of the theme to the widgets styled by style sheets.
+ *
+ * The backgrounds and the results are painted with the current theme anyway.
+ */
+void Launcher::applyTheme()
+{
+    m_searchIcon->setStyleSheet(QString("QLabel { border: none; background: transparent; color: %1; }").arg(ThemeManager::defaultTextColorHex()));
+    m_searchEdit->setStyleSheet(QString("QLineEdit { border: none; background: transparent; color: %1; font-size: %2px; padding: 0px; }")
+                                    .arg(ThemeManager::defaultTextColorHex())
+                                    .arg(TITLE_FONT_SIZE));
+    m_actionDescription->setStyleSheet(
+        QString("QLabel { border: none; border-radius: %1px; background: %2; color: %3; font-size: %4px; padding-left: %5px; padding-right: %5px; }")
+            .arg(CORNER_RADIUS_S)
+            .arg(ThemeManager::activeBackColorHex(), ThemeManager::defaultTextColorHex())
+            .arg(TITLE_FONT_SIZE)
+            .arg(PADDING_S));
+    update();
+    m_resultsList->viewport()->update();
+}
+
+/**
+ * Move to the center of screen, as if all the results were shown, so that the search frame stays in place.
+ */
+void Launcher::centerWindow()
+{
+    const int maxResultsListHeight = m_maxVisibleResults * (PADDING_S + PADDING_S + BUTTON_SIZE + PADDING_S) + PADDING_S;
     const QScreen *screen = QApplication::primaryScreen();
     const int screenWidth = screen->geometry().right() + 1;
     const int screenHeight = screen->geometry().bottom() + 1;
-    move(screenWidth / 2 - width() / 2, screenHeight / 2 - height() / 2);
+    const int maxWindowHeight = WINDOW_MARGIN + m_searchFrame->height() + PADDING_L + maxResultsListHeight + WINDOW_MARGIN;
+    move(screenWidth / 2 - (WINDOW_MARGIN + WINDOW_WIDTH + WINDOW_MARGIN) / 2, screenHeight / 2 - maxWindowHeight / 2);
 }
 
 /**
  * Load launcher configuration from file.
+ *
+ * Modules are constructed when they are enabled and retired when they are
+ * disabled; the modules which stay enabled are kept with their new settings.
+ *
+ * @return True if modules were added or removed.
  */
-void Launcher::readConfiguration()
+bool Launcher::readConfiguration()
 {
-    m_moduleConfigs = {
-        ModuleConfig(new LauncherCommands(this), true, true, 0.5, ':'), //
-        ModuleConfig(new EverythingSearch(this), true, false, 0.0, '@'), //
-        ModuleConfig(new Calculator(this), true, true, 1.0, '='), //
-        ModuleConfig(new AppsSearch(this), true, true, 0.8, ' '), //
-        ModuleConfig(new SystemCommands(this), true, true, 1.0, ' '), //
-        ModuleConfig(new WindowsTerminal(this), true, true, 1.0, '>'), //
-        ModuleConfig(new UnitConverter(this), true, true, 1.0, ' ') //
-    };
-
-    // Connect all modules to results ready signal.
-    for (ModuleConfig &config : m_moduleConfigs)
-    {
-        config.name = config.module->name();
-        config.iconGlyph = config.module->iconGlyph();
-        connect(config.module, &IModule::resultsReady, this, &Launcher::onResultsReady);
-    }
-
     const QJsonDocument doc = ConfigManager::loadConfig("Launcher.json", defaultConfig());
     const QJsonObject rootObject = doc.object();
     const QJsonObject modulesObject = rootObject["modules"].toObject();
-    for (auto iterator = m_moduleConfigs.begin(); iterator != m_moduleConfigs.end();)
+
+    // Only the enabled modules are constructed; they are initialized on the thread pool of the query dispatcher.
+    QVector<ModuleConfig> moduleConfigs;
+    bool modulesChanged = false;
+    for (const ModuleFactory &factory : ModuleRegistry::factories())
     {
-        ModuleConfig &config = *iterator;
-        const QJsonObject moduleObject = modulesObject[ConfigManager::toCamelCase(config.name)].toObject();
-
-        config.enabled = moduleObject["enabled"].toBool();
-        config.global = moduleObject["global"].toBool();
-        config.priority = moduleObject["priority"].toDouble();
-        config.prefix = moduleObject["prefix"].toString(" ")[0]; // If prefix is not provided, use a space character.
-        if (!config.enabled)
+        const QJsonObject moduleObject = modulesObject[ConfigManager::toCamelCase(factory.name)].toObject();
+        const auto existing = std::find_if(m_moduleConfigs.begin(), m_moduleConfigs.end(), [&factory](const ModuleConfig &config) { return config.name == factory.name; });
+        if (!moduleObject["enabled"].toBool())
         {
-            disconnect(config.module, &IModule::resultsReady, this, &Launcher::onResultsReady);
-            iterator = m_moduleConfigs.erase(iterator);
+            if (existing != m_moduleConfigs.end())
+            {
+                if (m_startingModules.remove(existing->module) && m_startingModules.isEmpty())
+                    StartupTrace::finish();
+                m_queryDispatcher->retireModule(existing->module);
+                modulesChanged = true;
+            }
+            continue;
         }
-        else
+
+        ModuleConfig config(existing != m_moduleConfigs.end() ? existing->module : nullptr, true, moduleObject["global"].toBool(),
+                            moduleObject["priority"].toDouble(), moduleObject["prefix"].toString(" ")[0]); // If prefix is not provided, use a space character.
+        if (!config.module)
         {
-            ++iterator;
+            const StartupTrace::Scope scope("construct " + factory.name);
+            config.module = factory.create(this);
+            m_queryDispatcher->addModule(config.module);
+            modulesChanged = true;
         }
+        config.name = config.module->name();
+        config.iconGlyph = config.module->iconGlyph();
+        moduleConfigs.append(config);
 
         if (config.priority < 0.0 || config.priority > 1.0)
             DialogUtils::showWarning(QString("Invalid priority %1 for module %2. ").arg(config.priority).arg(config.name));
     }
+    m_moduleConfigs = moduleConfigs;
+
     const QJsonObject historyObject = rootObject["history"].toObject();
     m_historyDecay = historyObject["decay"].toDouble();
-    m_historyMinScore = historyObject["minScore"].toDouble();
+    m_historyCapacity = historyObject["capacity"].toInt(m_historyCapacity); // Absent from configurations written before it replaced minScore.
     m_historyIncrement = historyObject["increment"].toDouble();
     m_historyScoreWeight = historyObject["historyScoreWeight"].toDouble();
     const QJsonObject uiObject = rootObject["ui"].toObject();
     m_maxVisibleResults = uiObject["maxVisibleResults"].toInt();
     m_placeholderText = uiObject["placeholderText"].toString();
+    return modulesChanged;
+}
+
+/**
+ * Apply a changed configuration file in place.
+ *
+ * Only what the file configures is rebuilt: the launcher settings, the theme,
+ * or a single module, which keeps answering queries until its replacement is
+ * initialized.
+ *
+ * @param fileName The name of the file in the configuration folder.
+ */
+void Launcher::onConfigChanged(const QString &fileName)
+{
+    QElapsedTimer timer;
+    timer.start();
+    if (fileName == "Launcher.json")
+    {
+        if (readConfiguration())
+            refreshResults();
+        HistoryManager::updateSettings(m_historyDecay, m_historyCapacity, m_historyIncrement, m_historyScoreWeight);
+        m_searchEdit->setPlaceholderText(m_placeholderText);
+        centerWindow();
+    }
+    else if (fileName == "Theme.json")
+    {
+        ThemeManager::initTheme();
+        applyTheme();
+    }
+    else
+    {
+        if (fileName.startsWith("Modules/") && fileName.endsWith(".json"))
+            reloadModule(QFileInfo(fileName).completeBaseName()); // Logged once the module is swapped in.
+        return;
+    }
+    qInfo() << "Reloaded" << fileName << "in" << timer.elapsed() << "ms";
+}
+
+/**
+ * Construct a module again after a change of its configuration. The current
+ * module keeps answering queries until the new one is initialized.
+ *
+ * @param name The name of the module.
+ */
+void Launcher::reloadModule(const QString &name)
+{
+    const auto config = std::find_if(m_moduleConfigs.cbegin(), m_moduleConfigs.cend(), [&name](const ModuleConfig &config) { return config.name == name; });
+    const auto factory = std::find_if(ModuleRegistry::factories().cbegin(), ModuleRegistry::factories().cend(),
+                                      [&name](const ModuleFactory &factory) { return factory.name == name; });
+    if (config == m_moduleConfigs.cend() || factory == ModuleRegistry::factories().cend())
+        return; // Disabled.
+
+    // A replacement still initializing for an earlier change is superseded.
+    for (auto iterator = m_replacements.begin(); iterator != m_replacements.end();)
+    {
+        if (iterator.value() == config->module)
+        {
+            m_queryDispatcher->retireModule(iterator.key());
+            m_replacementTimers.remove(iterator.key());
+            iterator = m_replacements.erase(iterator);
+        }
+        else
+        {
+            ++iterator;
+        }
+    }
+
+    IModule *replacement = factory->create(this);
+    m_replacements.insert(replacement, config->module);
+    m_replacementTimers[replacement].start();
+    m_queryDispatcher->addModule(replacement);
+}
+
+/**
+ * Swap in a module reloaded after a change of its configuration, once it is
+ * initialized, and write the startup report once the last module is initialized.
+ *
+ * @param module The module that is ready.
+ */
+void Launcher::onModuleReady(IModule *module)
+{
+    if (m_startingModules.remove(module) && m_startingModules.isEmpty())
+        StartupTrace::finish();
+
+    const auto replacement = m_replacements.find(module);
+    if (replacement == m_replacements.end())
+        return;
+    const IModule *previous = replacement.value();
+    m_replacements.erase(replacement);
+    const qint64 reloadTime = m_replacementTimers.take(module).elapsed();
+
+    const auto config = std::find_if(m_moduleConfigs.begin(), m_moduleConfigs.end(), [previous](const ModuleConfig &config) { return config.module == previous; });
+    if (config == m_moduleConfigs.end())
+    {
+        m_queryDispatcher->retireModule(module); // Disabled meanwhile.
+        return;
+    }
+    m_queryDispatcher->retireModule(config->module);
+    config->module = module;
+    config->iconGlyph = module->iconGlyph();
+    refreshResults();
+    qInfo() << "Reloaded" << module->name() << "in" << reloadTime << "ms";
+}
+
+/**
+ * Drop the results, which may belong to a retired module, and query again.
+ */
+void Launcher::refreshResults()
+{
+    m_resultsModel->clear();
+    queryModules(m_searchEdit->text()); // Not an edit, so not counted as a keystroke.
 }
 
 /**
@@ -281,50 +448,115 @@ void Launcher::onHotkeyPressed(const long long id)
 /**
  * Handle results ready signal from modules.
  *
+ * The results are buffered and committed with the others arriving within the
+ * same frame, so that a keystroke causes a single model update and resize.
+ *
  * @param results The list of results to be displayed.
  * @param module The module providing the results.
  */
-void Launcher::onResultsReady(QVector<ResultItem> &results, const IModule *module)
+void Launcher::onResultsReady(const QVector<ResultItem> &results, const IModule *module)
 {
     double priority = 0.0;
     for (const ModuleConfig &config : m_moduleConfigs)
         if (config.module == module)
             priority = config.priority;
 
-    for (auto &item : results)
+    QVector<ResultItem> batch = results;
+    for (ResultItem &item : batch)
     {
+        item.module = module;
         item.priority = priority;
-        const auto listItem = new ResultItemWidget(m_resultsList);
-        listItem->setData(Qt::UserRole, QVariant::fromValue(item));
-        m_resultsList->addItem(listItem);
     }
+    m_pendingBatches.append(std::move(batch));
+    if (const auto paging = m_paging.find(module); paging != m_paging.end())
+        paging->resultCount += static_cast<int>(results.size());
+
+    // Results arriving after the first frame are gathered for one more frame.
+    if (!m_commitTimer.isActive())
+        m_commitTimer.start();
+}
+
+/**
+ * Handle the end of a module query; commit at once when no other module is pending.
+ *
+ * @param module The module that finished.
+ */
+void Launcher::onQueryFinished(const IModule *module)
+{
+    if (m_waitingModules.remove(module) && m_waitingModules.isEmpty())
+        commitResults();
+}
+
+/**
+ * Remember that a module has a next page of results, to be fetched once the list reaches its end.
+ *
+ * @param module The module that has more results.
+ */
+void Launcher::onMoreResultsAvailable(const IModule *module)
+{
+    const auto paging = m_paging.find(module);
+    if (paging == m_paging.end())
+        return;
+    paging->hasMore = true;
+    if (!m_replaceResults) // Otherwise the rows still belong to the previous text; set on commit.
+        m_resultsModel->setCanFetchMore(true);
+}
+
+/**
+ * Fetch the next page of every module which has one, when the list reaches its end.
+ */
+void Launcher::onMoreRequested()
+{
+    for (const ModuleConfig &config : std::as_const(m_moduleConfigs))
+    {
+        const auto paging = m_paging.find(config.module);
+        if (paging == m_paging.end() || !std::exchange(paging->hasMore, false))
+            continue;
+        m_hasFetchedMore = true;
+        m_queryDispatcher->dispatch(config.module, paging->text, paging->resultCount);
+    }
+}
 
-    m_resultsList->sortItems(Qt::DescendingOrder);
+/**
+ * Show the buffered results in a single update of the model and the list.
+ */
+void Launcher::commitResults()
+{
+    m_commitTimer.stop();
+    if (!m_replaceResults && m_pendingBatches.isEmpty())
+        return;
 
-    if (m_resultsList->count() == 0)
+    if (std::exchange(m_replaceResults, false))
+        m_resultsModel->clear();
+    m_resultsModel->mergeBatches(std::exchange(m_pendingBatches, {}));
+    m_resultsModel->setCanFetchMore(std::any_of(m_paging.cbegin(), m_paging.cend(), [](const Paging &paging) { return paging.hasMore; }));
+
+    if (m_resultsModel->rowCount() == 0)
     {
         m_resultsList->hide();
         m_actionDescription->setText("");
         m_actionDescription->hide();
     }
-    if (m_resultsList->count() > 0)
+    if (m_resultsModel->rowCount() > 0)
     {
+        m_resultsList->setFixedHeight(std::min(m_resultsModel->rowCount(), m_maxVisibleResults) * (PADDING_S + PADDING_S + BUTTON_SIZE + PADDING_S) + PADDING_S);
         m_resultsList->show();
-        m_resultsList->setFixedHeight(std::min(m_resultsList->count(), m_maxVisibleResults) * (PADDING_S + PADDING_S + BUTTON_SIZE + PADDING_S) + PADDING_S);
-        m_resultsList->setCurrentRow(0);
-        m_resultItemDelegate->setCurrentActionIndex(0);
+        if (!m_hasFetchedMore || !m_resultsList->currentIndex().isValid())
+        {
+            m_resultsList->setCurrentIndex(m_resultsModel->index(0));
+            m_resultItemDelegate->setCurrentActionIndex(0);
+        }
 
-        // Update action description for the first selected item
-        const QListWidgetItem *firstItem = m_resultsList->item(0);
-        if (firstItem)
+        // Update action description for the selected item.
+        if (const QVector<Action> &actions = IModule::actionsOf(m_resultsModel->item(m_resultsList->currentIndex().row())); !actions.isEmpty())
         {
-            const QVariant data = firstItem->data(Qt::UserRole);
-            const auto resultItem = data.value<ResultItem>();
-            if (!resultItem.actions.isEmpty())
-            {
-                m_actionDescription->setText(resultItem.actions[0].description);
-                m_actionDescription->show();
-            }
+            m_actionDescription->setText(actions[0].description);
+            m_actionDescription->show();
+        }
+        else
+        {
+            m_actionDescription->setText("");
+            m_actionDescription->hide();
         }
     }
 }
@@ -336,12 +568,38 @@ void Launcher::onResultsReady(QVector<ResultItem> &results, const IModule *modul
  */
 void Launcher::onInputTextChanged(const QString &text)
 {
-    m_resultsList->clear();
-    m_actionDescription->setText("");
-    m_actionDescription->hide();
-    m_resultsList->hide();
+    ++m_keystrokes;
+    queryModules(text);
+}
+
+/**
+ * Cancel the queries of the current text and drop their pending results.
+ */
+void Launcher::cancelQuery()
+{
+    m_pendingBatches.clear();
+    m_waitingModules.clear();
+    m_paging.clear();
+    m_hasFetchedMore = false;
+    m_commitTimer.stop();
     m_searchIcon->setText(QChar(0xe8b6)); // Search.
 
+    // The results still arriving for the text are dropped.
+    m_queryDispatcher->startQuery();
+}
+
+/**
+ * Query the modules for a search text, replacing the results of the previous text.
+ *
+ * @param text The search text.
+ */
+void Launcher::queryModules(const QString &text)
+{
+    // The results of the previous text stay until the first results of this one are committed, to avoid flicker.
+    cancelQuery();
+    m_replaceResults = true;
+    m_resultsModel->setQuery(text);
+
     if (!text.isEmpty())
     {
         const QChar prefix = text.at(0);
@@ -351,7 +609,9 @@ void Launcher::onInputTextChanged(const QString &text)
             if (config.prefix == prefix && prefix != ' ')
             {
                 m_searchIcon->setText(config.iconGlyph);
-                config.module->query(text.mid(1).trimmed());
+                m_waitingModules.insert(config.module);
+                m_paging.insert(config.module, {text.mid(1).trimmed()});
+                m_queryDispatcher->dispatch(config.module, text.mid(1).trimmed());
                 return;
             }
         }
@@ -360,10 +620,41 @@ void Launcher::onInputTextChanged(const QString &text)
         {
             if (config.global)
             {
-                config.module->query(text.trimmed());
+                m_waitingModules.insert(config.module);
+                m_paging.insert(config.module, {text.trimmed()});
+                m_queryDispatcher->dispatch(config.module, text.trimmed());
             }
         }
     }
+
+    // Whatever arrived by the end of the first frame is shown then, even if slower modules are still running.
+    if (m_waitingModules.isEmpty())
+        commitResults();
+    else
+        m_commitTimer.start();
+}
+
+/**
+ * Paint the backgrounds and the shadows of the search frame and the results list.
+ *
+ * The children are transparent, so hovering a result repaints only the affected
+ * part of the window from the cached shadow instead of blurring it again.
+ *
+ * @param event The paint event.
+ */
+void Launcher::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+    QPainter painter(this);
+    const QColor shadowColor = QColor::fromRgbF(0, 0, 0, SHADOW_OPACITY);
+    for (const QWidget *widget : {static_cast<const QWidget *>(m_searchFrame), static_cast<const QWidget *>(m_resultsList)})
+    {
+        if (!widget->isVisible())
+            continue;
+        const QRect rect(widget->mapTo(this, QPoint(0, 0)), widget->size());
+        PaintUtils::drawShadow(&painter, rect, CORNER_RADIUS_L, SHADOW_BLUR_RADIUS, SHADOW_OFFSET_V, shadowColor);
+        PaintUtils::drawRoundedRect(&painter, rect, CORNER_RADIUS_L, ThemeManager::defaultBackColor());
+    }
 }
 
 /**
@@ -379,12 +670,11 @@ bool Launcher::eventFilter(QObject *obj, QEvent *event)
     {
         const auto keyEvent = dynamic_cast<QKeyEvent *>(event);
 
-        const QListWidgetItem *currentItem = m_resultsList->currentItem();
-        if (!currentItem)
+        const QModelIndex currentIndex = m_resultsList->currentIndex();
+        if (!currentIndex.isValid())
             return QMainWindow::eventFilter(obj, event);
 
-        const QVariant data = currentItem->data(Qt::UserRole);
-        const auto item = data.value<ResultItem>();
+        const ResultItem item = m_resultsModel->item(currentIndex.row()); // Copied, since executing an action clears the results.
 
         if (keyEvent->modifiers() != Qt::NoModifier)
         {
@@ -427,31 +717,32 @@ bool Launcher::eventFilter(QObject *obj, QEvent *event)
         // Navigate between results.
         if (keyEvent->key() == Qt::Key_Up || keyEvent->key() == Qt::Key_Down)
         {
-            if ((keyEvent->key() == Qt::Key_Up && m_resultsList->currentRow() - 1 >= 0) ||
-                (keyEvent->key() == Qt::Key_Down && m_resultsList->currentRow() + 1 < m_resultsList->count()))
+            const int currentRow = currentIndex.row();
+            if ((keyEvent->key() == Qt::Key_Up && currentRow - 1 >= 0) || (keyEvent->key() == Qt::Key_Down && currentRow + 1 < m_resultsModel->rowCount()))
             {
-                m_resultsList->setCurrentRow(m_resultsList->currentRow() + (keyEvent->key() == Qt::Key_Up ? -1 : 1));
+                m_resultsList->setCurrentIndex(m_resultsModel->index(currentRow + (keyEvent->key() == Qt::Key_Up ? -1 : 1)));
                 m_resultItemDelegate->setCurrentActionIndex(0);
 
                 // Update action description for the newly selected item.
-                const QListWidgetItem *newCurrentItem = m_resultsList->currentItem();
-                if (newCurrentItem)
+                if (const QVector<Action> &actions = IModule::actionsOf(m_resultsModel->item(m_resultsList->currentIndex().row())); !actions.isEmpty())
                 {
-                    const QVariant newData = newCurrentItem->data(Qt::UserRole);
-                    const auto newItem = newData.value<ResultItem>();
-                    if (!newItem.actions.isEmpty())
-                    {
-                        m_actionDescription->setText(newItem.actions[0].description);
-                        m_actionDescription->show();
-                    }
-                    else
-                    {
-                        m_actionDescription->setText("");
-                        m_actionDescription->hide();
-                    }
+                    m_actionDescription->setText(actions[0].description);
+                    m_actionDescription->show();
+                }
+                else
+                {
+                    m_actionDescription->setText("");
+                    m_actionDescription->hide();
                 }
                 return true;
             }
+
+            // Past the last result, fetch the next page, which the next press moves into.
+            if (keyEvent->key() == Qt::Key_Down && m_resultsModel->canFetchMore(QModelIndex()))
+            {
+                m_resultsModel->fetchMore(QModelIndex());
+                return true;
+            }
         }
     }
 
@@ -473,12 +764,13 @@ bool Launcher::eventFilter(QObject *obj, QEvent *event)
  */
 void Launcher::handleActionsNavigation(const ResultItem &item, const bool &right, const bool &loop) const
 {
-    if (item.actions.isEmpty())
+    const QVector<Action> &actions = IModule::actionsOf(item);
+    if (actions.isEmpty())
         return;
 
     // Get current action index from delegate.
     const int currentIndex = m_resultItemDelegate->getCurrentActionIndex();
-    const int actionCount = static_cast<int>(item.actions.size());
+    const int actionCount = static_cast<int>(actions.size());
     const int newIndex = currentIndex + (right ? 1 : -1);
 
     if ((newIndex >= 0 && newIndex < actionCount) || (newIndex >= 0 && loop))
@@ -499,14 +791,14 @@ void Launcher::handleActionsNavigation(const ResultItem &item, const bool &right
  */
 bool Launcher::executeShortcutAction(const ResultItem &item, const QKeySequence &pressedShortcut)
 {
-    for (const auto &action : item.actions)
+    for (const auto &action : IModule::actionsOf(item))
     {
         if (!action.shortcut.isEmpty() && action.shortcut == pressedShortcut)
         {
+            const QString query = m_searchEdit->text();
             if (action.handler)
-                action.handler();
-            if (!item.key.isEmpty())
-                HistoryManager::addHistory(item.key);
+                action.handler(item);
+            recordLaunch(item, query);
 
             setWindowVisibility(false);
             return true;
@@ -523,22 +815,41 @@ bool Launcher::executeShortcutAction(const ResultItem &item, const QKeySequence
  */
 void Launcher::executeCurrentAction(const ResultItem &item)
 {
-    if (item.actions.isEmpty()) // Empty action list is accepted.
+    const QVector<Action> &actions = IModule::actionsOf(item);
+    if (actions.isEmpty()) // Empty action list is accepted.
     {
         setWindowVisibility(false);
         return;
     }
 
+    // Execute the action at the current index, recorded before hiding the window clears the search text.
+    const int currentIndex = m_resultItemDelegate->getCurrentActionIndex();
+    const bool isValidIndex = currentIndex >= 0 && currentIndex < actions.size();
+    if (isValidIndex)
+        recordLaunch(item, m_searchEdit->text());
     setWindowVisibility(false);
+    if (isValidIndex && actions[currentIndex].handler)
+        actions[currentIndex].handler(item);
+}
 
-    // Execute the action at the current index.
-    if (const int currentIndex = m_resultItemDelegate->getCurrentActionIndex(); currentIndex >= 0 && currentIndex < item.actions.size())
-    {
-        if (item.actions[currentIndex].handler)
-            item.actions[currentIndex].handler();
-        if (!item.key.isEmpty())
-            HistoryManager::addHistory(item.key);
-    }
+/**
+ * Record a launch in the history, and record and log the keystrokes and the time it took.
+ *
+ * @param item The launched result item.
+ * @param query The query typed before the launch.
+ */
+void Launcher::recordLaunch(const ResultItem &item, const QString &query)
+{
+    if (!item.key.isEmpty())
+        HistoryManager::addHistory(item.key, query);
+
+    ++m_launchCount;
+    m_totalKeystrokes += m_keystrokes;
+    const qint64 launchTime = m_shownTimer.elapsed();
+    m_totalLaunchTime += launchTime;
+    HistoryManager::addLaunchSample(m_keystrokes, launchTime);
+    qInfo() << "Launch:" << m_keystrokes << "keystrokes," << launchTime << "ms; average" << static_cast<double>(m_totalKeystrokes) / m_launchCount
+            << "keystrokes," << m_totalLaunchTime / m_launchCount << "ms over" << m_launchCount << "launches";
 }
 
 /**
@@ -1,7 +1,13 @@
 #pragma once
 
+#include <QElapsedTimer>
+#include <QHash>
 #include <QMainWindow>
+#include <QSet>
+#include <QTimer>
+#ifdef Q_OS_WIN
 #include <windows.h>
+#endif
 #include "../common/Action.h"
 #include "../common/ResultItem.h"
 
@@ -10,11 +16,13 @@ class QHBoxLayout;
 class QLabel;
 class QFrame;
 class QLineEdit;
-class QListWidget;
+class QListView;
 class QPropertyAnimation;
 
 class ResultItemDelegate;
+class ResultListModel;
 class HotkeyManager;
+class QueryDispatcher;
 class IModule;
 
 class Launcher final : public QMainWindow
@@ -30,20 +38,34 @@ public:
 
 protected:
     bool eventFilter(QObject *obj, QEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
 
 private slots:
     void onHotkeyPressed(long long id);
     void onInputTextChanged(const QString &text);
-    void onResultsReady(QVector<ResultItem> &results, const IModule *module);
+    void onResultsReady(const QVector<ResultItem> &results, const IModule *module);
+    void onQueryFinished(const IModule *module);
+    void onMoreResultsAvailable(const IModule *module);
+    void onMoreRequested();
     void onActionDescriptionChanged(const QString &description) const;
+    void onConfigChanged(const QString &fileName);
+    void onModuleReady(IModule *module);
 
 private:
     void setWindowVisibility(const bool &visibility);
     void setupUi();
-    void readConfiguration();
+    void applyTheme();
+    void centerWindow();
+    bool readConfiguration();
+    void reloadModule(const QString &name);
+    void refreshResults();
+    void cancelQuery();
+    void queryModules(const QString &text);
+    void commitResults();
     void handleActionsNavigation(const ResultItem& item, const bool &right, const bool &loop) const;
     bool executeShortcutAction(const ResultItem& item, const QKeySequence &pressedShortcut);
     void executeCurrentAction(const ResultItem& item);
+    void recordLaunch(const ResultItem &item, const QString &query);
 
     bool isWindowShown = false;
     QWidget *m_centralWidget = nullptr;
@@ -53,8 +75,28 @@ private:
     QLabel *m_searchIcon = nullptr;
     QLineEdit *m_searchEdit = nullptr;
     QLabel *m_actionDescription = nullptr;
-    QListWidget *m_resultsList = nullptr;
+    QListView *m_resultsList = nullptr;
+    ResultListModel *m_resultsModel = nullptr;
     ResultItemDelegate *m_resultItemDelegate = nullptr;
+    QueryDispatcher *m_queryDispatcher = nullptr;
+    QVector<QVector<ResultItem>> m_pendingBatches; // Results received since the last commit.
+    QSet<const IModule *> m_waitingModules; // Modules queried for the current text which have not finished yet.
+
+    struct Paging
+    {
+        QString text; // The text the module was queried with.
+        int resultCount = 0; // The results the module provided for the text so far.
+        bool hasMore = false; // Whether the module reported a next page which is not requested yet.
+    };
+    QHash<const IModule *, Paging> m_paging; // The modules queried for the current text.
+    bool m_hasFetchedMore = false; // Whether pages were fetched for the current text; the selection is kept from then on.
+    QTimer m_commitTimer;
+    bool m_replaceResults = false; // Whether the next commit replaces the results of the previous text.
+    QElapsedTimer m_shownTimer; // Started when the window is shown, to measure the time to launch.
+    int m_keystrokes = 0; // Edits of the search text since the window was shown.
+    qint64 m_launchCount = 0;
+    qint64 m_totalKeystrokes = 0;
+    qint64 m_totalLaunchTime = 0;
 
     struct ModuleConfig
     {
@@ -80,9 +122,12 @@ private:
         bool operator==(const ModuleConfig &other) const { return module == other.module; }
     };
     QVector<ModuleConfig> m_moduleConfigs;
+    QHash<IModule *, IModule *> m_replacements; // Modules reloaded after a change of their configuration, with the modules they replace once initialized.
+    QHash<IModule *, QElapsedTimer> m_replacementTimers;
+    QSet<const IModule *> m_startingModules; // Modules constructed at startup which are not initialized yet.
 
     double m_historyDecay = 0.95;
-    double m_historyMinScore = 0.01;
+    int m_historyCapacity = 10000;
     double m_historyIncrement = 1.0;
     double m_historyScoreWeight = 1.0;
 
@@ -5,6 +5,8 @@
 #include <QString>
 #include <functional>
 
+struct ResultItem;
+
 /**
  * @struct Action
  * @brief Represent an action that can be performed.
@@ -13,16 +15,18 @@
  *
  * - description: A brief description of the action.
  * - iconGlyph: A single character representing an icon in glyph form.
- * - handler: The action handler to be called when triggered.
+ * - handler: The action handler to be called when triggered, with the result it is performed on.
  * - shortcut: An optional shortcut to directly trigger the action.
  *
  * An iconGlyph must be provided unless the action is the primary action.
+ * Actions are templates shared by all results of a module; the handler reads
+ * what it needs from the payload of the result.
  */
 struct Action
 {
     QString description;
     QChar iconGlyph;
-    std::function<void()> handler;
+    std::function<void(const ResultItem &item)> handler;
     QKeySequence shortcut;
 };
 
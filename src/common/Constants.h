@@ -1,7 +1,6 @@
 #pragma once
 
 // Window.
-constexpr auto WINDOW_MARGIN = 100;
 constexpr auto WINDOW_WIDTH = 600;
 constexpr auto PADDING_L = 12;
 constexpr auto PADDING_S = 8;
@@ -12,6 +11,10 @@ constexpr auto RESULTS_SPACING = 2;
 constexpr auto SHADOW_BLUR_RADIUS = 64;
 constexpr auto SHADOW_OPACITY = 0.6f;
 constexpr auto SHADOW_OFFSET_V = 8;
+constexpr auto WINDOW_MARGIN = SHADOW_BLUR_RADIUS / 2 + SHADOW_OFFSET_V; // Room for the shadows, see PaintUtils::shadowExtent.
+
+// Results.
+constexpr auto RESULTS_COMMIT_INTERVAL = 16; // In ms; results arriving within one frame are shown together.
 
 // Result item.
 constexpr auto TITLE_FONT_SIZE = 12;
@@ -3,6 +3,7 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QObject>
+#include "QueryToken.h"
 #include "ResultItem.h"
 
 class IModule : public QObject
@@ -15,8 +16,72 @@ public:
     [[nodiscard]] virtual QString name() const = 0;
     [[nodiscard]] virtual QChar iconGlyph() const = 0;
     [[nodiscard]] virtual QJsonDocument defaultConfig() const { return {}; }
-    virtual void query(const QString &text) = 0;
+
+    /**
+     * Get the actions of a result provided by this module. The list can be empty.
+     *
+     * @param item The result.
+     * @return The action template shared by the results of the same kind.
+     */
+    [[nodiscard]] virtual const QVector<Action> &actions(const ResultItem &item) const
+    {
+        Q_UNUSED(item)
+        static const QVector<Action> noActions;
+        return noActions;
+    }
+
+    /**
+     * Get the actions of a result from the module that provided it.
+     *
+     * @param item The result.
+     * @return The actions of the result; empty if it has no module.
+     */
+    [[nodiscard]] static const QVector<Action> &actionsOf(const ResultItem &item)
+    {
+        static const QVector<Action> noActions;
+        return item.module ? item.module->actions(item) : noActions;
+    }
+
+    /**
+     * Do the heavy initialization of the module, such as reading its data.
+     *
+     * Called once on a worker thread of QueryDispatcher, before the first query,
+     * so that the constructor stays cheap and the modules start in parallel.
+     */
+    virtual void initialize() {}
+
+    /**
+     * Ask the module to end its initialization and its background work early, as it
+     * is about to be destroyed. Called on the GUI thread, possibly while initialize
+     * or a query runs on a worker thread.
+     */
+    virtual void stop() {}
+
+    /**
+     * Run a query. Called on a worker thread of QueryDispatcher; calls for the
+     * same module never overlap.
+     *
+     * @param text The search text.
+     * @param token The token of the query; results must be tagged with its generation.
+     */
+    virtual void query(const QString &text, const QueryToken &token) = 0;
+
+    /**
+     * Provide the next page of results of a query, after moreResultsAvailable
+     * was emitted for it. Called on a worker thread of QueryDispatcher, like query.
+     *
+     * @param text The search text of the query.
+     * @param offset The number of results already provided for the query.
+     * @param token The token of the query; results must be tagged with its generation.
+     */
+    virtual void fetchMore(const QString &text, const int offset, const QueryToken &token)
+    {
+        Q_UNUSED(text)
+        Q_UNUSED(offset)
+        Q_UNUSED(token)
+    }
 
 signals:
-    void resultsReady(QVector<ResultItem> &results, IModule *module);
+    void resultsReady(const QVector<ResultItem> &results, IModule *module, quint64 generation);
+    void moreResultsAvailable(IModule *module, quint64 generation); // Emitted after the results of a query which has more pages.
 };
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QtGlobal>
+#include <atomic>
+#include <memory>
+
+/**
+ * @class QueryToken
+ * @brief Identify a query request and tell whether it has been superseded.
+ *
+ * Each keystroke starts a new query generation. A token belongs to exactly one
+ * generation and reports itself as cancelled as soon as a newer generation is
+ * started, so that a module can stop a long scan early.
+ *
+ * Tokens are cheap to copy and safe to read from any thread.
+ */
+class QueryToken final
+{
+public:
+    QueryToken() = default;
+    QueryToken(std::shared_ptr<const std::atomic<quint64>> currentGeneration, const quint64 generation) :
+        m_currentGeneration(std::move(currentGeneration)), m_generation(generation)
+    {
+    }
+
+    [[nodiscard]] quint64 generation() const { return m_generation; }
+    [[nodiscard]] bool isCancelled() const { return m_currentGeneration && m_currentGeneration->load(std::memory_order_relaxed) != m_generation; }
+
+private:
+    std::shared_ptr<const std::atomic<quint64>> m_currentGeneration;
+    quint64 m_generation = 0;
+};
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <QString>
+#include <QVariant>
 #include <QVector>
 #include "Action.h"
 
+class IModule;
+
 /**
  * @enum IconType
  * @brief Define the types of icons that can be used in a result item.
@@ -34,13 +37,15 @@ enum class IconType
  * - iconGlyph: A single character representing an icon in glyph form.
  * - iconPath: The file path to an external icon source, such as an executable file or an image.
  * - iconType: The type of the icon.
- * - actions: A collection of actions that the user can perform on this item.
  * - key: A unique string allocated to the result item.
+ * - payload: The data the actions of the module need to perform on this item.
+ * - module: The module providing the result; should not be assigned by the module.
  * - priority: The module priority; should not be assigned by the module.
  * - score: The score of the result (1.0 by default).
  *
  * An icon must be provided, either as a font icon or a path.
- * The action list can be empty.
+ * Actions are not stored in the result; they are provided by the module on demand
+ * (see IModule::actions), so a result is cheap to create even if it is never selected.
  * If the key is not provided, the result item will not be written into run history.
  */
 struct ResultItem
@@ -50,8 +55,9 @@ struct ResultItem
     QChar iconGlyph;
     QString iconPath;
     IconType iconType = IconType::None;
-    QVector<Action> actions;
     QString key;
+    QVariant payload;
+    const IModule *module = nullptr;
     double priority = 1.0;
     double score = 1.0;
 };
@@ -1,10 +1,11 @@
 #include "ConfigManager.h"
 #include <QApplication>
 #include <QDir>
+#include <QSaveFile>
 #include <QStandardPaths>
-#include "../app/Launcher.h"
 #include "../common/IModule.h"
 #include "../utils/DialogUtils.h"
+#include "ConfigWatcher.h"
 
 /**
  * Load configuration file for a Launcher module.
@@ -16,7 +17,7 @@
  */
 QJsonDocument ConfigManager::loadConfig(const IModule *module)
 {
-    return loadConfig(getConfigPath(QString(R"(Modules\%1.json)").arg(module->name())), module->defaultConfig());
+    return loadConfig(getModuleConfigPath(module), module->defaultConfig());
 }
 
 /**
@@ -39,6 +40,7 @@ QJsonDocument ConfigManager::loadConfig(const QString &fileName, const QJsonDocu
         file.open(QIODevice::ReadOnly | QIODevice::Text);
         const QByteArray data = file.readAll();
         file.close();
+        ConfigWatcher::instance()->recordContent(configPath, data);
         QJsonParseError error;
         QJsonDocument doc = QJsonDocument::fromJson(data, &error);
 
@@ -51,12 +53,37 @@ QJsonDocument ConfigManager::loadConfig(const QString &fileName, const QJsonDocu
         return doc;
     }
 
+    const QByteArray data = defaultConfig.toJson(QJsonDocument::Indented);
     file.open(QIODevice::WriteOnly | QIODevice::Text);
-    file.write(defaultConfig.toJson(QJsonDocument::Indented));
+    file.write(data);
     file.close();
+    ConfigWatcher::instance()->recordContent(configPath, data);
     return defaultConfig;
 }
 
+/**
+ * Save the configuration file of a Launcher module.
+ *
+ * The file is replaced atomically, so a crash never leaves it truncated.
+ *
+ * @param module A pointer to the module.
+ * @param config The configuration to write.
+ * @return True if the file was written; false otherwise.
+ */
+bool ConfigManager::saveConfig(const IModule *module, const QJsonDocument &config)
+{
+    const QString configPath = getModuleConfigPath(module);
+    const QByteArray data = config.toJson(QJsonDocument::Indented);
+    QSaveFile file(configPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+    file.write(data);
+    if (!file.commit())
+        return false;
+    ConfigWatcher::instance()->recordContent(configPath, data); // Not reported as a change, so the module is not reloaded by its own write.
+    return true;
+}
+
 /**
  * Convert a space-separated string to camel case.
  * @param text The original string.
@@ -92,3 +119,11 @@ QString ConfigManager::getConfigPath(const QString &fileName)
             return {};
     return dir.filePath(fileName);
 }
+
+/**
+ * Get the configuration file path of a Launcher module.
+ *
+ * @param module A pointer to the module.
+ * @return The file path string.
+ */
+QString ConfigManager::getModuleConfigPath(const IModule *module) { return getConfigPath(QString(R"(Modules\%1.json)").arg(module->name())); }
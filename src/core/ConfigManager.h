@@ -12,6 +12,8 @@ public:
 
     static QJsonDocument loadConfig(const IModule *module);
     static QJsonDocument loadConfig(const QString &fileName, const QJsonDocument &defaultConfig);
+    static bool saveConfig(const IModule *module, const QJsonDocument &config);
     static QString toCamelCase(const QString &text);
     static QString getConfigPath(const QString &fileName);
+    static QString getModuleConfigPath(const IModule *module);
 };
@@ -0,0 +1,155 @@
+#include "ConfigWatcher.h"
+#include <QApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+namespace
+{
+    constexpr int CHECK_DELAY_MS = 200; // Editors often write a file in several steps.
+} // namespace
+
+ConfigWatcher *ConfigWatcher::instance()
+{
+    static auto *singleInstance = new ConfigWatcher(qApp);
+    return singleInstance;
+}
+
+ConfigWatcher::ConfigWatcher(QObject *parent) : QObject(parent)
+{
+    m_configDirectory = QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation));
+    m_checkTimer.setSingleShot(true);
+    m_checkTimer.setInterval(CHECK_DELAY_MS);
+    connect(&m_checkTimer, &QTimer::timeout, this, &ConfigWatcher::checkFiles);
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, &m_checkTimer, qOverload<>(&QTimer::start));
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, &m_checkTimer, qOverload<>(&QTimer::start));
+}
+
+/**
+ * Start watching the configuration files: Launcher.json, Theme.json and the files under Modules.
+ *
+ * The folders are watched too, as editors often replace a file instead of writing it.
+ * The files not loaded so far are taken as they are now.
+ */
+void ConfigWatcher::watch()
+{
+    const QStringList paths = configFiles();
+    for (const QString &path : paths)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly))
+            continue;
+        const QByteArray content = file.readAll();
+        file.close();
+        {
+            const QMutexLocker locker(&m_mutex);
+            if (m_states.contains(keyOf(path)))
+                continue;
+        }
+        recordContent(path, content);
+    }
+
+    m_watcher.addPath(m_configDirectory);
+    m_watcher.addPath(m_configDirectory + "/Modules");
+    m_watcher.addPaths(paths);
+}
+
+/**
+ * Report every configuration file as changed, to reload everything in place.
+ */
+void ConfigWatcher::reloadAll()
+{
+    for (const QString &path : configFiles())
+        emit configChanged(QDir(m_configDirectory).relativeFilePath(path));
+}
+
+/**
+ * Remember the content of a configuration file loaded or written by the launcher,
+ * so that only changes made by others are reported. May be called from any thread.
+ *
+ * @param path The path to the file.
+ * @param content The content of the file.
+ */
+void ConfigWatcher::recordContent(const QString &path, const QByteArray &content)
+{
+    const QFileInfo fileInfo(path);
+    const QMutexLocker locker(&m_mutex);
+    FileState &state = m_states[keyOf(path)];
+    state.hash = hashOf(content);
+    state.modified = fileInfo.exists() ? fileInfo.lastModified().toMSecsSinceEpoch() : -1;
+    state.size = fileInfo.exists() ? fileInfo.size() : -1;
+}
+
+/**
+ * Compare the configuration files with their known content, and report the changed ones.
+ *
+ * The content is only hashed when the modification time or the size differ.
+ */
+void ConfigWatcher::checkFiles()
+{
+    const QStringList paths = configFiles();
+    m_watcher.addPaths(paths); // Files replaced by an editor are no longer watched.
+
+    QStringList changedFiles;
+    for (const QString &path : paths)
+    {
+        const QFileInfo fileInfo(path);
+        const qint64 modified = fileInfo.lastModified().toMSecsSinceEpoch();
+        {
+            const QMutexLocker locker(&m_mutex);
+            if (const auto iterator = m_states.constFind(keyOf(path)); iterator != m_states.constEnd() && iterator->modified == modified && iterator->size == fileInfo.size())
+                continue;
+        }
+
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly))
+            continue;
+        const QByteArray hash = hashOf(file.readAll());
+
+        const QMutexLocker locker(&m_mutex);
+        FileState &state = m_states[keyOf(path)];
+        const bool isChanged = state.hash != hash;
+        state = {modified, fileInfo.size(), hash};
+        if (isChanged)
+            changedFiles.append(QDir(m_configDirectory).relativeFilePath(path));
+    }
+
+    for (const QString &fileName : changedFiles)
+        emit configChanged(fileName);
+}
+
+/**
+ * Get the configuration files which can be reloaded.
+ *
+ * @return The paths to the files that exist.
+ */
+QStringList ConfigWatcher::configFiles() const
+{
+    QStringList paths;
+    for (const QString &fileName : {QString("Launcher.json"), QString("Theme.json")})
+        if (const QString path = m_configDirectory + "/" + fileName; QFileInfo::exists(path))
+            paths.append(path);
+    const QDir modulesDirectory(m_configDirectory + "/Modules");
+    for (const QString &fileName : modulesDirectory.entryList({"*.json"}, QDir::Files))
+        paths.append(modulesDirectory.filePath(fileName));
+    return paths;
+}
+
+/**
+ * Get the key of a file in the states, the same whichever separators the path uses.
+ *
+ * @param path The path to the file.
+ * @return The cleaned absolute path.
+ */
+QString ConfigWatcher::keyOf(const QString &path) { return QDir::cleanPath(QFileInfo(QDir::fromNativeSeparators(path)).absoluteFilePath()); }
+
+/**
+ * Hash the content of a configuration file, ignoring carriage returns, as the
+ * files are written and read in text mode.
+ *
+ * @param content The content.
+ * @return The hash.
+ */
+QByteArray ConfigWatcher::hashOf(const QByteArray &content) { return QCryptographicHash::hash(QByteArray(content).replace('\r', QByteArray()), QCryptographicHash::Sha1); }
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+
+class ConfigWatcher final : public QObject
+{
+    Q_OBJECT
+
+public:
+    static ConfigWatcher *instance();
+
+    void watch();
+    void reloadAll();
+    void recordContent(const QString &path, const QByteArray &content);
+
+    ConfigWatcher(const ConfigWatcher &) = delete;
+    ConfigWatcher &operator=(const ConfigWatcher &) = delete;
+
+signals:
+    void configChanged(const QString &fileName); // The name of the file in the configuration folder, such as "Launcher.json" or "Modules/Calculator.json".
+
+private:
+    /**
+     * @struct FileState
+     * @brief What is known of the content of a configuration file.
+     */
+    struct FileState
+    {
+        qint64 modified = -1;
+        qint64 size = -1;
+        QByteArray hash; // The hash of the content last loaded or written by the launcher.
+    };
+
+    explicit ConfigWatcher(QObject *parent = nullptr);
+
+    void checkFiles();
+
+    [[nodiscard]] QStringList configFiles() const;
+    [[nodiscard]] static QString keyOf(const QString &path);
+    [[nodiscard]] static QByteArray hashOf(const QByteArray &content);
+
+    QString m_configDirectory;
+    QFileSystemWatcher m_watcher;
+    QTimer m_checkTimer;
+    QMutex m_mutex; // Guards the states, as configurations are loaded on worker threads too.
+    QHash<QString, FileState> m_states; // By cleaned absolute path.
+};
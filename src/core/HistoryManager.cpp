@@ -2,38 +2,61 @@
 #include <QApplication>
 #include <QDir>
 #include <QJsonDocument>
+#include <QJsonArray>
 #include <QJsonObject>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
 #include "../utils/DialogUtils.h"
 #include "ConfigManager.h"
 
+namespace
+{
+    constexpr auto DATE_FORMAT = "yyyy-MM-dd hh:mm:ss";
+    constexpr int COMPACTION_THRESHOLD = 256; // Launches journaled before the snapshot is rewritten.
+    constexpr int EVICTION_SAMPLES = 8;
+    constexpr double DAY_MS = 24.0 * 60 * 60 * 1000;
+    constexpr qint64 MINUTE_MS = 60 * 1000;
+    constexpr int MAX_PREFIX_DEPTH = 8; // Longer queries share the node of their first characters.
+    constexpr int MAX_PREFIX_NODES = 20000;
+    constexpr int PRUNED_PREFIX_NODES = MAX_PREFIX_NODES * 3 / 4; // The nodes kept when the trie is full, so that it is not pruned at every launch.
+    constexpr int PICKS_PER_PREFIX = 4;
+    constexpr double PREFIX_BOOST = 1.0; // The boost of a key always picked after a prefix, relative to the history weight.
+    constexpr double MIN_PICK_SCORE = 0.01; // Picks decayed below this score are dropped at compaction.
+    constexpr int MAX_LAUNCH_SAMPLES = 10000; // The launches kept in the launch samples; older ones are dropped at startup.
+} // namespace
+
 /**
  * Initialize history manager.
  *
- * Read history from application storage, calculate and apply the popularity
- * decay.
+ * Read the history snapshot from application storage and replay the launches
+ * journaled since the snapshot was written.
  *
- * If the history file does not exist, create a blank file.
+ * The snapshot is only rewritten by compaction, on a background thread.
  *
- * @param decay The factor to multiply the score by each day.
- * @param minScore The lowest score to keep in history; if a score is lower,
- * the key is removed.
+ * @param decay The factor the score is multiplied by over a day; applied continuously.
+ * @param capacity The largest number of keys to keep in history; when full, a
+ * rarely and long ago launched key is evicted to make room.
  * @param increment The value to add to the score after each launch.
  * @param scoreWeight The weight of history score.
  */
-void HistoryManager::initHistory(const double &decay, const double &minScore, const double &increment, const double &scoreWeight)
+void HistoryManager::initHistory(const double &decay, const int &capacity, const double &increment, const double &scoreWeight)
 {
-    m_increment = increment;
-    m_scoreWeight = scoreWeight;
+    updateSettings(decay, capacity, increment, scoreWeight);
+    m_writer = new QThreadPool(qApp); // Owned by the application, which waits for the pending writes when quitting.
+    m_writer->setMaxThreadCount(1);
 
     QFile file(ConfigManager::getConfigPath("History.json"));
-
-    if (file.exists())
+    const bool snapshotExists = file.exists();
+    quint64 snapshotSequence = 0;
+    if (snapshotExists)
     {
         file.open(QIODevice::ReadOnly | QIODevice::Text);
         const QByteArray data = file.readAll();
         file.close();
         QJsonParseError error;
-        QJsonDocument doc = QJsonDocument::fromJson(data, &error);
+        const QJsonDocument doc = QJsonDocument::fromJson(data, &error);
 
         if (error.error != QJsonParseError::NoError)
         {
@@ -43,80 +66,136 @@ void HistoryManager::initHistory(const double &decay, const double &minScore, co
         }
 
         const QJsonObject rootObject = doc.object();
+        const QJsonObject entriesObject = rootObject["entries"].toObject();
+        m_entries.reserve(std::min(entriesObject.size(), m_capacity));
+        for (auto iterator = entriesObject.constBegin(); iterator != entriesObject.constEnd(); ++iterator)
+        {
+            const QJsonArray entryArray = iterator.value().toArray();
+            Entry &entry = entryOf(iterator.key());
+            entry.score = entryArray.at(0).toDouble();
+            entry.lastAccess = entryArray.at(1).toInteger();
+        }
 
-        // Read history and apply popularity decay.
-        QJsonObject scoresObject = rootObject["scores"].toObject();
-        const QDateTime now = QDateTime::currentDateTime();
-        const QDateTime lastUpdate = QDateTime::fromString(rootObject["lastUpdate"].toString(), "yyyy-MM-dd hh:mm:ss");
-        const int days = static_cast<int>(lastUpdate.date().daysTo(now.date()));
-        const double factor = pow(decay, days);
-        for (const QString &key : scoresObject.keys())
+        // Scores written before the entries had their own access time, all as of the last update.
+        const qint64 lastUpdate = QDateTime::fromString(rootObject["lastUpdate"].toString(), DATE_FORMAT).toMSecsSinceEpoch();
+        const QJsonObject scoresObject = rootObject["scores"].toObject();
+        for (auto iterator = scoresObject.constBegin(); iterator != scoresObject.constEnd(); ++iterator)
         {
-            const double newScore = scoresObject[key].toDouble() * factor;
-            scoresObject[key] = newScore;
-            if (newScore < minScore)
-                scoresObject.remove(key);
-            m_scores[key] = newScore;
+            Entry &entry = entryOf(iterator.key());
+            entry.score = iterator.value().toDouble();
+            entry.lastAccess = lastUpdate;
         }
-        QJsonObject newRootObject;
-        newRootObject["scores"] = scoresObject;
-        newRootObject["lastUpdate"] = now.toString("yyyy-MM-dd hh:mm:ss");
-        doc = QJsonDocument(newRootObject);
-
-        // Write into file.
-        file.open(QIODevice::WriteOnly | QIODevice::Text);
-        file.write(doc.toJson(QJsonDocument::Indented));
-        file.close();
-        m_initialized = true;
-        return;
+
+        const QJsonObject prefixesObject = rootObject["prefixes"].toObject();
+        for (auto iterator = prefixesObject.constBegin(); iterator != prefixesObject.constEnd(); ++iterator)
+        {
+            const QString prefix = iterator.key();
+            quint32 node = 0;
+            for (qsizetype depth = 0; depth < std::min<qsizetype>(prefix.size(), MAX_PREFIX_DEPTH) && (depth == 0 || node != 0); ++depth)
+                node = prefixChildOf(node, prefix.at(depth), true);
+            if (node == 0)
+                continue;
+            for (const QJsonValue &pickValue : iterator.value().toArray())
+            {
+                const QJsonArray pickArray = pickValue.toArray();
+                addPick(m_prefixNodes[node].picks, pickArray.at(0).toString().toULongLong(nullptr, 16), pickArray.at(1).toDouble(),
+                        pickArray.at(2).toInteger());
+            }
+        }
+        snapshotSequence = static_cast<quint64>(rootObject["journalSequence"].toInteger());
     }
 
-    // Create a blank file.
-    file.open(QIODevice::WriteOnly | QIODevice::Text);
-    QJsonObject rootObject;
-    rootObject["lastUpdate"] = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss");
-    rootObject["scores"] = QJsonObject();
-    const auto doc = QJsonDocument(rootObject);
-    file.write(doc.toJson(QJsonDocument::Indented));
-    file.close();
+    m_lastSequence = snapshotSequence;
+    const qsizetype journalLines = replayJournal(snapshotSequence);
     m_initialized = true;
+    qInfo() << "History:" << m_entries.size() << "keys of" << m_capacity << "and" << m_prefixNodes.size() << "prefixes of" << MAX_PREFIX_NODES << "in about"
+            << memoryUsage() / 1024 << "KB";
+
+    // Fold the journal into the snapshot, or create a blank snapshot.
+    if (journalLines > 0 || !snapshotExists)
+        compact();
+    m_writer->start([] { reportLaunches(); });
+}
+
+/**
+ * Apply new history settings in place, keeping the scores.
+ *
+ * @param decay The factor the score is multiplied by over a day; applied continuously.
+ * @param capacity The largest number of keys to keep in history; the excess keys are evicted.
+ * @param increment The value to add to the score after each launch.
+ * @param scoreWeight The weight of history score.
+ */
+void HistoryManager::updateSettings(const double &decay, const int &capacity, const double &increment, const double &scoreWeight)
+{
+    m_logDecayPerMs = std::log(decay) / DAY_MS;
+    m_capacity = std::max(1, capacity);
+    m_increment = increment;
+    m_scoreWeight = scoreWeight;
+
+    while (m_entries.size() > m_capacity)
+        evict();
+    for (Entry &entry : m_entries)
+        entry.factorMinute = -1; // The cached factors depend on the weight and the decay.
 }
 
 /**
  * Add a history item.
  *
+ * Only the launch is written, by appending it to the journal on a background
+ * thread; the scores are written by the next compaction.
+ *
  * @param key The unique key of the result.
+ * @param query The query typed before launching the result, to learn which
+ * result is picked after typing its prefixes.
  */
-void HistoryManager::addHistory(const QString &key)
+void HistoryManager::addHistory(const QString &key, const QString &query)
 {
     if (!m_initialized)
         return;
 
-    if (m_scores.contains(key))
-        m_scores[key] += m_increment;
-    else
-        m_scores[key] = m_increment;
+    const qint64 time = QDateTime::currentMSecsSinceEpoch();
+    const QString prefix = normalizedQuery(query);
+    touch(key, time);
+    recordPrefixes(prefix, hashOf(key), time);
 
-    // Write into file.
-    QJsonObject rootObject;
-    const QDateTime now = QDateTime::currentDateTime();
-    rootObject["lastUpdate"] = now.toString("yyyy-MM-dd hh:mm:ss");
-    QJsonObject scoresObject;
-    for (auto iterator = m_scores.constBegin(); iterator != m_scores.constEnd(); ++iterator)
-    {
-        scoresObject[iterator.key()] = iterator.value();
-    }
-    rootObject["scores"] = scoresObject;
-    const auto doc = QJsonDocument(rootObject);
-    QFile file(ConfigManager::getConfigPath("History.json"));
-    file.open(QIODevice::WriteOnly | QIODevice::Text);
-    file.write(doc.toJson(QJsonDocument::Indented));
-    file.close();
+    const quint64 sequence = ++m_lastSequence;
+    m_writer->start([sequence, time, key, prefix] { appendToJournal(sequence, time, key, prefix); });
+    if (++m_journalLength >= COMPACTION_THRESHOLD)
+        compact();
+}
+
+/**
+ * Add the keystrokes and the time it took to launch a result since the window was shown.
+ *
+ * The samples are appended to Launches.tsv in the configuration folder on a
+ * background thread, one launch per line as "time\tkeystrokes\tlaunchTime",
+ * with the times in ms; a report over them is logged at the next startup.
+ *
+ * @param keystrokes The edits of the search text before the launch.
+ * @param launchTime The time from showing the window to the launch, in ms.
+ */
+void HistoryManager::addLaunchSample(const int keystrokes, const qint64 launchTime)
+{
+    if (!m_initialized)
+        return;
+
+    const qint64 time = QDateTime::currentMSecsSinceEpoch();
+    m_writer->start(
+        [time, keystrokes, launchTime]
+        {
+            QFile samples(ConfigManager::getConfigPath("Launches.tsv"));
+            if (!samples.open(QIODevice::WriteOnly | QIODevice::Append))
+                return;
+            samples.write(QByteArray::number(time) + '\t' + QByteArray::number(keystrokes) + '\t' + QByteArray::number(launchTime) + '\n');
+        });
 }
 
 /**
  * Retrieve history score of a key.
  *
+ * The weighted score is cached in the entry and only recomputed once a minute,
+ * as the decay is negligible in between.
+ *
  * @param key The unique key of the result.
  * @return The final history score.
  */
@@ -125,9 +204,485 @@ double HistoryManager::getHistoryScore(const QString &key)
     if (!m_initialized)
         return 1;
 
-    if (m_scores.contains(key))
+    const auto iterator = m_indices.constFind(hashOf(key));
+    if (iterator == m_indices.constEnd())
+        return 1;
+    Entry &entry = m_entries[iterator.value()];
+    if (entry.key != key)
+        return 1; // Another key with the same hash.
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (const qint64 minute = now / MINUTE_MS; minute != entry.factorMinute)
+    {
+        entry.factor = 1 + std::log(decayedScore(entry.score, entry.lastAccess, now) + 1) * m_scoreWeight;
+        entry.factorMinute = minute;
+    }
+    return entry.factor;
+}
+
+/**
+ * Find the entry of a key, or add a blank one, evicting another if the history is full.
+ *
+ * A key whose hash collides with another key takes over its entry.
+ *
+ * @param key The unique key of the result.
+ * @return The entry.
+ */
+HistoryManager::Entry &HistoryManager::entryOf(const QString &key)
+{
+    const quint64 hash = hashOf(key);
+    if (const auto iterator = m_indices.constFind(hash); iterator != m_indices.constEnd())
+    {
+        Entry &entry = m_entries[iterator.value()];
+        if (entry.key != key)
+            entry = {key, hash};
+        return entry;
+    }
+
+    if (m_entries.size() >= m_capacity)
+        evict();
+    m_indices.insert(hash, m_entries.size());
+    m_entries.append({key, hash});
+    return m_entries.last();
+}
+
+/**
+ * Count a launch in the score of a key.
+ *
+ * @param key The unique key of the result.
+ * @param time The time of the launch in ms since epoch.
+ */
+void HistoryManager::touch(const QString &key, const qint64 time)
+{
+    Entry &entry = entryOf(key);
+    entry.score = decayedScore(entry.score, entry.lastAccess, time) + m_increment;
+    entry.lastAccess = std::max(entry.lastAccess, time);
+    entry.factorMinute = -1;
+}
+
+/**
+ * Remove the entry with the lowest current score among a few random ones.
+ *
+ * The decayed score counts both how often and how recently a key was launched,
+ * so this approximates evicting the least frequently used key without a scan.
+ */
+void HistoryManager::evict()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qsizetype victim = QRandomGenerator::global()->bounded(m_entries.size());
+    for (int sample = 1; sample < EVICTION_SAMPLES; ++sample)
+    {
+        const qsizetype candidate = QRandomGenerator::global()->bounded(m_entries.size());
+        const Entry &candidateEntry = m_entries.at(candidate), &victimEntry = m_entries.at(victim);
+        if (decayedScore(candidateEntry.score, candidateEntry.lastAccess, now) < decayedScore(victimEntry.score, victimEntry.lastAccess, now))
+            victim = candidate;
+    }
+
+    // Move the last entry into the freed slot, so that the entries stay dense.
+    m_indices.remove(m_entries.at(victim).hash);
+    if (const qsizetype last = m_entries.size() - 1; victim != last)
+    {
+        m_entries[victim] = std::move(m_entries[last]);
+        m_indices[m_entries.at(victim).hash] = victim;
+    }
+    m_entries.removeLast();
+}
+
+/**
+ * Get the boosts of the keys usually picked after typing a query.
+ *
+ * A key gets a boost in proportion to its share of the picks after typing the
+ * query, or its first characters if the query is longer than the trie.
+ *
+ * @param query The query.
+ * @return The factor to multiply the rank by, by hash of key; keys not in the result are not boosted.
+ */
+QHash<quint64, double> HistoryManager::getPrefixBoosts(const QString &query)
+{
+    QHash<quint64, double> boosts;
+    const QString prefix = normalizedQuery(query);
+    if (!m_initialized || prefix.isEmpty() || m_prefixNodes.isEmpty())
+        return boosts;
+
+    quint32 node = 0;
+    for (qsizetype depth = 0; depth < std::min<qsizetype>(prefix.size(), MAX_PREFIX_DEPTH); ++depth)
+        if ((node = prefixChildOf(node, prefix.at(depth), false)) == 0)
+            return boosts;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const QVector<Pick> &picks = m_prefixNodes.at(node).picks;
+    double total = 0;
+    for (const Pick &pick : picks)
+        total += decayedScore(pick.score, pick.lastAccess, now);
+    if (total <= 0)
+        return boosts;
+    for (const Pick &pick : picks)
+        boosts.insert(pick.hash, 1 + PREFIX_BOOST * m_scoreWeight * decayedScore(pick.score, pick.lastAccess, now) / total);
+    return boosts;
+}
+
+/**
+ * Count a launch in the picks of every prefix of its query.
+ *
+ * @param query The normalized query.
+ * @param hash The hash of the launched key.
+ * @param time The time of the launch in ms since epoch.
+ */
+void HistoryManager::recordPrefixes(const QString &query, const quint64 hash, const qint64 time)
+{
+    // Make room for the whole query first, as pruning renumbers the nodes.
+    if (m_prefixNodes.size() + MAX_PREFIX_DEPTH > MAX_PREFIX_NODES)
+        prunePrefixes(time, PRUNED_PREFIX_NODES);
+
+    quint32 node = 0;
+    for (qsizetype depth = 0; depth < std::min<qsizetype>(query.size(), MAX_PREFIX_DEPTH); ++depth)
+    {
+        if ((node = prefixChildOf(node, query.at(depth), true)) == 0)
+            return; // The trie is still full.
+        addPick(m_prefixNodes[node].picks, hash, m_increment, time);
+    }
+}
+
+/**
+ * Add to the score of a key in the picks of a prefix.
+ *
+ * When the picks are full, the one with the lowest current score makes room.
+ *
+ * @param picks The picks of the prefix.
+ * @param hash The hash of the key.
+ * @param increment The value to add to the score.
+ * @param lastAccess The time of the pick in ms since epoch.
+ */
+void HistoryManager::addPick(QVector<Pick> &picks, const quint64 hash, const double increment, const qint64 lastAccess)
+{
+    qsizetype lowest = -1;
+    double lowestScore = 0;
+    for (qsizetype index = 0; index < picks.size(); ++index)
+    {
+        Pick &pick = picks[index];
+        const double score = decayedScore(pick.score, pick.lastAccess, lastAccess);
+        if (pick.hash == hash)
+        {
+            pick.score = score + increment;
+            pick.lastAccess = std::max(pick.lastAccess, lastAccess);
+            return;
+        }
+        if (lowest < 0 || score < lowestScore)
+        {
+            lowest = index;
+            lowestScore = score;
+        }
+    }
+
+    if (picks.size() < PICKS_PER_PREFIX)
+        picks.append({hash, increment, lastAccess});
+    else
+        picks[lowest] = {hash, increment, lastAccess};
+}
+
+/**
+ * Find the child of a node of the prefix trie.
+ *
+ * @param parent The index of the parent node.
+ * @param character The character following the prefix of the parent.
+ * @param create Whether to add the child if it does not exist.
+ * @return The index of the child; 0 if it does not exist and cannot be added.
+ */
+quint32 HistoryManager::prefixChildOf(const quint32 parent, const QChar character, const bool create)
+{
+    if (m_prefixNodes.isEmpty())
+        m_prefixNodes.append({});
+
+    const quint64 edge = static_cast<quint64>(parent) << 16 | character.unicode();
+    if (const auto iterator = m_prefixEdges.constFind(edge); iterator != m_prefixEdges.constEnd())
+        return iterator.value();
+    if (!create || m_prefixNodes.size() >= MAX_PREFIX_NODES)
+        return 0;
+
+    const auto child = static_cast<quint32>(m_prefixNodes.size());
+    m_prefixNodes.append({parent, character, {}});
+    m_prefixEdges.insert(edge, child);
+    return child;
+}
+
+/**
+ * Remove the prefixes whose picks decayed, and the weakest ones if too many remain.
+ *
+ * The strength of a node is the highest current score of its picks and of the
+ * picks of its descendants, so a kept node always keeps its ancestors. The
+ * nodes are renumbered in their order, which keeps parents before children.
+ *
+ * @param time The current time in ms since epoch.
+ * @param maxNodes The largest number of nodes to keep, the root included.
+ */
+void HistoryManager::prunePrefixes(const qint64 time, const qsizetype maxNodes)
+{
+    if (m_prefixNodes.size() <= 1)
+        return;
+
+    QVector<double> strengths(m_prefixNodes.size(), 0);
+    for (qsizetype node = m_prefixNodes.size() - 1; node > 0; --node)
+    {
+        PrefixNode &prefixNode = m_prefixNodes[node];
+        prefixNode.picks.removeIf([time](const Pick &pick) { return decayedScore(pick.score, pick.lastAccess, time) < MIN_PICK_SCORE; });
+        for (const Pick &pick : std::as_const(prefixNode.picks))
+            strengths[node] = std::max(strengths.at(node), decayedScore(pick.score, pick.lastAccess, time));
+        strengths[prefixNode.parent] = std::max(strengths.at(prefixNode.parent), strengths.at(node));
+    }
+
+    // Keep the strongest nodes above the threshold; on a tie at the threshold, the tied nodes go.
+    double threshold = 0;
+    if (const qsizetype liveCount = std::count_if(strengths.cbegin() + 1, strengths.cend(), [](const double strength) { return strength > 0; });
+        liveCount > maxNodes - 1)
+    {
+        QVector<double> sorted(strengths.cbegin() + 1, strengths.cend());
+        const auto rank = sorted.begin() + (sorted.size() - (maxNodes - 1)) - 1;
+        std::nth_element(sorted.begin(), rank, sorted.end());
+        threshold = *rank;
+    }
+
+    QVector<PrefixNode> nodes;
+    QVector<quint32> renumbered(m_prefixNodes.size(), 0);
+    m_prefixEdges.clear();
+    nodes.append(std::move(m_prefixNodes.first()));
+    for (qsizetype node = 1; node < m_prefixNodes.size(); ++node)
+    {
+        if (strengths.at(node) <= threshold)
+            continue;
+        PrefixNode &prefixNode = m_prefixNodes[node];
+        const quint32 parent = renumbered.at(prefixNode.parent);
+        renumbered[node] = static_cast<quint32>(nodes.size());
+        m_prefixEdges.insert(static_cast<quint64>(parent) << 16 | prefixNode.character.unicode(), renumbered.at(node));
+        nodes.append({parent, prefixNode.character, std::move(prefixNode.picks)});
+    }
+    m_prefixNodes = std::move(nodes);
+}
+
+/**
+ * Replay the launches journaled after the snapshot, in order.
+ *
+ * Each line of the journal is "sequence\ttime\tkey\tquery", with the time in ms
+ * since epoch and the normalized query. A line torn by a crash while appending
+ * is skipped.
+ *
+ * @param snapshotSequence The sequence number of the last launch in the snapshot.
+ * @return The number of lines in the journal.
+ */
+qsizetype HistoryManager::replayJournal(const quint64 snapshotSequence)
+{
+    QFile journal(ConfigManager::getConfigPath("History.journal"));
+    if (!journal.open(QIODevice::ReadOnly))
+        return 0;
+
+    qsizetype lineCount = 0;
+    while (!journal.atEnd())
+    {
+        QByteArray line = journal.readLine();
+        ++lineCount;
+        if (!line.endsWith('\n'))
+            continue;
+        line.chop(1);
+
+        const QList<QByteArray> fields = line.split('\t');
+        bool isSequenceValid = false, isTimeValid = false;
+        const bool isComplete = fields.size() == 3 || fields.size() == 4; // Lines written before the query was journaled have 3 fields.
+        const quint64 sequence = isComplete ? fields[0].toULongLong(&isSequenceValid) : 0;
+        const qint64 time = isComplete ? fields[1].toLongLong(&isTimeValid) : 0;
+        if (!isSequenceValid || !isTimeValid || sequence <= snapshotSequence)
+            continue;
+
+        const QString key = QString::fromUtf8(fields[2]);
+        touch(key, time);
+        if (fields.size() == 4)
+            recordPrefixes(QString::fromUtf8(fields[3]), hashOf(key), time);
+        m_lastSequence = std::max(m_lastSequence, sequence);
+    }
+    return lineCount;
+}
+
+/**
+ * Write a snapshot of the scores and empty the journal, on the background thread.
+ *
+ * The prefixes whose picks decayed are removed from the trie first, so that it
+ * keeps learning new ones.
+ *
+ * The writes queued before are done first, so the snapshot covers every launch
+ * up to the current sequence number.
+ */
+void HistoryManager::compact()
+{
+    m_journalLength = 0;
+    prunePrefixes(QDateTime::currentMSecsSinceEpoch(), MAX_PREFIX_NODES);
+    m_writer->start([entries = m_entries, prefixNodes = m_prefixNodes, sequence = m_lastSequence] { writeSnapshot(entries, prefixNodes, sequence); });
+}
+
+/**
+ * Append a launch to the journal. Called on the background thread.
+ *
+ * @param sequence The sequence number of the launch.
+ * @param time The time of the launch in ms since epoch.
+ * @param key The unique key of the result.
+ * @param query The normalized query typed before the launch.
+ */
+void HistoryManager::appendToJournal(const quint64 sequence, const qint64 time, const QString &key, const QString &query)
+{
+    QFile journal(ConfigManager::getConfigPath("History.journal"));
+    if (!journal.open(QIODevice::WriteOnly | QIODevice::Append))
+        return;
+    journal.write(QByteArray::number(sequence) + '\t' + QByteArray::number(time) + '\t' + key.toUtf8() + '\t' + query.toUtf8() + '\n');
+}
+
+/**
+ * Replace the snapshot atomically, then empty the journal. Called on the background thread.
+ *
+ * A crash between the two steps is harmless: the snapshot records the sequence
+ * number of its last launch, and older journal lines are skipped on replay.
+ *
+ * @param entries The entries to write.
+ * @param prefixNodes The nodes of the prefix trie to write.
+ * @param sequence The sequence number of the last launch counted in the entries.
+ */
+void HistoryManager::writeSnapshot(const QVector<Entry> &entries, const QVector<PrefixNode> &prefixNodes, const quint64 sequence)
+{
+    QJsonObject entriesObject;
+    for (const Entry &entry : entries)
+        entriesObject[entry.key] = QJsonArray{entry.score, entry.lastAccess};
+
+    // The trie is saved by prefix, so that the nodes left without picks are not loaded again.
+    QJsonObject prefixesObject;
+    for (qsizetype node = 1; node < prefixNodes.size(); ++node)
+    {
+        QJsonArray picksArray;
+        for (const Pick &pick : prefixNodes.at(node).picks)
+            picksArray.append(QJsonArray{QString::number(pick.hash, 16), pick.score, pick.lastAccess});
+        if (picksArray.isEmpty())
+            continue;
+
+        QString prefix;
+        for (auto ancestor = static_cast<quint32>(node); ancestor != 0; ancestor = prefixNodes.at(ancestor).parent)
+            prefix.prepend(prefixNodes.at(ancestor).character);
+        prefixesObject[prefix] = picksArray;
+    }
+    QJsonObject rootObject;
+    rootObject["lastUpdate"] = QDateTime::currentDateTime().toString(DATE_FORMAT);
+    rootObject["entries"] = entriesObject;
+    rootObject["prefixes"] = prefixesObject;
+    rootObject["journalSequence"] = static_cast<qint64>(sequence);
+
+    QSaveFile file(ConfigManager::getConfigPath("History.json"));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return;
+    file.write(QJsonDocument(rootObject).toJson(QJsonDocument::Indented));
+    if (!file.commit())
+    {
+        qWarning() << "History: failed to save the snapshot";
+        return;
+    }
+
+    QFile journal(ConfigManager::getConfigPath("History.journal"));
+    if (journal.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        journal.close();
+}
+
+/**
+ * Log a report of the launch samples, and drop the oldest ones beyond the limit. Called on the background thread.
+ *
+ * The report gives the median and the 90th percentile of the keystrokes and
+ * of the time to launch a result.
+ */
+void HistoryManager::reportLaunches()
+{
+    QFile samples(ConfigManager::getConfigPath("Launches.tsv"));
+    if (!samples.open(QIODevice::ReadOnly))
+        return;
+    QList<QByteArray> lines = samples.readAll().split('\n');
+    samples.close();
+    lines.removeIf([](const QByteArray &line) { return line.count('\t') != 2; }); // Also the line torn by a crash while appending.
+    if (lines.isEmpty())
+        return;
+
+    if (lines.size() > MAX_LAUNCH_SAMPLES)
     {
-        return 1 + log(m_scores[key] + 1) * m_scoreWeight;
+        lines.remove(0, lines.size() - MAX_LAUNCH_SAMPLES);
+        QSaveFile file(samples.fileName());
+        if (file.open(QIODevice::WriteOnly))
+        {
+            file.write(lines.join('\n') + '\n');
+            if (!file.commit())
+                qWarning() << "History: failed to trim the launch samples";
+        }
     }
-    return 1;
+
+    QVector<qint64> keystrokes, launchTimes;
+    for (const QByteArray &line : std::as_const(lines))
+    {
+        const QList<QByteArray> fields = line.split('\t');
+        keystrokes.append(fields[1].toLongLong());
+        launchTimes.append(fields[2].toLongLong());
+    }
+    const auto percentile = [](QVector<qint64> &values, const double fraction)
+    {
+        const auto rank = values.begin() + static_cast<qsizetype>(fraction * static_cast<double>(values.size() - 1));
+        std::nth_element(values.begin(), rank, values.end());
+        return *rank;
+    };
+    qInfo() << "Launches:" << lines.size() << "recorded; median" << percentile(keystrokes, 0.5) << "keystrokes," << percentile(launchTimes, 0.5)
+            << "ms; 90th percentile" << percentile(keystrokes, 0.9) << "keystrokes," << percentile(launchTimes, 0.9) << "ms";
+}
+
+/**
+ * Get a score at a time, with the popularity decay since its last access.
+ *
+ * @param score The score at the last access.
+ * @param lastAccess The time of the last access in ms since epoch.
+ * @param time The time in ms since epoch.
+ * @return The decayed score.
+ */
+double HistoryManager::decayedScore(const double score, const qint64 lastAccess, const qint64 time)
+{
+    if (time <= lastAccess)
+        return score;
+    return score * std::exp(m_logDecayPerMs * static_cast<double>(time - lastAccess));
+}
+
+/**
+ * Normalize a query for the prefix trie.
+ *
+ * @param query The query as typed.
+ * @return The query in lower case, with whitespace trimmed and collapsed; also free of tabs and line breaks, as required by the journal.
+ */
+QString HistoryManager::normalizedQuery(const QString &query) { return query.simplified().toLower(); }
+
+/**
+ * Hash a key with 64-bit FNV-1a over its UTF-16 code units.
+ *
+ * @param key The unique key of the result.
+ * @return The hash.
+ */
+quint64 HistoryManager::hashOf(const QString &key)
+{
+    quint64 hash = 14695981039346656037ULL;
+    for (const QChar character : key)
+    {
+        hash ^= character.unicode();
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * Estimate the memory used by the history index.
+ *
+ * @return The size in bytes.
+ */
+qsizetype HistoryManager::memoryUsage()
+{
+    qsizetype bytes = m_entries.capacity() * static_cast<qsizetype>(sizeof(Entry));
+    for (const Entry &entry : m_entries)
+        bytes += entry.key.capacity() * static_cast<qsizetype>(sizeof(QChar));
+    // Each hash node holds the key and the value, and each bucket a pointer.
+    bytes += m_indices.capacity() * static_cast<qsizetype>(sizeof(quint64) + sizeof(qsizetype) + sizeof(void *));
+    bytes += m_prefixNodes.capacity() * static_cast<qsizetype>(sizeof(PrefixNode) + PICKS_PER_PREFIX * sizeof(Pick));
+    bytes += m_prefixEdges.capacity() * static_cast<qsizetype>(sizeof(quint64) + sizeof(quint32) + sizeof(void *));
+    return bytes;
 }
@@ -1,20 +1,95 @@
 #pragma once
 
-#include <QMap>
+#include <QHash>
 #include <QObject>
+#include <QThreadPool>
+#include <QVector>
 
 class HistoryManager final
 {
 public:
     HistoryManager() = delete;
 
-    static void initHistory(const double &decay, const double &minScore, const double &increment, const double &scoreWeight);
-    static void addHistory(const QString &key);
+    static void initHistory(const double &decay, const int &capacity, const double &increment, const double &scoreWeight);
+    static void updateSettings(const double &decay, const int &capacity, const double &increment, const double &scoreWeight);
+    static void addHistory(const QString &key, const QString &query = {});
+    static void addLaunchSample(int keystrokes, qint64 launchTime);
     static double getHistoryScore(const QString &key);
+    [[nodiscard]] static QHash<quint64, double> getPrefixBoosts(const QString &query);
+    [[nodiscard]] static quint64 hashOf(const QString &key);
 
 private:
+    /**
+     * @struct Entry
+     * @brief A launched result.
+     *
+     * Members:
+     *
+     * - key: The unique key of the result.
+     * - hash: The hash of the key, see hashOf.
+     * - score: The score at the last access; it decays continuously from then on.
+     * - lastAccess: The time of the last launch, in ms since epoch.
+     * - factor: The weighted history score, cached for the minute factorMinute.
+     */
+    struct Entry
+    {
+        QString key;
+        quint64 hash = 0;
+        double score = 0;
+        qint64 lastAccess = 0;
+        double factor = 1;
+        qint64 factorMinute = -1;
+    };
+
+    /**
+     * @struct Pick
+     * @brief A key picked after typing a query prefix, with its decaying score.
+     */
+    struct Pick
+    {
+        quint64 hash = 0;
+        double score = 0;
+        qint64 lastAccess = 0;
+    };
+
+    /**
+     * @struct PrefixNode
+     * @brief A node of the query prefix trie, holding the keys most picked after typing its prefix.
+     */
+    struct PrefixNode
+    {
+        quint32 parent = 0;
+        QChar character;
+        QVector<Pick> picks;
+    };
+
+    static Entry &entryOf(const QString &key);
+    static void touch(const QString &key, qint64 time);
+    static void evict();
+    static void recordPrefixes(const QString &query, quint64 hash, qint64 time);
+    static void addPick(QVector<Pick> &picks, quint64 hash, double increment, qint64 lastAccess);
+    static quint32 prefixChildOf(quint32 parent, QChar character, bool create);
+    static void prunePrefixes(qint64 time, qsizetype maxNodes);
+    static qsizetype replayJournal(quint64 snapshotSequence);
+    static void compact();
+    static void appendToJournal(quint64 sequence, qint64 time, const QString &key, const QString &query);
+    static void writeSnapshot(const QVector<Entry> &entries, const QVector<PrefixNode> &prefixNodes, quint64 sequence);
+    static void reportLaunches();
+
+    [[nodiscard]] static double decayedScore(double score, qint64 lastAccess, qint64 time);
+    [[nodiscard]] static QString normalizedQuery(const QString &query);
+    [[nodiscard]] static qsizetype memoryUsage();
+
     static inline bool m_initialized;
+    static inline double m_logDecayPerMs; // The logarithm of the daily decay, spread over a day in ms.
+    static inline qsizetype m_capacity;
     static inline double m_increment;
     static inline double m_scoreWeight;
-    static inline QMap<QString, double> m_scores;
+    static inline QVector<Entry> m_entries;
+    static inline QHash<quint64, qsizetype> m_indices; // Index of each entry in m_entries, by hash of its key.
+    static inline QVector<PrefixNode> m_prefixNodes; // The first node is the root, for the empty prefix.
+    static inline QHash<quint64, quint32> m_prefixEdges; // Index of each child node, by (parent << 16 | character).
+    static inline quint64 m_lastSequence = 0; // The sequence number of the last journaled launch.
+    static inline int m_journalLength = 0; // The launches journaled since the last compaction.
+    static inline QThreadPool *m_writer = nullptr; // A single thread, so that the journal and the snapshot are written in order.
 };
@@ -0,0 +1,246 @@
+#include "IconAtlas.h"
+#include <QApplication>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+#include "ConfigManager.h"
+
+namespace
+{
+    constexpr quint32 ATLAS_MAGIC = 0x4143494C; // "LICA".
+    constexpr quint32 ATLAS_VERSION = 1;
+    constexpr int SMALL_ICON_SIZE = 24;
+    constexpr int LARGE_ICON_SIZE = 48;
+    constexpr qsizetype MAX_ENTRIES = 4096;
+
+    struct AtlasHeader
+    {
+        quint32 magic;
+        quint32 version;
+        quint32 entryCount;
+        quint32 reserved;
+        quint64 poolOffset; // The keys, in UTF-16.
+        quint64 poolLength; // In UTF-16 code units.
+        quint64 entriesOffset;
+    };
+
+    // The pixels are premultiplied ARGB32 rows without padding.
+    struct AtlasEntry
+    {
+        quint32 key, keyLength;
+        quint32 width, height;
+        qint64 modified;
+        quint64 pixelsOffset;
+    };
+} // namespace
+
+IconAtlas *IconAtlas::instance()
+{
+    // Owned by the application, so that it is saved and released before the GUI is torn down.
+    static auto *singleInstance = new IconAtlas(qApp);
+    return singleInstance;
+}
+
+IconAtlas::IconAtlas(QObject *parent) : QObject(parent)
+{
+    load();
+    connect(qApp, &QApplication::aboutToQuit, this, &IconAtlas::save);
+}
+
+/**
+ * Find a stored icon.
+ *
+ * Does not check the source: the caller should compare the returned
+ * modification time with the source, off the GUI thread.
+ *
+ * @param type The type of the icon.
+ * @param source The source of the icon, as used by IconCache.
+ * @param pixelSize The size of the icon in device pixels; only 24 and 48 are stored.
+ * @param modified Set to the modification time of the source when the icon was stored.
+ * @return The icon; a null image if it is not stored.
+ */
+QImage IconAtlas::find(const IconType type, const QString &source, const int pixelSize, qint64 &modified)
+{
+    if (!isStoredSize(pixelSize))
+        return {};
+
+    const auto iterator = m_entries.find(keyOf(type, source, pixelSize));
+    if (iterator == m_entries.end())
+    {
+        ++m_misses;
+        return {};
+    }
+
+    ++m_hits;
+    iterator->used = true;
+    modified = iterator->modified;
+    return iterator->image;
+}
+
+/**
+ * Store an icon, replacing the stored one if any.
+ *
+ * @param type The type of the icon.
+ * @param source The source of the icon, as used by IconCache.
+ * @param pixelSize The size of the icon in device pixels; only 24 and 48 are stored.
+ * @param modified The modification time of the source, as returned by modifiedTimeOf.
+ * @param image The icon.
+ */
+void IconAtlas::insert(const IconType type, const QString &source, const int pixelSize, const qint64 modified, const QImage &image)
+{
+    if (!isStoredSize(pixelSize) || image.isNull() || modified < 0)
+        return;
+
+    m_entries.insert(keyOf(type, source, pixelSize), {modified, image.convertToFormat(QImage::Format_ARGB32_Premultiplied), true});
+    m_modified = true;
+}
+
+/**
+ * Write the atlas if it changed. Called on quit.
+ *
+ * When the atlas is too large, the icons not used in this session are dropped.
+ */
+void IconAtlas::save()
+{
+    if (m_hits + m_misses > 0)
+        qInfo() << "Icon atlas:" << m_hits << "hits," << m_misses << "misses, hit rate" << 100 * m_hits / (m_hits + m_misses) << "%";
+    if (!m_modified)
+        return;
+
+    QVector<QString> keys;
+    keys.reserve(m_entries.size());
+    for (auto iterator = m_entries.cbegin(); iterator != m_entries.cend(); ++iterator)
+        if (m_entries.size() <= MAX_ENTRIES || iterator->used)
+            keys.append(iterator.key());
+    keys.resize(std::min(keys.size(), MAX_ENTRIES));
+
+    // Lay out the keys, the entries and the pixels, each aligned to 8 bytes.
+    QString pool;
+    QVector<AtlasEntry> entries;
+    entries.reserve(keys.size());
+    quint64 pixelsEnd = 0;
+    for (const QString &key : keys)
+    {
+        const Entry &entry = m_entries[key];
+        const auto width = static_cast<quint32>(entry.image.width());
+        const auto height = static_cast<quint32>(entry.image.height());
+        entries.append({static_cast<quint32>(pool.size()), static_cast<quint32>(key.size()), width, height, entry.modified, pixelsEnd});
+        pool.append(key);
+        pixelsEnd += (static_cast<quint64>(width) * height * 4 + 7) & ~quint64(7);
+    }
+
+    const auto align = [](const quint64 offset) { return (offset + 7) & ~quint64(7); };
+    AtlasHeader header = {};
+    header.magic = ATLAS_MAGIC;
+    header.version = ATLAS_VERSION;
+    header.entryCount = static_cast<quint32>(entries.size());
+    header.poolOffset = sizeof(header);
+    header.poolLength = pool.size();
+    header.entriesOffset = align(header.poolOffset + pool.size() * sizeof(QChar));
+    const quint64 pixelsOffset = align(header.entriesOffset + entries.size() * sizeof(AtlasEntry));
+    for (AtlasEntry &entry : entries)
+        entry.pixelsOffset += pixelsOffset;
+
+    QSaveFile file(ConfigManager::getConfigPath("IconAtlas.bin"));
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+    const auto pad = [&file](const quint64 offset) { file.write(QByteArray(static_cast<qsizetype>(offset - file.pos()), '\0')); };
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(pool.constData()), pool.size() * static_cast<qint64>(sizeof(QChar)));
+    pad(header.entriesOffset);
+    file.write(reinterpret_cast<const char *>(entries.constData()), entries.size() * static_cast<qint64>(sizeof(AtlasEntry)));
+    for (qsizetype entryIndex = 0; entryIndex < keys.size(); ++entryIndex)
+    {
+        pad(entries.at(entryIndex).pixelsOffset);
+        const QImage &image = m_entries[keys.at(entryIndex)].image;
+        for (int line = 0; line < image.height(); ++line)
+            file.write(reinterpret_cast<const char *>(image.constScanLine(line)), image.width() * 4);
+    }
+
+    // The file can only be replaced once it is no longer mapped.
+    m_entries.clear();
+    m_file.close();
+    if (!file.commit())
+        qWarning() << "Icon atlas: failed to save";
+    m_modified = false;
+    load();
+}
+
+/**
+ * Get the modification time of the source of an icon. May touch the disk.
+ *
+ * @param source The source of the icon, as used by IconCache.
+ * @return The modification time in ms since epoch; 0 for the icon of an extension, -1 if the file does not exist.
+ */
+qint64 IconAtlas::modifiedTimeOf(const QString &source)
+{
+    if (source.startsWith("*."))
+        return 0;
+    const QFileInfo fileInfo(source);
+    return fileInfo.exists() ? fileInfo.lastModified().toMSecsSinceEpoch() : -1;
+}
+
+/**
+ * Map the atlas file and index its entries, without copying any pixel.
+ */
+void IconAtlas::load()
+{
+    m_file.setFileName(ConfigManager::getConfigPath("IconAtlas.bin"));
+    if (!m_file.open(QIODevice::ReadOnly))
+        return;
+
+    const qint64 size = m_file.size();
+    const uchar *data = m_file.map(0, size);
+    AtlasHeader header;
+    if (!data || size < static_cast<qint64>(sizeof(header)))
+    {
+        m_file.close();
+        return;
+    }
+    std::memcpy(&header, data, sizeof(header));
+
+    const auto fits = [size](const quint64 offset, const quint64 bytes) { return offset <= static_cast<quint64>(size) && bytes <= static_cast<quint64>(size) - offset; };
+    if (header.magic != ATLAS_MAGIC || header.version != ATLAS_VERSION || header.poolOffset % alignof(QChar) != 0 ||
+        header.entriesOffset % alignof(AtlasEntry) != 0 || !fits(header.poolOffset, header.poolLength * sizeof(QChar)) ||
+        !fits(header.entriesOffset, header.entryCount * sizeof(AtlasEntry)))
+    {
+        m_file.close();
+        return;
+    }
+
+    const auto *pool = reinterpret_cast<const QChar *>(data + header.poolOffset);
+    const auto *entries = reinterpret_cast<const AtlasEntry *>(data + header.entriesOffset);
+    m_entries.reserve(header.entryCount);
+    for (quint32 entryIndex = 0; entryIndex < header.entryCount; ++entryIndex)
+    {
+        const AtlasEntry &entry = entries[entryIndex];
+        if (static_cast<quint64>(entry.key) + entry.keyLength > header.poolLength || entry.width > LARGE_ICON_SIZE || entry.height > LARGE_ICON_SIZE ||
+            entry.pixelsOffset % 4 != 0 || !fits(entry.pixelsOffset, static_cast<quint64>(entry.width) * entry.height * 4))
+            continue;
+        const QImage image(data + entry.pixelsOffset, static_cast<int>(entry.width), static_cast<int>(entry.height), static_cast<qsizetype>(entry.width) * 4,
+                           QImage::Format_ARGB32_Premultiplied);
+        m_entries.insert(QString::fromRawData(pool + entry.key, entry.keyLength), {entry.modified, image, false});
+    }
+}
+
+/**
+ * Get the key of an icon in the atlas.
+ *
+ * @param type The type of the icon.
+ * @param source The source of the icon.
+ * @param pixelSize The size of the icon in device pixels.
+ * @return The key.
+ */
+QString IconAtlas::keyOf(const IconType type, const QString &source, const int pixelSize)
+{
+    return QString("%1|%2|%3").arg(static_cast<int>(type)).arg(pixelSize).arg(source);
+}
+
+/**
+ * Check whether icons of a size are stored in the atlas.
+ *
+ * @param pixelSize The size of the icon in device pixels.
+ * @return True for the sizes of the icons at 100% and 200% scaling.
+ */
+bool IconAtlas::isStoredSize(const int pixelSize) { return pixelSize == SMALL_ICON_SIZE || pixelSize == LARGE_ICON_SIZE; }
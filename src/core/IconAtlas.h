@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include "../common/ResultItem.h"
+
+class IconAtlas final : public QObject
+{
+    Q_OBJECT
+
+public:
+    static IconAtlas *instance();
+
+    [[nodiscard]] QImage find(IconType type, const QString &source, int pixelSize, qint64 &modified);
+    void insert(IconType type, const QString &source, int pixelSize, qint64 modified, const QImage &image);
+    void save();
+
+    [[nodiscard]] static qint64 modifiedTimeOf(const QString &source);
+
+    IconAtlas(const IconAtlas &) = delete;
+    IconAtlas &operator=(const IconAtlas &) = delete;
+
+private:
+    /**
+     * @struct Entry
+     * @brief An icon of the atlas.
+     *
+     * Members:
+     *
+     * - modified: The modification time of the source when the icon was extracted, in ms since epoch.
+     * - image: The icon in premultiplied ARGB32; a view on the mapped file for stored icons.
+     * - used: Whether the icon was used in this session.
+     */
+    struct Entry
+    {
+        qint64 modified = 0;
+        QImage image;
+        bool used = false;
+    };
+
+    explicit IconAtlas(QObject *parent = nullptr);
+
+    void load();
+
+    [[nodiscard]] static QString keyOf(IconType type, const QString &source, int pixelSize);
+    [[nodiscard]] static bool isStoredSize(int pixelSize);
+
+    QFile m_file; // Declared first, as stored entries point into its mapping.
+    QHash<QString, Entry> m_entries;
+    qint64 m_hits = 0;
+    qint64 m_misses = 0;
+    bool m_modified = false;
+};
@@ -0,0 +1,181 @@
+#include "IconCache.h"
+#include <QApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <algorithm>
+#include <optional>
+#include <commoncontrols.h>
+#include <shellapi.h>
+#include <shlobj.h>
+#include <windows.h>
+#include "IconAtlas.h"
+
+namespace
+{
+    constexpr qsizetype CACHE_SIZE_BYTES = 16 * 1024 * 1024;
+    constexpr int LOADER_THREAD_COUNT = 2;
+} // namespace
+
+IconCache *IconCache::instance()
+{
+    // Owned by the application, so that the pixmaps are released before the GUI is torn down.
+    static auto *singleInstance = new IconCache(qApp);
+    return singleInstance;
+}
+
+IconCache::IconCache(QObject *parent) : QObject(parent)
+{
+    m_pixmaps.setMaxCost(CACHE_SIZE_BYTES);
+    m_threadPool.setMaxThreadCount(LOADER_THREAD_COUNT);
+}
+
+/**
+ * Get the icon of a file or an image from the cache.
+ *
+ * Never touches the disk. On a miss, an icon stored in the atlas is returned at
+ * once and checked against its source on a worker thread; other icons are
+ * loaded on a worker thread, and iconReady is emitted once they are in the cache.
+ *
+ * @param path The path to the file or the image.
+ * @param type Whether the icon is the thumbnail of the file or the image itself.
+ * @param size The size of the icon in device-independent pixels.
+ * @param devicePixelRatio The device pixel ratio of the target.
+ * @return The icon; a null pixmap if it is not loaded yet or cannot be loaded.
+ */
+QPixmap IconCache::icon(const QString &path, const IconType type, const int size, const qreal devicePixelRatio)
+{
+    const QString source = sourceOf(path, type);
+    const int pixelSize = qRound(size * devicePixelRatio);
+    const QString key = QString("%1|%2|%3|%4").arg(static_cast<int>(type)).arg(pixelSize).arg(devicePixelRatio).arg(source);
+
+    if (const QPixmap *pixmap = m_pixmaps.object(key))
+        return *pixmap;
+    if (m_pending.contains(key))
+        return {};
+
+    QPixmap pixmap;
+    std::optional<qint64> storedModified;
+    qint64 modified = 0;
+    if (const QImage stored = IconAtlas::instance()->find(type, source, pixelSize, modified); !stored.isNull())
+    {
+        pixmap = QPixmap::fromImage(stored);
+        pixmap.setDevicePixelRatio(devicePixelRatio);
+        m_pixmaps.insert(key, new QPixmap(pixmap), std::max<qsizetype>(1, stored.sizeInBytes()));
+        storedModified = modified;
+    }
+    if (!storedModified)
+        m_pending.insert(key);
+
+    const Request request = {key, source, type, pixelSize, devicePixelRatio};
+    m_threadPool.start(
+        [this, request, storedModified]
+        {
+            const qint64 sourceModified = IconAtlas::modifiedTimeOf(request.source);
+            if (storedModified == sourceModified)
+                return; // The stored icon is current.
+            const QImage image = loadIcon(request.source, request.type, request.pixelSize);
+            QMetaObject::invokeMethod(this, [this, request, sourceModified, image] { onIconLoaded(request, sourceModified, image); }, Qt::QueuedConnection);
+        });
+    return pixmap;
+}
+
+/**
+ * Store a loaded icon in the cache and the atlas. Called on the GUI thread.
+ *
+ * @param request The icon that was loaded.
+ * @param modified The modification time of the source, as returned by IconAtlas::modifiedTimeOf.
+ * @param image The icon; null if it could not be loaded.
+ */
+void IconCache::onIconLoaded(const Request &request, const qint64 modified, const QImage &image)
+{
+    m_pending.remove(request.key);
+    auto *pixmap = new QPixmap(QPixmap::fromImage(image));
+    pixmap->setDevicePixelRatio(request.devicePixelRatio);
+    m_pixmaps.insert(request.key, pixmap, std::max<qsizetype>(1, image.sizeInBytes()));
+    IconAtlas::instance()->insert(request.type, request.source, request.pixelSize, modified, image);
+    emit iconReady();
+}
+
+/**
+ * Get the source an icon is loaded from.
+ *
+ * Files whose icon only depends on their extension share one source, so that
+ * all documents of a type share one cache entry.
+ *
+ * @param path The path to the file or the image.
+ * @param type The type of the icon.
+ * @return The path to load the icon from, or "*.ext" for an icon shared by an extension.
+ */
+QString IconCache::sourceOf(const QString &path, const IconType type)
+{
+    if (type != IconType::Thumbnail)
+        return path;
+
+    // These files carry their own icon; anything without a suffix may be a directory, which can have its own icon too.
+    static const QSet<QString> ownIconSuffixes = {"exe", "lnk", "ico", "url", "cpl", "msc", "scr", "appref-ms"};
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix.isEmpty() || ownIconSuffixes.contains(suffix))
+        return path;
+    return "*." + suffix;
+}
+
+/**
+ * Load an icon. Called on a worker thread.
+ *
+ * @param source The source of the icon, see sourceOf.
+ * @param type The type of the icon.
+ * @param pixelSize The size of the icon in device pixels.
+ * @return The icon; a null image if it cannot be loaded.
+ */
+QImage IconCache::loadIcon(const QString &source, const IconType type, const int pixelSize)
+{
+    if (type == IconType::Thumbnail)
+        return loadShellIcon(source, pixelSize);
+
+    QImageReader reader(source);
+    if (const QSize imageSize = reader.size(); imageSize.isValid())
+        reader.setScaledSize(imageSize.scaled(pixelSize, pixelSize, Qt::KeepAspectRatio));
+    return reader.read();
+}
+
+/**
+ * Load the icon the shell shows for a file, from the system image list.
+ *
+ * @param source The path to the file, or "*.ext" to get the icon of an extension without touching the disk.
+ * @param pixelSize The size of the icon in device pixels.
+ * @return The icon; a null image if it cannot be loaded.
+ */
+QImage IconCache::loadShellIcon(const QString &source, const int pixelSize)
+{
+    // The shell functions require COM on the calling thread.
+    const HRESULT initResult = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE);
+
+    const bool isExtension = source.startsWith("*.");
+    const std::wstring name = QDir::toNativeSeparators(isExtension ? source.mid(1) : source).toStdWString();
+    SHFILEINFOW fileInfo = {};
+    QImage image;
+    if (SHGetFileInfoW(name.c_str(), isExtension ? FILE_ATTRIBUTE_NORMAL : 0, &fileInfo, sizeof(fileInfo),
+                       SHGFI_SYSICONINDEX | (isExtension ? SHGFI_USEFILEATTRIBUTES : 0)) != 0)
+    {
+        const int imageListType = pixelSize <= 16 ? SHIL_SMALL : pixelSize <= 32 ? SHIL_LARGE : pixelSize <= 48 ? SHIL_EXTRALARGE : SHIL_JUMBO;
+        IImageList *imageList = nullptr;
+        if (SUCCEEDED(SHGetImageList(imageListType, IID_IImageList, reinterpret_cast<void **>(&imageList))))
+        {
+            HICON iconHandle = nullptr;
+            if (SUCCEEDED(imageList->GetIcon(fileInfo.iIcon, ILD_TRANSPARENT, &iconHandle)) && iconHandle)
+            {
+                image = QImage::fromHICON(iconHandle);
+                DestroyIcon(iconHandle);
+            }
+            imageList->Release();
+        }
+    }
+
+    if (SUCCEEDED(initResult))
+        CoUninitialize();
+
+    if (!image.isNull() && image.width() != pixelSize)
+        image = image.scaled(pixelSize, pixelSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    return image;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QCache>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QSet>
+#include <QThreadPool>
+#include "../common/ResultItem.h"
+
+class IconCache final : public QObject
+{
+    Q_OBJECT
+
+public:
+    static IconCache *instance();
+
+    [[nodiscard]] QPixmap icon(const QString &path, IconType type, int size, qreal devicePixelRatio);
+
+    IconCache(const IconCache &) = delete;
+    IconCache &operator=(const IconCache &) = delete;
+
+signals:
+    void iconReady();
+
+private:
+    struct Request
+    {
+        QString key;
+        QString source;
+        IconType type;
+        int pixelSize;
+        qreal devicePixelRatio;
+    };
+
+    explicit IconCache(QObject *parent = nullptr);
+
+    void onIconLoaded(const Request &request, qint64 modified, const QImage &image);
+
+    [[nodiscard]] static QString sourceOf(const QString &path, IconType type);
+    [[nodiscard]] static QImage loadIcon(const QString &source, IconType type, int pixelSize);
+    [[nodiscard]] static QImage loadShellIcon(const QString &source, int pixelSize);
+
+    QCache<QString, QPixmap> m_pixmaps; // Least recently used pixmaps, with their size in bytes as cost; failed icons are cached as null pixmaps.
+    QSet<QString> m_pending;
+    QThreadPool m_threadPool; // Declared last, so that running loads finish before the rest is destroyed.
+};
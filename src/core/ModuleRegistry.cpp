@@ -0,0 +1,36 @@
+#include "ModuleRegistry.h"
+#include "../modules/AppsSearch.h"
+#include "../modules/Calculator.h"
+#include "../modules/EverythingSearch.h"
+#include "../modules/LauncherCommands.h"
+#include "../modules/SystemCommands.h"
+#include "../modules/UnitConverter.h"
+#include "../modules/WindowsTerminal.h"
+
+namespace
+{
+    template <typename Module>
+    IModule *create(QObject *parent)
+    {
+        return new Module(parent);
+    }
+} // namespace
+
+/**
+ * Get the factories of all modules, in the order their results are merged on ties.
+ *
+ * @return The factories.
+ */
+const QVector<ModuleFactory> &ModuleRegistry::factories()
+{
+    static const QVector<ModuleFactory> moduleFactories = {
+        {"Launcher Commands", true, true, 0.5, ':', &create<LauncherCommands>}, //
+        {"Everything Search", true, false, 0.0, '@', &create<EverythingSearch>}, //
+        {"Calculator", true, true, 1.0, '=', &create<Calculator>}, //
+        {"Apps Search", true, true, 0.8, ' ', &create<AppsSearch>}, //
+        {"System Commands", true, true, 1.0, ' ', &create<SystemCommands>}, //
+        {"Windows Terminal", true, true, 1.0, '>', &create<WindowsTerminal>}, //
+        {"Unit Converter", true, true, 1.0, ' ', &create<UnitConverter>} //
+    };
+    return moduleFactories;
+}
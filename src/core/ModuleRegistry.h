@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include <functional>
+
+class IModule;
+class QObject;
+
+/**
+ * @struct ModuleFactory
+ * @brief A module that can be enabled, with its default configuration.
+ *
+ * The name must match IModule::name, as it is the key of the module in the
+ * configuration, which is read before any module is constructed.
+ */
+struct ModuleFactory
+{
+    QString name;
+    bool enabled;
+    bool global;
+    double priority;
+    QChar prefix;
+    std::function<IModule *(QObject *parent)> create;
+};
+
+class ModuleRegistry final
+{
+public:
+    ModuleRegistry() = delete;
+
+    [[nodiscard]] static const QVector<ModuleFactory> &factories();
+};
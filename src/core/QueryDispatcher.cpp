@@ -0,0 +1,219 @@
+#include "QueryDispatcher.h"
+#include <utility>
+#include "../common/IModule.h"
+#include "StartupTrace.h"
+
+QueryDispatcher::QueryDispatcher(QObject *parent) : QObject(parent), m_generation(std::make_shared<std::atomic<quint64>>(0))
+{
+    qRegisterMetaType<QVector<ResultItem>>();
+}
+
+QueryDispatcher::~QueryDispatcher()
+{
+    // Cancel the running queries, stop the modules still initializing, and wait for them before the modules are destroyed.
+    m_generation->fetch_add(1);
+    for (auto iterator = m_lanes.cbegin(); iterator != m_lanes.cend(); ++iterator)
+        if (iterator->busy)
+            iterator.key()->stop();
+    m_threadPool.waitForDone();
+}
+
+/**
+ * Register a module to be queried by the dispatcher.
+ *
+ * The module is initialized on the thread pool as the first job of its lane;
+ * queries dispatched meanwhile wait as pending queries, without blocking.
+ *
+ * @param module A pointer to the module.
+ */
+void QueryDispatcher::addModule(IModule *module)
+{
+    m_lanes.insert(module, Lane{true});
+    connect(module, &IModule::resultsReady, this, &QueryDispatcher::onModuleResultsReady);
+    connect(module, &IModule::moreResultsAvailable, this, &QueryDispatcher::onModuleMoreResultsAvailable);
+
+    m_threadPool.start(
+        [this, module]
+        {
+            {
+                const StartupTrace::Scope scope("initialize " + module->name());
+                module->initialize();
+            }
+            QMetaObject::invokeMethod(
+                this,
+                [this, module]
+                {
+                    const bool isRetired = m_lanes.value(module).retired;
+                    freeLane(module);
+                    if (!isRetired)
+                        emit moduleReady(module);
+                },
+                Qt::QueuedConnection);
+        });
+}
+
+/**
+ * Unregister a module and delete it, once its running job is done. Its results
+ * are dropped from now on, and a running job is asked to stop.
+ *
+ * @param module A pointer to the module.
+ */
+void QueryDispatcher::retireModule(IModule *module)
+{
+    disconnect(module, &IModule::resultsReady, this, &QueryDispatcher::onModuleResultsReady);
+    disconnect(module, &IModule::moreResultsAvailable, this, &QueryDispatcher::onModuleMoreResultsAvailable);
+    if (const auto iterator = m_lanes.find(module); iterator != m_lanes.end() && iterator->busy)
+    {
+        iterator->retired = true;
+        iterator->hasPending = false;
+        module->stop();
+        return;
+    }
+    m_lanes.remove(module);
+    module->deleteLater();
+}
+
+/**
+ * Start a new query generation.
+ *
+ * All queries of the previous generation are cancelled; their results will not
+ * be forwarded anymore.
+ */
+void QueryDispatcher::startQuery() { m_generation->fetch_add(1); }
+
+/**
+ * Query a module on the thread pool within the current generation.
+ *
+ * Queries of the same module never run concurrently. If the module is still
+ * busy with a previous query, only the latest text is kept and run once the
+ * module is free.
+ *
+ * @param module A pointer to the module.
+ * @param text The search text.
+ * @param offset The number of results the module already provided for the text; if not 0, the next page is fetched.
+ */
+void QueryDispatcher::dispatch(IModule *module, const QString &text, const int offset)
+{
+    const auto iterator = m_lanes.find(module);
+    if (iterator == m_lanes.end() || iterator->retired)
+        return;
+
+    Lane &lane = iterator.value();
+    if (lane.busy)
+    {
+        lane.hasPending = true;
+        lane.pendingText = text;
+        lane.pendingOffset = offset;
+        lane.pendingGeneration = generation();
+        return;
+    }
+
+    runQuery(module, text, offset, generation());
+}
+
+/**
+ * Get the current query generation.
+ *
+ * @return The generation number.
+ */
+quint64 QueryDispatcher::generation() const { return m_generation->load(); }
+
+/**
+ * Forward the results of a module if they belong to the current generation.
+ *
+ * @param results The results of the module.
+ * @param module The module providing the results.
+ * @param generation The generation of the query that produced the results.
+ */
+void QueryDispatcher::onModuleResultsReady(const QVector<ResultItem> &results, IModule *module, const quint64 generation)
+{
+    if (generation != this->generation() || !m_lanes.contains(module) || m_lanes.value(module).retired)
+        return;
+
+    emit resultsReady(results, module);
+}
+
+/**
+ * Forward that a module has more results if they belong to the current generation.
+ *
+ * @param module The module providing the results.
+ * @param generation The generation of the query that has more results.
+ */
+void QueryDispatcher::onModuleMoreResultsAvailable(IModule *module, const quint64 generation)
+{
+    if (generation != this->generation() || !m_lanes.contains(module) || m_lanes.value(module).retired)
+        return;
+
+    emit moreResultsAvailable(module);
+}
+
+/**
+ * Run a module query on a worker thread.
+ *
+ * @param module A pointer to the module.
+ * @param text The search text.
+ * @param offset The number of results already provided; if not 0, the next page is fetched.
+ * @param generation The generation of the query.
+ */
+void QueryDispatcher::runQuery(IModule *module, const QString &text, const int offset, const quint64 generation)
+{
+    m_lanes[module].busy = true;
+
+    const QueryToken token(m_generation, generation);
+    m_threadPool.start(
+        [this, module, text, offset, token]
+        {
+            if (!token.isCancelled())
+            {
+                if (offset == 0)
+                    module->query(text, token);
+                else
+                    module->fetchMore(text, offset, token);
+            }
+
+            // Results emitted above are queued before this call, so they are delivered first.
+            QMetaObject::invokeMethod(this, [this, module, generation = token.generation()] { onQueryFinished(module, generation); }, Qt::QueuedConnection);
+        });
+}
+
+/**
+ * Report the end of a query if it is still current, then free the module.
+ *
+ * @param module A pointer to the module.
+ * @param generation The generation of the query that finished.
+ */
+void QueryDispatcher::onQueryFinished(IModule *module, const quint64 generation)
+{
+    if (generation == this->generation() && m_lanes.contains(module) && !m_lanes.value(module).retired)
+        emit queryFinished(module);
+    freeLane(module);
+}
+
+/**
+ * Free the module and run its pending query, if it is still current.
+ *
+ * @param module A pointer to the module.
+ */
+void QueryDispatcher::freeLane(IModule *module)
+{
+    const auto iterator = m_lanes.find(module);
+    if (iterator == m_lanes.end())
+        return;
+
+    Lane &lane = iterator.value();
+    if (lane.retired)
+    {
+        m_lanes.erase(iterator);
+        module->deleteLater();
+        return;
+    }
+    lane.busy = false;
+    if (!lane.hasPending)
+        return;
+
+    lane.hasPending = false;
+    if (lane.pendingGeneration == generation())
+        runQuery(module, std::exchange(lane.pendingText, QString()), lane.pendingOffset, lane.pendingGeneration);
+    else
+        lane.pendingText.clear();
+}
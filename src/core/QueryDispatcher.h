@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+#include "../common/ResultItem.h"
+
+class IModule;
+
+class QueryDispatcher final : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit QueryDispatcher(QObject *parent = nullptr);
+    ~QueryDispatcher() override;
+
+    void addModule(IModule *module);
+    void retireModule(IModule *module);
+
+    void startQuery();
+    void dispatch(IModule *module, const QString &text, int offset = 0);
+    [[nodiscard]] quint64 generation() const;
+
+signals:
+    void resultsReady(const QVector<ResultItem> &results, IModule *module);
+    void moreResultsAvailable(IModule *module);
+    void queryFinished(IModule *module); // Emitted after the last results of a query of the current generation.
+    void moduleReady(IModule *module); // Emitted once the module is initialized.
+
+private slots:
+    void onModuleResultsReady(const QVector<ResultItem> &results, IModule *module, quint64 generation);
+    void onModuleMoreResultsAvailable(IModule *module, quint64 generation);
+
+private:
+    struct Lane
+    {
+        bool busy = false; // Running a query, or initializing the module.
+        bool retired = false; // Deleted as soon as the running job is done.
+        bool hasPending = false;
+        QString pendingText;
+        int pendingOffset = 0;
+        quint64 pendingGeneration = 0;
+    };
+
+    void runQuery(IModule *module, const QString &text, int offset, quint64 generation);
+    void onQueryFinished(IModule *module, quint64 generation);
+    void freeLane(IModule *module);
+
+    QThreadPool m_threadPool;
+    std::shared_ptr<std::atomic<quint64>> m_generation;
+    QHash<IModule *, Lane> m_lanes;
+};
@@ -0,0 +1,133 @@
+#include "StartupTrace.h"
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+#include <QVector>
+#include <algorithm>
+#include <utility>
+#include "ConfigManager.h"
+
+namespace
+{
+    using Phase = StartupTrace::Phase;
+
+    QElapsedTimer clock;
+    QMutex mutex;
+    QVector<Phase> phases;
+    QVector<Phase> reportedPhases; // The phases of the report, sorted by start, and the total.
+    bool isStopped = false; // Whether finish has started; later phases are ignored.
+    thread_local int scopeDepth = 0;
+} // namespace
+
+StartupTrace::Scope::Scope(QString phase) : m_phase(std::move(phase)), m_start(elapsed()), m_depth(scopeDepth++) {}
+
+StartupTrace::Scope::~Scope() { end(); }
+
+/**
+ * End the phase before the scope is left, for phases around objects which must outlive them.
+ */
+void StartupTrace::Scope::end()
+{
+    if (m_isEnded)
+        return;
+    m_isEnded = true;
+    --scopeDepth;
+    record(m_phase, m_start, elapsed(), m_depth);
+}
+
+/**
+ * Start the startup clock. Called first thing in main; the phases timed before are dropped.
+ */
+void StartupTrace::start() { clock.start(); }
+
+/**
+ * Stop recording and write the startup report, once the launcher is ready and
+ * every module is initialized.
+ *
+ * The report lists the phases in the order they started, nested phases
+ * indented, with the phases run on worker threads marked as such. It is logged
+ * and written to StartupReport.txt in the configuration folder.
+ */
+void StartupTrace::finish()
+{
+    QVector<Phase> sortedPhases;
+    {
+        const QMutexLocker locker(&mutex);
+        if (isStopped || !clock.isValid())
+            return;
+        isStopped = true;
+        sortedPhases.swap(phases);
+    }
+    const qint64 total = elapsed();
+
+    std::stable_sort(sortedPhases.begin(), sortedPhases.end(), [](const Phase &left, const Phase &right) { return left.start < right.start; });
+    {
+        const QMutexLocker locker(&mutex);
+        reportedPhases = sortedPhases;
+        reportedPhases.append({"total", 0, total, 0, true});
+    }
+    const auto toMilliseconds = [](const qint64 nanoseconds) { return QString::number(nanoseconds / 1e6, 'f', 1).rightJustified(8); };
+    QString report = "Startup report\n    start     time  phase\n";
+    for (const Phase &phase : sortedPhases)
+        report += QString("%1 %2  %3%4%5\n")
+                      .arg(toMilliseconds(phase.start), toMilliseconds(phase.end - phase.start), QString(2 * phase.depth, ' '), phase.name,
+                           phase.isMainThread ? QString() : QString(" (worker)"));
+    report += QString("%1 ms until every module is initialized\n").arg(toMilliseconds(total).trimmed());
+
+    qInfo().noquote() << report;
+    QSaveFile file(ConfigManager::getConfigPath("StartupReport.txt"));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return;
+    file.write(report.toUtf8());
+    if (!file.commit())
+        qWarning() << "Startup report: failed to save";
+}
+
+/**
+ * Check whether the phases of the startup report are available.
+ *
+ * @return True once finish has run.
+ */
+bool StartupTrace::isFinished()
+{
+    const QMutexLocker locker(&mutex);
+    return !reportedPhases.isEmpty();
+}
+
+/**
+ * Get the phases of the startup report, for tools which measure many startups.
+ *
+ * @return The phases sorted by start, followed by a "total" phase which ends when every module is initialized; empty until finish has run.
+ */
+QVector<StartupTrace::Phase> StartupTrace::finishedPhases()
+{
+    const QMutexLocker locker(&mutex);
+    return reportedPhases;
+}
+
+/**
+ * Get the time since the startup clock was started.
+ *
+ * @return The time in ns; -1 if the clock is not started.
+ */
+qint64 StartupTrace::elapsed() { return clock.isValid() ? clock.nsecsElapsed() : -1; }
+
+/**
+ * Record a timed phase. Thread-safe; ignored once the report is written.
+ *
+ * @param phase The name of the phase.
+ * @param start The start of the phase, as returned by elapsed.
+ * @param end The end of the phase, as returned by elapsed.
+ * @param depth The number of phases the phase is nested in, on its thread.
+ */
+void StartupTrace::record(const QString &phase, const qint64 start, const qint64 end, const int depth)
+{
+    if (start < 0)
+        return;
+    const bool isMainThread = QThread::currentThread() == qApp->thread();
+    const QMutexLocker locker(&mutex);
+    if (!isStopped)
+        phases.append({phase, start, end, depth, isMainThread});
+}
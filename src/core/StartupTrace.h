@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+class StartupTrace final
+{
+public:
+    StartupTrace() = delete;
+
+    // A timed phase; the times are in ns since StartupTrace::start.
+    struct Phase
+    {
+        QString name;
+        qint64 start, end;
+        int depth;
+        bool isMainThread;
+    };
+
+    // Times a startup phase from its construction to its destruction.
+    class Scope final
+    {
+    public:
+        explicit Scope(QString phase);
+        ~Scope();
+
+        void end();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        QString m_phase;
+        qint64 m_start;
+        int m_depth;
+        bool m_isEnded = false;
+    };
+
+    static void start();
+    static void finish();
+
+    [[nodiscard]] static bool isFinished();
+    [[nodiscard]] static QVector<Phase> finishedPhases();
+
+private:
+    [[nodiscard]] static qint64 elapsed();
+    static void record(const QString &phase, qint64 start, qint64 end, int depth);
+};
@@ -32,8 +32,16 @@ void ThemeManager::initTheme()
     m_defaultTextDark = darkObject["text"].toObject()["default"].toString();
     m_accentTextLight = lightObject["text"].toObject()["accent"].toString();
     m_accentTextDark = darkObject["text"].toObject()["accent"].toString();
+    ++m_generation;
 }
 
+/**
+ * Get the generation of the theme, which changes every time the theme is loaded.
+ *
+ * @return The generation, to invalidate anything rendered with the previous colors.
+ */
+quint64 ThemeManager::generation() { return m_generation; }
+
 QJsonDocument ThemeManager::defaultConfig()
 {
     // clang-format off
@@ -8,6 +8,7 @@ public:
     ThemeManager() = delete;
 
     static void initTheme();
+    static quint64 generation();
 
     static QJsonDocument defaultConfig();
 
@@ -25,6 +26,7 @@ public:
 
 private:
     static inline bool m_isDarkMode;
+    static inline quint64 m_generation = 0;
 
     static inline QString m_defaultBackLight, m_defaultBackDark;
     static inline QString m_activeBackLight, m_activeBackDark;
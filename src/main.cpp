@@ -2,25 +2,37 @@
 #include <QFontDatabase>
 #include <QMessageBox>
 #include "app/Launcher.h"
+#include "core/StartupTrace.h"
 #include "utils/DialogUtils.h"
 
 int main(int argc, char *argv[])
 {
+    StartupTrace::start();
+    StartupTrace::Scope applicationScope("application");
     QApplication app(argc, argv);
+    applicationScope.end();
 
     // Set application information.
     QCoreApplication::setApplicationName("Launcher");
 
     // Load Font Awesome icon font.
-    QFontDatabase::addApplicationFont(":/fonts/MaterialSymbolsRounded-Regular.ttf");
+    {
+        const StartupTrace::Scope scope("fonts");
+        QFontDatabase::addApplicationFont(":/fonts/MaterialSymbolsRounded-Regular.ttf");
+    }
 
-    // Create main window.
+    // Create main window. The modules keep initializing in the background; the startup report is written once they are done.
+    StartupTrace::Scope windowScope("window");
     Launcher launcher;
+    windowScope.end();
 
-    if (!launcher.registerHotkey())
     {
-        DialogUtils::showError("Failed to register hotkey. ");
-        return 1;
+        const StartupTrace::Scope scope("hotkey");
+        if (!launcher.registerHotkey())
+        {
+            DialogUtils::showError("Failed to register hotkey. ");
+            return 1;
+        }
     }
 
     return QApplication::exec();
@@ -1,29 +1,162 @@
 #include "AppsSearch.h"
+#include <QDir>
+#include <QCryptographicHash>
 #include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
 #include <QJsonArray>
+#include <QRegularExpression>
+#include <QSaveFile>
 #include <QStandardPaths>
-#include <shlobj.h>
-#include <windows.h>
+#include <algorithm>
+#include <cstring>
 #include "../core/ConfigManager.h"
 #include "../utils/ProcessUtils.h"
+#include "../utils/ShellLinkParser.h"
+
+namespace
+{
+    // Changes are applied once the Start Menu has been quiet for this long, as installers touch many files at once.
+    constexpr int RESCAN_DELAY_MS = 500;
+
+    // The rest of the catalog is scanned for subsequence matches when the index finds fewer candidates than this.
+    constexpr qsizetype SUBSEQUENCE_SCAN_THRESHOLD = 100;
+    constexpr quint32 CANCELLATION_CHECK_INTERVAL = 1024;
+
+    // The snapshot is a binary image of the catalog and its index, mapped at startup instead of parsing the JSON.
+    constexpr quint32 SNAPSHOT_MAGIC = 0x5441434C; // "LCAT".
+    constexpr quint32 SNAPSHOT_VERSION = 2;
+
+    struct SnapshotHeader
+    {
+        quint32 magic;
+        quint32 version;
+        qint64 sourceModified; // The modification time of the JSON, in ms since epoch.
+        qint64 sourceSize;
+        char sourceHash[32]; // The SHA-256 of the JSON.
+        quint32 appCount;
+        quint32 textCount;
+        quint64 poolOffset; // The strings, in UTF-16.
+        quint64 poolLength; // In UTF-16 code units.
+        quint64 appsOffset;
+        quint64 textsOffset;
+        quint64 bonusesOffset;
+        quint64 bonusesSize;
+        quint64 indexOffset; // The frozen TrigramIndex.
+        quint64 indexSize;
+    };
+
+    // Strings are stored as an offset and a length in the pool.
+    struct SnapshotApp
+    {
+        quint32 name, nameLength;
+        quint32 path, pathLength;
+        quint32 iconPath, iconPathLength;
+        quint32 shortcut, shortcutLength;
+        quint32 otherShortcuts, otherShortcutsLength;
+        quint32 firstText, textCount;
+        quint32 removed;
+    };
+
+    // The lowercased text has the same length as the text, and so do its bonuses.
+    struct SnapshotText
+    {
+        quint32 text, length;
+        quint32 lower;
+        quint32 bonuses;
+        quint64 charMask;
+    };
+
+    // Copy a string that may point into the snapshot, so that results do not depend on the mapping.
+    QString ownedCopy(const QString &text) { return QString(text.constData(), text.size()); }
+} // namespace
 
 AppsSearch::AppsSearch(QObject *parent) : IModule(parent)
 {
-    const QJsonDocument doc = ConfigManager::loadConfig(this);
-    const QJsonObject rootObject = doc.object();
-    const QJsonArray appsArray = rootObject["apps"].toArray();
-    for (const QJsonValue app : appsArray)
+    // The payload of a result is the path of the app.
+    Action openAction;
+    openAction.description = "Open";
+    openAction.handler = [](const ResultItem &item) { ProcessUtils::startDetached(item.payload.toString()); };
+    Action openAdminAction;
+    openAdminAction.description = "Open as admin";
+    openAdminAction.iconGlyph = QChar(0xe9e0); // Shield.
+    openAdminAction.handler = [](const ResultItem &item) { ProcessUtils::startDetached(item.payload.toString(), QStringList(), true); };
+    openAdminAction.shortcut = QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_Return);
+    m_appActions = {openAction, openAdminAction};
+
+    m_rescanTimer.setSingleShot(true);
+    m_rescanTimer.setInterval(RESCAN_DELAY_MS);
+    connect(&m_rescanTimer, &QTimer::timeout, this, &AppsSearch::applyDirectoryChanges);
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &AppsSearch::onDirectoryChanged);
+}
+
+/**
+ * Load the catalog and apply the changes of the Start Menu since the last run, then start watching it on the GUI thread.
+ */
+void AppsSearch::initialize()
+{
+    // Map the snapshot if it is current, otherwise load the JSON and write a new snapshot.
+    const QString configPath = ConfigManager::getModuleConfigPath(this);
+    QElapsedTimer timer;
+    timer.start();
+    const bool isMapped = QFileInfo::exists(configPath) && loadSnapshot(configPath);
+    if (isMapped)
+    {
+        qInfo() << "Apps Search: mapped" << m_apps.size() << "apps from the snapshot in" << timer.elapsed() << "ms," << m_snapshotFile.size() / 1024
+                << "KB mapped," << m_index.frozenSize() / std::max<qsizetype>(m_apps.size(), 1) << "bytes of mapped index and"
+                << m_index.memoryUsage() / std::max<qsizetype>(m_apps.size(), 1) << "bytes of index on the heap per app";
+    }
+    else
     {
-        const QJsonObject appObject = app.toObject();
-        const QString name = appObject["name"].toString();
-        const QString path = appObject["path"].toString();
-        const QString iconPath = appObject["icon"].toString();
-        const QJsonArray keywordsArray = appObject["keywords"].toArray();
-        QVector<QString> keywords;
-        for (const QJsonValue keyword : keywordsArray)
-            keywords.append(keyword.toString());
-        m_apps.append({name, path, iconPath, keywords});
+        const QJsonDocument doc = ConfigManager::loadConfig(this);
+        const QJsonObject rootObject = doc.object();
+        const QJsonArray appsArray = rootObject["apps"].toArray();
+        for (const QJsonValue app : appsArray)
+        {
+            const QJsonObject appObject = app.toObject();
+            const QJsonArray keywordsArray = appObject["keywords"].toArray();
+            QVector<QString> keywords;
+            for (const QJsonValue keyword : keywordsArray)
+                keywords.append(keyword.toString());
+            QStringList otherShortcuts;
+            for (const QJsonValue shortcut : appObject["otherShortcuts"].toArray())
+                otherShortcuts.append(shortcut.toString());
+            addApp(appObject["name"].toString(), appObject["path"].toString(), appObject["icon"].toString(), keywords, appObject["shortcut"].toString(),
+                   otherShortcuts.join('\n'));
+        }
+        if (!m_apps.isEmpty())
+            qInfo() << "Apps Search: loaded and indexed" << m_apps.size() << "apps from JSON in" << timer.elapsed() << "ms,"
+                    << m_index.memoryUsage() / m_apps.size() << "bytes of index per app";
     }
+
+    // Every directory is listed to find the shortcuts changed since the last run, so this is done here rather than on the GUI thread.
+    timer.restart();
+    QStringList directories;
+    for (const QString &root : startMenuPaths())
+        directories.append(directoryTreeOf(root));
+    buildLookups();
+    QSet<QString> known(directories.cbegin(), directories.cend());
+    if (const int changes = syncDirectories(directories, known); changes > 0)
+    {
+        saveCatalog();
+        qInfo() << "Apps Search: applied" << changes << "catalog changes since the last run in" << timer.elapsed() << "ms";
+    }
+    if (!isMapped && !saveSnapshot(configPath)) // After the catalog is saved, as the snapshot must match it.
+        qWarning() << "Apps Search: failed to save the catalog snapshot";
+
+    // The watcher and the timer belong to the GUI thread.
+    QMetaObject::invokeMethod(this, [this, directories = QStringList(known.cbegin(), known.cend())] { watchStartMenu(directories); }, Qt::QueuedConnection);
+}
+
+/**
+ * Watch the directories of the Start Menu.
+ *
+ * @param directories The cleaned paths of all the directories.
+ */
+void AppsSearch::watchStartMenu(const QStringList &directories)
+{
+    if (!directories.isEmpty())
+        m_watcher.addPaths(directories);
 }
 
 QJsonDocument AppsSearch::defaultConfig() const
@@ -31,153 +164,684 @@ QJsonDocument AppsSearch::defaultConfig() const
     QJsonObject rootObject;
     QJsonArray appsArray;
 
-    const QVector<QString> startMenuPaths = {QStandardPaths::writableLocation(QStandardPaths::ApplicationsLocation), // User start menu.
-                                             R"(C:\ProgramData\Microsoft\Windows\Start Menu\Programs)"}; // System start menu.
-    for (const QString &path : startMenuPaths)
+    // The first shortcut to a target names the app; the others are kept to take over if it is removed.
+    QVector<QJsonObject> appObjects;
+    QHash<QString, qsizetype> appIndexes;
+    for (const ShellLinkParser::ShellLink &link : ShellLinkParser::scanDirectories(startMenuPaths()))
     {
-        QDirIterator it(path, QStringList() << "*.lnk", QDir::Files, QDirIterator::Subdirectories);
-        while (it.hasNext())
+        if (QFileInfo(link.targetPath).suffix().toLower() != "exe")
+            continue;
+        if (const auto iterator = appIndexes.constFind(link.targetPath.toLower()); iterator != appIndexes.constEnd())
         {
-            const QString &shortcutPath = it.next();
-            QString targetPath;
-            if (!getShortcutPath(shortcutPath, targetPath))
-                continue;
-
-            if (QFileInfo(targetPath).suffix().toLower() == "exe")
-            {
-                QJsonObject appObject;
-                appObject["name"] = QFileInfo(shortcutPath).completeBaseName();
-                appObject["path"] = targetPath;
-                QJsonArray keywordsArray;
-                static QRegularExpression regex("[^A-Za-z0-9]"); // Remove all non-alphanumeric characters.
-                keywordsArray.append(QFileInfo(shortcutPath).completeBaseName().remove(regex).toLower());
-                appObject["keywords"] = keywordsArray;
-                appsArray.append(appObject);
-            }
+            QJsonObject &appObject = appObjects[iterator.value()];
+            QJsonArray otherShortcuts = appObject["otherShortcuts"].toArray();
+            otherShortcuts.append(QDir::cleanPath(link.shortcutPath));
+            appObject["otherShortcuts"] = otherShortcuts;
+            continue;
         }
+        appIndexes.insert(link.targetPath.toLower(), appObjects.size());
+
+        const QString name = QFileInfo(link.shortcutPath).completeBaseName();
+        QJsonObject appObject;
+        appObject["name"] = name;
+        appObject["path"] = link.targetPath;
+        appObject["keywords"] = QJsonArray{keywordOf(name)};
+        appObject["shortcut"] = QDir::cleanPath(link.shortcutPath);
+        appObjects.append(appObject);
     }
+    for (const QJsonObject &appObject : appObjects)
+        appsArray.append(appObject);
     rootObject["apps"] = appsArray;
     return QJsonDocument(rootObject);
 }
 
-void AppsSearch::query(const QString &text)
+const QVector<Action> &AppsSearch::actions(const ResultItem &item) const
+{
+    Q_UNUSED(item)
+    return m_appActions;
+}
+
+void AppsSearch::query(const QString &text, const QueryToken &token)
 {
     QVector<ResultItem> results;
+    const FuzzyMatcher matcher(text);
+    const QReadLocker locker(&m_lock);
 
-    for (const AppInfo &app : m_apps)
+    const auto addIfMatches = [&](const quint32 id)
     {
+        const AppInfo &app = m_apps.at(id);
+
         double score = 0.0;
-        for (const QString &keyword : app.keywords)
-        {
-            if (keyword.contains(text, Qt::CaseInsensitive))
-            {
-                score = 1.0;
-                if (keyword.startsWith(text, Qt::CaseInsensitive))
-                {
-                    score = 2.0;
-                    break;
-                }
-            }
-        }
+        for (qsizetype textIndex = app.firstText; textIndex < app.firstText + app.textCount; ++textIndex)
+            score = std::max(score, matcher.match(m_targets.at(textIndex)));
 
         if (score > 0.0)
         {
+            const QString path = ownedCopy(app.path);
             ResultItem item;
-            item.title = app.name;
-            item.subtitle = app.path;
-            item.iconPath = (app.iconPath.isEmpty()) ? app.path : app.iconPath;
+            item.title = ownedCopy(app.name);
+            item.subtitle = path;
+            item.iconPath = (app.iconPath.isEmpty()) ? path : ownedCopy(app.iconPath);
             item.iconType = (app.iconPath.isEmpty()) ? IconType::Thumbnail : IconType::Image;
-            Action openAction;
-            openAction.description = "Open";
-            openAction.handler = [app] { ProcessUtils::startDetached(app.path); };
-            Action openAdminAction;
-            openAdminAction.description = "Open as admin";
-            openAdminAction.iconGlyph = QChar(0xe9e0); // Shield.
-            openAdminAction.handler = [app] { ProcessUtils::startDetached(app.path, QStringList(), true); };
-            openAdminAction.shortcut = QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_Return);
-            item.actions = {openAction, openAdminAction};
-            item.key = "app_" + app.path;
+            item.key = "app_" + path;
+            item.payload = path;
             item.score = score;
             results.append(item);
         }
+    };
+
+    // The candidates from the index contain the query, or its word initials.
+    const QVector<quint32> candidates = m_index.candidates(text);
+    for (const quint32 id : candidates)
+    {
+        if (token.isCancelled())
+            return;
+        addIfMatches(id);
     }
 
-    emit resultsReady(results, this);
+    // Other subsequence matches, such as "chrm" for "Chrome", are found by scanning the rest of the catalog, where the
+    // character masks reject most apps without scoring them. Once the index fills the list, they would rank below anyway.
+    if (candidates.size() < SUBSEQUENCE_SCAN_THRESHOLD)
+    {
+        for (quint32 id = 0; id < static_cast<quint32>(m_apps.size()); ++id)
+        {
+            if (id % CANCELLATION_CHECK_INTERVAL == 0 && token.isCancelled())
+                return;
+            if (!m_apps.at(id).removed && !std::binary_search(candidates.cbegin(), candidates.cend(), id))
+                addIfMatches(id);
+        }
+    }
+
+    emit resultsReady(results, this, token.generation());
 }
 
 /**
- * Resolve a Windows shortcut and retrieve the path to its target file.
+ * Add an app to the catalog and the search index.
  *
- * @param shortcutPath The file path to the shortcut (.lnk) being resolved.
- * @param targetPath Reference to a QString that will hold the resolved target
- * path of the shortcut if successful.
- * @return Return true if the shortcut was successfully resolved and the target
- * path was retrieved; false otherwise.
+ * @param name The display name of the app.
+ * @param path The path to the executable.
+ * @param iconPath The path to a custom icon; empty to use the icon of the executable.
+ * @param keywords The keywords of the app.
+ * @param shortcut The Start Menu shortcut the app comes from; empty if the app was added by hand.
+ * @param otherShortcuts The other shortcuts to the same path, separated by newlines.
  */
-bool AppsSearch::getShortcutPath(const QString &shortcutPath, QString &targetPath)
+void AppsSearch::addApp(const QString &name, const QString &path, const QString &iconPath, const QVector<QString> &keywords, const QString &shortcut,
+                        const QString &otherShortcuts)
 {
-    HRESULT hr;
-    IShellLinkW *pShellLink;
-    IPersistFile *pPersistFile;
+    QVector<QString> texts = {name};
+    texts.append(keywords);
 
-    // Initialize COM.
-    hr = CoInitialize(nullptr);
-    if (FAILED(hr))
-    {
+    QVector<FuzzyMatcher::Target> targets;
+    targets.reserve(texts.size());
+    for (const QString &text : texts)
+        targets.append(FuzzyMatcher::prepare(text));
+
+    const QWriteLocker locker(&m_lock);
+    const auto id = static_cast<quint32>(m_apps.size());
+    m_apps.append({name, path, iconPath, shortcut, otherShortcuts, m_texts.size(), texts.size()});
+    m_texts.append(texts);
+    m_targets.append(targets);
+    m_index.insert(id, texts);
+    if (m_lookupsBuilt)
+        registerShortcuts(m_apps.constLast(), id);
+}
+
+/**
+ * Remove an app from the catalog and the search index.
+ *
+ * @param id The id of the app.
+ */
+void AppsSearch::removeApp(const quint32 id)
+{
+    const QWriteLocker locker(&m_lock);
+    AppInfo &app = m_apps[id];
+    m_index.remove(id, m_texts.mid(app.firstText, app.textCount));
+    app.removed = true;
+
+    unregisterShortcuts(app);
+    if (const auto iterator = m_pathIds.constFind(app.path.toLower()); iterator != m_pathIds.constEnd() && iterator.value() == id)
+        m_pathIds.erase(iterator);
+}
+
+/**
+ * Add the app a Start Menu shortcut points to.
+ *
+ * If the app is already in the catalog, the shortcut is kept with it, to take over if the shortcut of the app is removed.
+ *
+ * @param shortcutPath The cleaned path to the shortcut.
+ * @return True if the catalog changed; false if the shortcut is not an app.
+ */
+bool AppsSearch::addShortcut(const QString &shortcutPath)
+{
+    ShellLinkParser::ShellLink link;
+    if (!ShellLinkParser::parse(shortcutPath, link) || QFileInfo(link.targetPath).suffix().toLower() != "exe")
         return false;
+
+    if (const auto iterator = m_pathIds.constFind(link.targetPath.toLower()); iterator != m_pathIds.constEnd())
+    {
+        const quint32 id = iterator.value();
+        m_directoryShortcuts[directoryKeyOf(shortcutPath)].insert(shortcutPath, id);
+        const QWriteLocker locker(&m_lock);
+        QString &otherShortcuts = m_apps[id].otherShortcuts;
+        otherShortcuts = otherShortcuts.isEmpty() ? shortcutPath : otherShortcuts + '\n' + shortcutPath;
+        return true;
     }
 
-    // Create an IShellLink object.
-    hr = CoCreateInstance(CLSID_ShellLink, nullptr, CLSCTX_INPROC_SERVER, IID_IShellLinkW, reinterpret_cast<void **>(&pShellLink));
-    if (FAILED(hr))
+    const QString name = QFileInfo(shortcutPath).completeBaseName();
+    addApp(name, link.targetPath, {}, {keywordOf(name)}, shortcutPath);
+    return true;
+}
+
+/**
+ * Remove a shortcut from the catalog.
+ *
+ * The app of the shortcut is removed, unless another shortcut to the same
+ * target still exists; the app is then added back under that shortcut.
+ *
+ * @param shortcutPath The cleaned path to the shortcut.
+ */
+void AppsSearch::removeShortcut(const QString &shortcutPath)
+{
+    const auto directory = m_directoryShortcuts.find(directoryKeyOf(shortcutPath));
+    if (directory == m_directoryShortcuts.end() || !directory->contains(shortcutPath))
+        return; // Already removed with its app.
+    const quint32 id = directory->value(shortcutPath);
+
+    const AppInfo &app = m_apps.at(id);
+    QStringList otherShortcuts = app.otherShortcuts.isEmpty() ? QStringList() : app.otherShortcuts.split('\n');
+    if (app.shortcut != shortcutPath)
     {
-        CoUninitialize();
-        return false;
+        directory->remove(shortcutPath);
+        if (directory->isEmpty())
+            m_directoryShortcuts.erase(directory);
+        otherShortcuts.removeOne(shortcutPath);
+        const QWriteLocker locker(&m_lock);
+        m_apps[id].otherShortcuts = otherShortcuts.join('\n');
+        return;
     }
 
-    // Query for IPersistFile.
-    hr = pShellLink->QueryInterface(IID_IPersistFile, reinterpret_cast<void **>(&pPersistFile));
-    if (FAILED(hr))
+    const QString path = ownedCopy(app.path);
+    removeApp(id);
+    while (!otherShortcuts.isEmpty())
     {
-        pShellLink->Release();
-        CoUninitialize();
-        return false;
+        const QString shortcut = otherShortcuts.takeFirst();
+        if (QFileInfo::exists(shortcut))
+        {
+            const QString name = QFileInfo(shortcut).completeBaseName();
+            addApp(name, path, {}, {keywordOf(name)}, shortcut, otherShortcuts.join('\n'));
+            return;
+        }
     }
+}
 
-    // Load the shortcut file.
-    hr = pPersistFile->Load(shortcutPath.toStdWString().c_str(), STGM_READ);
-    if (FAILED(hr))
+/**
+ * Add the shortcuts and the path of an app to the lookups.
+ *
+ * @param app The app.
+ * @param id The id of the app.
+ */
+void AppsSearch::registerShortcuts(const AppInfo &app, const quint32 id)
+{
+    if (!app.shortcut.isEmpty())
+        m_directoryShortcuts[directoryKeyOf(app.shortcut)].insert(app.shortcut, id);
+    if (!app.otherShortcuts.isEmpty())
+        for (const QString &shortcut : app.otherShortcuts.split('\n'))
+            m_directoryShortcuts[directoryKeyOf(shortcut)].insert(shortcut, id);
+    if (!m_pathIds.contains(app.path.toLower()))
+        m_pathIds.insert(app.path.toLower(), id);
+}
+
+/**
+ * Remove the shortcuts of an app from the lookups.
+ *
+ * @param app The app.
+ */
+void AppsSearch::unregisterShortcuts(const AppInfo &app)
+{
+    QStringList shortcuts = app.otherShortcuts.isEmpty() ? QStringList() : app.otherShortcuts.split('\n');
+    if (!app.shortcut.isEmpty())
+        shortcuts.append(app.shortcut);
+    for (const QString &shortcut : shortcuts)
     {
-        pPersistFile->Release();
-        pShellLink->Release();
-        CoUninitialize();
-        return false;
+        if (const auto directory = m_directoryShortcuts.find(directoryKeyOf(shortcut)); directory != m_directoryShortcuts.end())
+        {
+            directory->remove(shortcut);
+            if (directory->isEmpty())
+                m_directoryShortcuts.erase(directory);
+        }
+    }
+}
+
+/**
+ * Queue a directory of the Start Menu for a rescan.
+ *
+ * @param directory The directory that changed.
+ */
+void AppsSearch::onDirectoryChanged(const QString &directory)
+{
+    m_changedDirectories.insert(QDir::cleanPath(directory));
+    m_rescanTimer.start(); // Restart the delay.
+}
+
+/**
+ * Apply the changes of the queued directories to the catalog, watch the new directories, and save the catalog if it changed.
+ */
+void AppsSearch::applyDirectoryChanges()
+{
+    QElapsedTimer timer;
+    timer.start();
+    QStringList directories(m_changedDirectories.cbegin(), m_changedDirectories.cend());
+    m_changedDirectories.clear();
+    std::sort(directories.begin(), directories.end());
+
+    const QStringList watchedDirectories = m_watcher.directories();
+    const QSet<QString> watched(watchedDirectories.cbegin(), watchedDirectories.cend());
+    QSet<QString> known = watched;
+    const int changes = syncDirectories(directories, known);
+    if (const QSet<QString> created = known - watched; !created.isEmpty())
+        m_watcher.addPaths(QStringList(created.cbegin(), created.cend()));
+
+    if (changes == 0)
+        return;
+    saveCatalog();
+    qInfo() << "Apps Search: applied" << changes << "catalog changes in" << timer.elapsed() << "ms";
+}
+
+/**
+ * Apply the changes of directories of the Start Menu to the catalog.
+ *
+ * All removals are applied before any addition, so that a shortcut moved or
+ * renamed to another directory is not mistaken for a duplicate of itself.
+ *
+ * @param directories The cleaned paths of the changed directories.
+ * @param known The directories already known; the new subdirectories are added to it.
+ * @return The number of catalog changes.
+ */
+int AppsSearch::syncDirectories(const QStringList &directories, QSet<QString> &known)
+{
+    int changes = 0;
+    for (const QString &directory : directories)
+        changes += removeMissingShortcuts(directory);
+    for (const QString &directory : directories)
+        changes += addNewShortcuts(directory, known);
+    return changes;
+}
+
+/**
+ * Remove the shortcuts which no longer exist under a directory.
+ *
+ * Only the shortcuts of the directory and of its subdirectories are visited, as the lookup is sorted by directory.
+ *
+ * @param directory The cleaned path to the directory; it may have been removed.
+ * @return The number of shortcuts removed.
+ */
+int AppsSearch::removeMissingShortcuts(const QString &directory)
+{
+    QStringList missing;
+    const QString key = directory.toLower();
+
+    // Shortcuts directly in the directory must be listed.
+    if (const auto known = m_directoryShortcuts.constFind(key); known != m_directoryShortcuts.cend())
+    {
+        QSet<QString> shortcuts;
+        for (const QFileInfo &fileInfo : QDir(directory).entryInfoList({"*.lnk"}, QDir::Files))
+            shortcuts.insert(QDir::cleanPath(fileInfo.absoluteFilePath()));
+        for (auto iterator = known->cbegin(); iterator != known->cend(); ++iterator)
+            if (!shortcuts.contains(iterator.key()))
+                missing.append(iterator.key());
     }
 
-    // Resolve the shortcut.
-    hr = pShellLink->Resolve(nullptr, SLR_NO_UI | SLR_NOUPDATE | SLR_NOSEARCH | SLR_NOTRACK);
-    if (FAILED(hr))
+    // Deeper ones are gone with their parent directory.
+    const QString prefix = key + '/';
+    for (auto known = m_directoryShortcuts.lowerBound(prefix); known != m_directoryShortcuts.cend() && known.key().startsWith(prefix); ++known)
     {
-        pPersistFile->Release();
-        pShellLink->Release();
-        CoUninitialize();
-        return false;
+        const QString &shortcut = known->cbegin().key(); // Directories without shortcuts are not kept.
+        if (!QFileInfo(shortcut.left(shortcut.lastIndexOf('/'))).isDir())
+            missing.append(known->keys());
+    }
+
+    for (const QString &shortcut : missing)
+        removeShortcut(shortcut);
+    return static_cast<int>(missing.size());
+}
+
+/**
+ * Add the apps of the new shortcuts in a directory, and of all the shortcuts in its new subdirectories.
+ *
+ * @param directory The cleaned path to the directory; it may have been removed.
+ * @param known The directories already known; the new subdirectories are added to it.
+ * @return The number of catalog changes.
+ */
+int AppsSearch::addNewShortcuts(const QString &directory, QSet<QString> &known)
+{
+    const QDir dir(directory);
+    const QHash<QString, quint32> shortcuts = m_directoryShortcuts.value(directory.toLower());
+    int added = 0;
+    for (const QFileInfo &fileInfo : dir.entryInfoList({"*.lnk"}, QDir::Files))
+    {
+        const QString shortcut = QDir::cleanPath(fileInfo.absoluteFilePath());
+        if (!shortcuts.contains(shortcut))
+            added += addShortcut(shortcut) ? 1 : 0;
+    }
+
+    for (const QString &name : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+    {
+        const QString subdirectory = QDir::cleanPath(dir.filePath(name));
+        if (known.contains(subdirectory))
+            continue;
+        for (const QString &createdDirectory : directoryTreeOf(subdirectory))
+        {
+            known.insert(createdDirectory);
+            for (const QFileInfo &fileInfo : QDir(createdDirectory).entryInfoList({"*.lnk"}, QDir::Files))
+                added += addShortcut(QDir::cleanPath(fileInfo.absoluteFilePath())) ? 1 : 0;
+        }
     }
+    return added;
+}
 
-    // Get the path to the link target.
-    wchar_t szGotPath[MAX_PATH];
-    hr = pShellLink->GetPath(szGotPath, MAX_PATH, nullptr, SLGP_UNCPRIORITY); // Or SLGP_SHORTPATH etc.
-    if (SUCCEEDED(hr))
+/**
+ * Build the lookups of the live entries by shortcut and by target path, once the catalog is loaded.
+ */
+void AppsSearch::buildLookups()
+{
+    for (qsizetype id = 0; id < m_apps.size(); ++id)
     {
-        targetPath = QString::fromWCharArray(szGotPath);
+        if (!m_apps.at(id).removed)
+            registerShortcuts(m_apps.at(id), static_cast<quint32>(id));
     }
+    m_lookupsBuilt = true;
+}
 
-    // Release interfaces.
-    pPersistFile->Release();
-    pShellLink->Release();
+/**
+ * Write the catalog to the configuration file, including the apps added by hand.
+ */
+void AppsSearch::saveCatalog() const
+{
+    QJsonArray appsArray;
+    for (const AppInfo &app : m_apps)
+    {
+        if (app.removed)
+            continue;
 
-    // Uninitialize COM.
-    CoUninitialize();
+        QJsonObject appObject;
+        appObject["name"] = app.name;
+        appObject["path"] = app.path;
+        if (!app.iconPath.isEmpty())
+            appObject["icon"] = app.iconPath;
+        QJsonArray keywordsArray;
+        for (qsizetype textIndex = app.firstText + 1; textIndex < app.firstText + app.textCount; ++textIndex)
+            keywordsArray.append(m_texts.at(textIndex));
+        appObject["keywords"] = keywordsArray;
+        if (!app.shortcut.isEmpty())
+            appObject["shortcut"] = app.shortcut;
+        if (!app.otherShortcuts.isEmpty())
+            appObject["otherShortcuts"] = QJsonArray::fromStringList(app.otherShortcuts.split('\n'));
+        appsArray.append(appObject);
+    }
+
+    QJsonObject rootObject;
+    rootObject["apps"] = appsArray;
+    if (!ConfigManager::saveConfig(this, QJsonDocument(rootObject)))
+        qWarning() << "Apps Search: failed to save the catalog";
+}
+
+/**
+ * Map the snapshot of the catalog, if it was built from the current configuration file.
+ *
+ * @param configPath The path to the JSON configuration file.
+ * @return True if the catalog was loaded from the snapshot; false if it must be loaded from the JSON.
+ */
+bool AppsSearch::loadSnapshot(const QString &configPath)
+{
+    m_snapshotFile.setFileName(snapshotPathOf(configPath));
+    if (!m_snapshotFile.open(QIODevice::ReadOnly))
+        return false;
+
+    const qint64 size = m_snapshotFile.size();
+    const uchar *data = m_snapshotFile.map(0, size);
+    if (data && mapSnapshot(data, size, configPath))
+        return true;
+
+    m_apps.clear();
+    m_texts.clear();
+    m_targets.clear();
+    m_index.clear();
+    m_snapshotFile.close(); // Also unmaps the file.
+    return false;
+}
+
+/**
+ * Point the catalog and the index to a mapped snapshot.
+ *
+ * No string is copied: the names, paths and prepared texts are views on the mapping.
+ *
+ * @param data The mapped snapshot.
+ * @param size The size of the snapshot in bytes.
+ * @param configPath The path to the JSON configuration file the snapshot must match.
+ * @return True if the snapshot is current and well-formed; false otherwise.
+ */
+bool AppsSearch::mapSnapshot(const uchar *data, const qint64 size, const QString &configPath)
+{
+    SnapshotHeader header;
+    if (size < static_cast<qint64>(sizeof(header)))
+        return false;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION)
+        return false;
+
+    // A touched but unchanged JSON is still current.
+    const QFileInfo configInfo(configPath);
+    if ((header.sourceModified != configInfo.lastModified().toMSecsSinceEpoch() || header.sourceSize != configInfo.size()) &&
+        hashOf(configPath) != QByteArray(header.sourceHash, sizeof(header.sourceHash)))
+        return false;
+
+    const auto fits = [size](const quint64 offset, const quint64 bytes, const quint64 alignment)
+    { return offset % alignment == 0 && offset <= static_cast<quint64>(size) && bytes <= static_cast<quint64>(size) - offset; };
+    if (!fits(header.poolOffset, header.poolLength * sizeof(QChar), alignof(QChar)) ||
+        !fits(header.appsOffset, header.appCount * sizeof(SnapshotApp), alignof(SnapshotApp)) ||
+        !fits(header.textsOffset, header.textCount * sizeof(SnapshotText), alignof(SnapshotText)) || !fits(header.bonusesOffset, header.bonusesSize, 1) ||
+        !fits(header.indexOffset, header.indexSize, alignof(quint64)))
+        return false;
+    if (!m_index.loadFrozen(data + header.indexOffset, static_cast<qsizetype>(header.indexSize), header.appCount))
+        return false;
+
+    const auto *pool = reinterpret_cast<const QChar *>(data + header.poolOffset);
+    const auto *bonuses = reinterpret_cast<const char *>(data + header.bonusesOffset);
+    const auto inPool = [&header](const quint32 offset, const quint32 length) { return static_cast<quint64>(offset) + length <= header.poolLength; };
+
+    const auto *texts = reinterpret_cast<const SnapshotText *>(data + header.textsOffset);
+    m_texts.resize(header.textCount);
+    m_targets.resize(header.textCount);
+    for (quint32 textIndex = 0; textIndex < header.textCount; ++textIndex)
+    {
+        const SnapshotText &text = texts[textIndex];
+        if (!inPool(text.text, text.length) || !inPool(text.lower, text.length) || static_cast<quint64>(text.bonuses) + text.length > header.bonusesSize)
+            return false;
+        m_texts[textIndex] = QString::fromRawData(pool + text.text, text.length);
+        m_targets[textIndex] = {QString::fromRawData(pool + text.lower, text.length), QByteArray::fromRawData(bonuses + text.bonuses, text.length),
+                                text.charMask};
+    }
 
+    const auto *apps = reinterpret_cast<const SnapshotApp *>(data + header.appsOffset);
+    m_apps.resize(header.appCount);
+    for (quint32 id = 0; id < header.appCount; ++id)
+    {
+        const SnapshotApp &app = apps[id];
+        if (!inPool(app.name, app.nameLength) || !inPool(app.path, app.pathLength) || !inPool(app.iconPath, app.iconPathLength) ||
+            !inPool(app.shortcut, app.shortcutLength) || !inPool(app.otherShortcuts, app.otherShortcutsLength) ||
+            static_cast<quint64>(app.firstText) + app.textCount > header.textCount)
+            return false;
+        m_apps[id] = {QString::fromRawData(pool + app.name, app.nameLength),
+                      QString::fromRawData(pool + app.path, app.pathLength),
+                      QString::fromRawData(pool + app.iconPath, app.iconPathLength),
+                      QString::fromRawData(pool + app.shortcut, app.shortcutLength),
+                      QString::fromRawData(pool + app.otherShortcuts, app.otherShortcutsLength),
+                      app.firstText,
+                      app.textCount,
+                      app.removed != 0};
+    }
     return true;
 }
+
+/**
+ * Write the snapshot of the catalog and its index.
+ *
+ * @param configPath The path to the JSON configuration file the catalog was loaded from.
+ * @return True if the snapshot was written; false otherwise.
+ */
+bool AppsSearch::saveSnapshot(const QString &configPath) const
+{
+    const QByteArray sourceHash = hashOf(configPath);
+    if (sourceHash.size() != static_cast<qsizetype>(sizeof(SnapshotHeader::sourceHash)))
+        return false;
+
+    QString pool;
+    const auto addString = [&pool](const QString &text)
+    {
+        const auto offset = static_cast<quint32>(pool.size());
+        pool.append(text);
+        return offset;
+    };
+    const auto lengthOf = [](const QString &text) { return static_cast<quint32>(text.size()); };
+
+    QVector<SnapshotApp> apps;
+    apps.reserve(m_apps.size());
+    for (const AppInfo &app : m_apps)
+        apps.append({addString(app.name), lengthOf(app.name), addString(app.path), lengthOf(app.path), addString(app.iconPath), lengthOf(app.iconPath),
+                     addString(app.shortcut), lengthOf(app.shortcut), addString(app.otherShortcuts), lengthOf(app.otherShortcuts),
+                     static_cast<quint32>(app.firstText), static_cast<quint32>(app.textCount), app.removed ? 1U : 0U});
+
+    QVector<SnapshotText> texts;
+    texts.reserve(m_texts.size());
+    QByteArray bonuses;
+    for (qsizetype textIndex = 0; textIndex < m_texts.size(); ++textIndex)
+    {
+        const FuzzyMatcher::Target &target = m_targets.at(textIndex);
+        texts.append({addString(m_texts.at(textIndex)), lengthOf(m_texts.at(textIndex)), addString(target.text), static_cast<quint32>(bonuses.size()),
+                      target.charMask});
+        bonuses.append(target.bonuses);
+    }
+    const QByteArray index = m_index.freeze();
+
+    // Lay out the sections after the header, each aligned to 8 bytes.
+    const QFileInfo configInfo(configPath);
+    SnapshotHeader header = {};
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.sourceModified = configInfo.lastModified().toMSecsSinceEpoch();
+    header.sourceSize = configInfo.size();
+    std::memcpy(header.sourceHash, sourceHash.constData(), sizeof(header.sourceHash));
+    header.appCount = static_cast<quint32>(apps.size());
+    header.textCount = static_cast<quint32>(texts.size());
+    quint64 end = sizeof(header);
+    const auto allocate = [&end](const quint64 bytes)
+    {
+        const quint64 offset = (end + 7) & ~quint64(7);
+        end = offset + bytes;
+        return offset;
+    };
+    header.poolLength = pool.size();
+    header.poolOffset = allocate(pool.size() * sizeof(QChar));
+    header.appsOffset = allocate(apps.size() * sizeof(SnapshotApp));
+    header.textsOffset = allocate(texts.size() * sizeof(SnapshotText));
+    header.bonusesSize = bonuses.size();
+    header.bonusesOffset = allocate(bonuses.size());
+    header.indexSize = index.size();
+    header.indexOffset = allocate(index.size());
+
+    QSaveFile file(snapshotPathOf(configPath));
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    const auto writeSection = [&file](const quint64 offset, const void *section, const quint64 bytes)
+    {
+        file.write(QByteArray(static_cast<qsizetype>(offset - file.pos()), '\0'));
+        file.write(static_cast<const char *>(section), static_cast<qint64>(bytes));
+    };
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    writeSection(header.poolOffset, pool.constData(), pool.size() * sizeof(QChar));
+    writeSection(header.appsOffset, apps.constData(), apps.size() * sizeof(SnapshotApp));
+    writeSection(header.textsOffset, texts.constData(), texts.size() * sizeof(SnapshotText));
+    writeSection(header.bonusesOffset, bonuses.constData(), bonuses.size());
+    writeSection(header.indexOffset, index.constData(), index.size());
+    return file.commit();
+}
+
+/**
+ * Get the Start Menu directories to generate the catalog from.
+ *
+ * @return The cleaned paths of the user and system Start Menu programs.
+ */
+QStringList AppsSearch::startMenuPaths()
+{
+    return {QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::ApplicationsLocation)), // User start menu.
+            QDir::cleanPath(R"(C:\ProgramData\Microsoft\Windows\Start Menu\Programs)")}; // System start menu.
+}
+
+/**
+ * List a directory and all its subdirectories.
+ *
+ * @param root The directory.
+ * @return The cleaned paths of the directories; empty if the root does not exist.
+ */
+QStringList AppsSearch::directoryTreeOf(const QString &root)
+{
+    if (!QFileInfo(root).isDir())
+        return {};
+
+    QStringList directories = {QDir::cleanPath(root)};
+    QDirIterator iterator(root, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (iterator.hasNext())
+        directories.append(QDir::cleanPath(iterator.next()));
+    return directories;
+}
+
+/**
+ * Derive the default keyword of an app from its name.
+ *
+ * @param name The name of the app.
+ * @return The name in lowercase, without non-alphanumeric characters.
+ */
+QString AppsSearch::keywordOf(const QString &name)
+{
+    static const QRegularExpression regex("[^A-Za-z0-9]");
+    return QString(name).remove(regex).toLower();
+}
+
+/**
+ * Get the key of the directory of a shortcut in the lookup.
+ *
+ * @param shortcutPath The cleaned path to the shortcut.
+ * @return The lowercased path of its directory.
+ */
+QString AppsSearch::directoryKeyOf(const QString &shortcutPath)
+{
+    return shortcutPath.left(shortcutPath.lastIndexOf('/')).toLower();
+}
+
+/**
+ * Get the path of the snapshot of a configuration file.
+ *
+ * @param configPath The path to the JSON configuration file.
+ * @return The path to the snapshot, next to the configuration file.
+ */
+QString AppsSearch::snapshotPathOf(const QString &configPath)
+{
+    const QFileInfo configInfo(configPath);
+    return configInfo.dir().filePath(configInfo.completeBaseName() + ".snapshot");
+}
+
+/**
+ * Hash the content of a file.
+ *
+ * @param filePath The path to the file.
+ * @return The SHA-256 of the content; empty if the file cannot be read.
+ */
+QByteArray AppsSearch::hashOf(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(&file);
+    return hash.result();
+}
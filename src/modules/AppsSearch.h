@@ -1,6 +1,15 @@
 #pragma once
 
+#include <QFile>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QMap>
+#include <QReadWriteLock>
+#include <QSet>
+#include <QTimer>
 #include "../common/IModule.h"
+#include "../utils/FuzzyMatcher.h"
+#include "../utils/TrigramIndex.h"
 
 class AppsSearch final : public IModule
 {
@@ -12,7 +21,9 @@ public:
     [[nodiscard]] QString name() const override { return "Apps Search"; }
     [[nodiscard]] QChar iconGlyph() const override { return QChar(0xe5c3); } // Apps.
     [[nodiscard]] QJsonDocument defaultConfig() const override;
-    void query(const QString &text) override;
+    [[nodiscard]] const QVector<Action> &actions(const ResultItem &item) const override;
+    void initialize() override;
+    void query(const QString &text, const QueryToken &token) override;
 
 private:
     struct AppInfo
@@ -20,10 +31,50 @@ private:
         QString name;
         QString path;
         QString iconPath;
-        QVector<QString> keywords;
+        QString shortcut; // The Start Menu shortcut the entry was generated from; empty if added by hand.
+        QString otherShortcuts; // Other shortcuts to the same target, separated by newlines; the next one takes over if the shortcut is removed.
+        qsizetype firstText = 0; // The name and the keywords of the app are m_texts[firstText, firstText + textCount).
+        qsizetype textCount = 0;
+        bool removed = false; // Removed entries keep their id, so that the ids in the index stay valid.
     };
 
-    QVector<AppInfo> m_apps;
+    void addApp(const QString &name, const QString &path, const QString &iconPath, const QVector<QString> &keywords, const QString &shortcut = {},
+                const QString &otherShortcuts = {});
+    void removeApp(quint32 id);
+    bool addShortcut(const QString &shortcutPath);
+    void removeShortcut(const QString &shortcutPath);
+    void registerShortcuts(const AppInfo &app, quint32 id);
+    void unregisterShortcuts(const AppInfo &app);
+    void watchStartMenu(const QStringList &directories);
+    void onDirectoryChanged(const QString &directory);
+    void applyDirectoryChanges();
+    int syncDirectories(const QStringList &directories, QSet<QString> &known);
+    int removeMissingShortcuts(const QString &directory);
+    int addNewShortcuts(const QString &directory, QSet<QString> &known);
+    void buildLookups();
+    void saveCatalog() const;
+    bool loadSnapshot(const QString &configPath);
+    bool mapSnapshot(const uchar *data, qint64 size, const QString &configPath);
+    bool saveSnapshot(const QString &configPath) const;
+
+    [[nodiscard]] static QStringList startMenuPaths();
+    [[nodiscard]] static QStringList directoryTreeOf(const QString &root);
+    [[nodiscard]] static QString keywordOf(const QString &name);
+    [[nodiscard]] static QString directoryKeyOf(const QString &shortcutPath);
+    [[nodiscard]] static QString snapshotPathOf(const QString &configPath);
+    [[nodiscard]] static QByteArray hashOf(const QString &filePath);
 
-    static bool getShortcutPath(const QString &shortcutPath, QString &targetPath);
+    QFile m_snapshotFile; // Declared first, as the catalog may point into its mapping.
+    QVector<AppInfo> m_apps;
+    QVector<QString> m_texts; // The names and keywords of all apps, in original case.
+    QVector<FuzzyMatcher::Target> m_targets; // The same texts, prepared for matching.
+    TrigramIndex m_index;
+    QMap<QString, QHash<QString, quint32>> m_directoryShortcuts; // Ids of the live entries by shortcut, by lowercased directory.
+    QHash<QString, quint32> m_pathIds; // Ids of the live entries, by lowercased target path.
+    bool m_lookupsBuilt = false;
+    mutable QReadWriteLock m_lock; // Guards the catalog, which is queried on worker threads.
+    QFileSystemWatcher m_watcher;
+    QTimer m_rescanTimer;
+    QSet<QString> m_changedDirectories;
+    QVector<Action> m_appActions;
 };
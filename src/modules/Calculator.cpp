@@ -1,17 +1,102 @@
 #include "Calculator.h"
 #include <QApplication>
 #include <QClipboard>
+#include <algorithm>
 #include "../../third-party/muparser/include/muParser.h"
 
-Calculator::Calculator(QObject *parent) : IModule(parent) {}
+namespace
+{
+    constexpr int PARSER_CACHE_SIZE = 32; // Enough to keep the parsers of an expression being edited back and forth.
+
+    /**
+     * Check whether a sorted list holds a name, without allocating.
+     *
+     * @param sortedNames The names, sorted.
+     * @param name The name.
+     * @return True if the name is in the list.
+     */
+    bool containsName(const QStringList &sortedNames, const QStringView name)
+    {
+        const auto isBefore = [](const QString &left, const QStringView right) { return QStringView(left) < right; };
+        const auto iterator = std::lower_bound(sortedNames.cbegin(), sortedNames.cend(), name, isBefore);
+        return iterator != sortedNames.cend() && *iterator == name;
+    }
+} // namespace
+
+Calculator::Calculator(QObject *parent) : IModule(parent)
+{
+    m_parsers.setMaxCost(PARSER_CACHE_SIZE);
+
+    // The title of a result is the value; the payload is the expression and the exact value.
+    Action copyAction;
+    copyAction.description = "Copy result";
+    copyAction.handler = [this](const ResultItem &item)
+    {
+        QApplication::clipboard()->setText(item.title);
+        m_ans = item.payload.toList().at(1).toDouble();
+    };
+    copyAction.shortcut = QKeySequence(Qt::CTRL | Qt::Key_C);
+    Action copyExpressionAction;
+    copyExpressionAction.description = "Copy expression";
+    copyExpressionAction.iconGlyph = QChar(0xe2ec); // Copy all;
+    copyExpressionAction.handler = [this](const ResultItem &item)
+    {
+        const QVariantList payload = item.payload.toList();
+        QApplication::clipboard()->setText(payload.at(0).toString() + "=" + item.title);
+        m_ans = payload.at(1).toDouble();
+    };
+    copyExpressionAction.shortcut = QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_C);
+    m_resultActions = {copyAction, copyExpressionAction};
+}
+
+Calculator::~Calculator() = default;
+
+const QVector<Action> &Calculator::actions(const ResultItem &item) const
+{
+    Q_UNUSED(item)
+    return m_resultActions;
+}
 
-void Calculator::query(const QString &text)
+/**
+ * Build the symbol tables once; each parser is a copy of the prototype. The names
+ * the pre-screen accepts are read from them, so that they never drift apart.
+ */
+void Calculator::initialize()
 {
+    m_prototype = std::make_unique<mu::Parser>();
+    m_prototype->DefineVar(L"ans", &m_ansValue);
+
+    for (const auto &function : m_prototype->GetFunDef())
+        m_functionNames.append(QString::fromStdWString(function.first));
+    for (const auto &constant : m_prototype->GetConst())
+        m_operandNames.append(QString::fromStdWString(constant.first));
+    for (const auto &variable : m_prototype->GetVar())
+        m_operandNames.append(QString::fromStdWString(variable.first));
+    std::sort(m_functionNames.begin(), m_functionNames.end());
+    std::sort(m_operandNames.begin(), m_operandNames.end());
+}
+
+void Calculator::query(const QString &text, const QueryToken &token)
+{
+    // Most queries are not math, so they are rejected before any parser work.
+    if (!isExpression(text))
+        return;
+
     try
     {
-        mu::Parser parser;
-        parser.SetExpr(text.toStdWString());
-        double value = parser.Eval();
+        // The parser of an expression seen recently evaluates its bytecode instead of parsing again.
+        mu::Parser *parser = m_parsers.object(text);
+        std::unique_ptr<mu::Parser> newParser;
+        if (!parser)
+        {
+            newParser = std::make_unique<mu::Parser>(*m_prototype);
+            newParser->SetExpr(text.toStdWString());
+            parser = newParser.get();
+        }
+        m_ansValue = m_ans;
+        const double value = parser->Eval();
+        if (newParser)
+            m_parsers.insert(text, newParser.release());
 
         QVector<ResultItem> results;
         ResultItem item;
@@ -19,20 +104,11 @@ void Calculator::query(const QString &text)
         item.subtitle = "Calculator";
         item.iconGlyph = QChar(0xea5f); // Calculate.
         item.iconType = IconType::Font;
-        Action copyAction;
-        copyAction.description = "Copy result";
-        copyAction.handler = [value] { QApplication::clipboard()->setText(QString::number(value)); };
-        copyAction.shortcut = QKeySequence(Qt::CTRL | Qt::Key_C);
-        Action copyExpressionAction;
-        copyExpressionAction.description = "Copy expression";
-        copyExpressionAction.iconGlyph = QChar(0xe2ec); // Copy all;
-        copyExpressionAction.handler = [text, value] { QApplication::clipboard()->setText(text + "=" + QString::number(value)); };
-        copyExpressionAction.shortcut = QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_C);
-        item.actions = {copyAction, copyExpressionAction};
         item.key = "calculator";
+        item.payload = QVariantList{text, value};
         results.append(item);
 
-        emit resultsReady(results, this);
+        emit resultsReady(results, this, token.generation());
     }
     catch (mu::Parser::exception_type &)
     {
@@ -40,3 +116,74 @@ void Calculator::query(const QString &text)
         // An invalid math expression is not en error to handle.
     }
 }
+
+/**
+ * Check whether a text may be a math expression, without allocating.
+ *
+ * The text must only hold numbers, operators, parentheses and the names
+ * the parsers know, with balanced parentheses, and must not end with an
+ * operator. Texts passing the check may still be invalid.
+ *
+ * @param text The search text.
+ * @return False if the text is certainly not an expression.
+ */
+bool Calculator::isExpression(const QStringView text) const
+{
+    int depth = 0;
+    bool hasOperand = false;
+    QChar last;
+    for (qsizetype position = 0; position < text.size();)
+    {
+        const QChar character = text.at(position);
+        if (character.isSpace())
+        {
+            ++position;
+            continue;
+        }
+        last = character;
+
+        // A number, with an optional fraction and exponent.
+        if (character.isDigit() || character == '.')
+        {
+            while (position < text.size() && (text.at(position).isDigit() || text.at(position) == '.'))
+                ++position;
+            if (position < text.size() && (text.at(position) == 'e' || text.at(position) == 'E') && position + 1 < text.size() &&
+                (text.at(position + 1).isDigit() || ((text.at(position + 1) == '+' || text.at(position + 1) == '-') && position + 2 < text.size() &&
+                                                     text.at(position + 2).isDigit())))
+            {
+                position += 2;
+                while (position < text.size() && text.at(position).isDigit())
+                    ++position;
+            }
+            hasOperand = true;
+            last = text.at(position - 1);
+            continue;
+        }
+
+        // A function, a constant or ans.
+        if (character.isLetter() || character == '_')
+        {
+            const qsizetype start = position;
+            while (position < text.size() && (text.at(position).isLetterOrNumber() || text.at(position) == '_'))
+                ++position;
+            const QStringView name = text.mid(start, position - start);
+            const bool isOperand = containsName(m_operandNames, name);
+            if (!isOperand && !containsName(m_functionNames, name))
+                return false;
+            hasOperand = hasOperand || isOperand;
+            last = text.at(position - 1);
+            continue;
+        }
+
+        if (character == '(')
+            ++depth;
+        else if (character == ')' && --depth < 0)
+            return false;
+        else if (!QStringView(u"+-*/^,<>=!&|?:").contains(character))
+            return false;
+        ++position;
+    }
+
+    // The last character must close an operand: a digit, a name or a parenthesis.
+    return hasOperand && depth == 0 && (last.isLetterOrNumber() || last == '_' || last == '.' || last == ')');
+}
@@ -1,15 +1,37 @@
 #pragma once
 
+#include <QCache>
+#include <atomic>
+#include <memory>
 #include "../common/IModule.h"
 
+namespace mu
+{
+    class Parser;
+}
+
 class Calculator final : public IModule
 {
     Q_OBJECT
 
 public:
     explicit Calculator(QObject *parent = nullptr);
+    ~Calculator() override;
 
     [[nodiscard]] QString name() const override { return "Calculator"; }
     [[nodiscard]] QChar iconGlyph() const override { return QChar(0xea5f); } // Calculate.
-    void query(const QString &text) override;
+    [[nodiscard]] const QVector<Action> &actions(const ResultItem &item) const override;
+    void initialize() override;
+    void query(const QString &text, const QueryToken &token) override;
+
+private:
+    [[nodiscard]] bool isExpression(QStringView text) const;
+
+    QVector<Action> m_resultActions;
+    QStringList m_functionNames; // The functions of the parsers, sorted, for the pre-screen.
+    QStringList m_operandNames; // Their constants and variables, such as ans, sorted.
+    std::unique_ptr<mu::Parser> m_prototype; // Holds the symbol tables and the ans variable, copied into each parser.
+    QCache<QString, mu::Parser> m_parsers; // The parsers of the recent expressions, which keep their bytecode.
+    std::atomic<double> m_ans = 0.0; // The last copied result; set on the GUI thread.
+    double m_ansValue = 0.0; // The value of ans seen by the parsers, updated before each evaluation.
 };
@@ -1,23 +1,88 @@
 #include "EverythingSearch.h"
 #include <QApplication>
 #include <QClipboard>
-#include "../../third-party/everything-sdk/include/Everything.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <algorithm>
+#include <cmath>
 #include "../core/ConfigManager.h"
+#include "../utils/DialogUtils.h"
 #include "../utils/ProcessUtils.h"
+#ifdef Q_OS_WIN
+#include "filesearch/EverythingBackend.h"
+#endif
+#include "filesearch/FileIndexBackend.h"
+#include "filesearch/SyntheticFileSearchBackend.h"
 
-EverythingSearch::EverythingSearch(QObject *parent) : IModule(parent)
+EverythingSearch::EverythingSearch(QObject *parent) : EverythingSearch(nullptr, parent) {}
+
+/**
+ * Create the module with a backend of the caller instead of the configured one, such as the synthetic corpus of the benchmarks.
+ *
+ * @param backend The backend; null for the configured one.
+ * @param parent The parent object.
+ */
+EverythingSearch::EverythingSearch(std::unique_ptr<FileSearchBackend> backend, QObject *parent) : IModule(parent), m_backend(std::move(backend))
 {
     const QJsonDocument doc = ConfigManager::loadConfig(this);
     const QJsonObject rootObject = doc.object();
     m_maxResults = rootObject["maxResults"].toInt();
+    m_pageSize = std::max(1, rootObject["pageSize"].toInt(m_pageSize)); // Absent from configurations written before the paging.
     m_runCountWeight = rootObject["runCountWeight"].toDouble();
+    m_backendName = rootObject["backend"].toString(m_backendName); // Absent from configurations written before the backends.
+
+    if (rootObject.contains("indexRoots"))
+    {
+        m_indexRoots.clear();
+        for (const QJsonValue root : rootObject["indexRoots"].toArray())
+            m_indexRoots.append(root.toString());
+    }
+
+    // The backends are cheap to construct; their heavy work is done in initialize.
+    if (!m_backend)
+        m_backend = createBackend();
+
+    // The payload of a result is the full path of the file.
+    Action openAction;
+    openAction.description = "Open";
+    openAction.handler = [this](const ResultItem &item)
+    {
+        const QString fullPath = item.payload.toString();
+        ProcessUtils::startDetached("explorer", {fullPath});
+        m_backend->recordRun(fullPath);
+    };
+    Action openPathAction;
+    openPathAction.description = "Open path";
+    openPathAction.iconGlyph = QChar(0xe2c8); // Folder open.
+    openPathAction.handler = [this](const ResultItem &item)
+    {
+        const QString fullPath = item.payload.toString();
+        ProcessUtils::startDetached("explorer", {directoryOf(fullPath)});
+        m_backend->recordRun(fullPath);
+    };
+    openPathAction.shortcut = QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_E);
+    Action copyAction;
+    copyAction.description = "Copy";
+    copyAction.iconGlyph = QChar(0xe173); // File copy.
+    copyAction.handler = [](const ResultItem &item) { QApplication::clipboard()->setText(item.payload.toString()); };
+    copyAction.shortcut = QKeySequence(Qt::CTRL | Qt::Key_C);
+    Action copyPathAction;
+    copyPathAction.description = "Copy path";
+    copyPathAction.iconGlyph = QChar(0xebbd); // Folder copy.
+    copyPathAction.handler = [](const ResultItem &item) { QApplication::clipboard()->setText(directoryOf(item.payload.toString())); };
+    copyPathAction.shortcut = QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_C);
+    m_fileActions = {openAction, openPathAction, copyAction, copyPathAction};
 }
 
 QJsonDocument EverythingSearch::defaultConfig() const
 {
     // clang-format off
     const QJsonObject rootObject{
+        {"backend", m_backendName},
+        {"indexRoots", QJsonArray::fromStringList(m_indexRoots)},
         {"maxResults", m_maxResults},
+        {"pageSize", m_pageSize},
         {"runCountWeight", m_runCountWeight}
     };
     // clang-format on
@@ -25,69 +90,98 @@ QJsonDocument EverythingSearch::defaultConfig() const
     return QJsonDocument(rootObject);
 }
 
-void EverythingSearch::query(const QString &text)
+/**
+ * Create the configured backend.
+ *
+ * @return The backend; Everything if the configured one is unknown.
+ */
+std::unique_ptr<FileSearchBackend> EverythingSearch::createBackend() const
 {
-    QVector<ResultItem> results;
+    if (m_backendName == "index")
+    {
+        const QFileInfo configInfo(ConfigManager::getModuleConfigPath(this));
+        return std::make_unique<FileIndexBackend>(m_indexRoots, configInfo.dir().filePath(configInfo.completeBaseName() + ".index"));
+    }
 
-    Everything_SetSearchW(text.toStdWString().c_str());
-    Everything_SetMax(m_maxResults);
-    Everything_SetSort(EVERYTHING_SORT_RUN_COUNT_DESCENDING);
-    Everything_SetRequestFlags(EVERYTHING_REQUEST_FILE_NAME | EVERYTHING_REQUEST_PATH | EVERYTHING_REQUEST_RUN_COUNT);
-    Everything_QueryW(true);
-    if (const DWORD lastError = Everything_GetLastError(); lastError == EVERYTHING_ERROR_IPC)
+    if (m_backendName != "everything")
+        DialogUtils::showWarning(QString("Unknown backend %1 for module %2. ").arg(m_backendName, name()));
+#ifdef Q_OS_WIN
+    return std::make_unique<EverythingBackend>();
+#else
+    return std::make_unique<SyntheticFileSearchBackend>(0); // Everything only runs on Windows; the benchmarks pass their own backend.
+#endif
+}
+
+const QVector<Action> &EverythingSearch::actions(const ResultItem &item) const
+{
+    if (item.payload.isNull()) // Error messages have no actions.
+        return IModule::actions(item);
+    return m_fileActions;
+}
+
+void EverythingSearch::initialize() { m_backend->initialize(); }
+
+void EverythingSearch::stop() { m_backend->stop(); }
+
+void EverythingSearch::query(const QString &text, const QueryToken &token) { searchPage(text, 0, token); }
+
+void EverythingSearch::fetchMore(const QString &text, const int offset, const QueryToken &token) { searchPage(text, offset, token); }
+
+/**
+ * Search a page of files and emit it at once.
+ *
+ * Only the first page is searched when the text changes, so that the first
+ * results do not wait for the whole maxResults; moreResultsAvailable then
+ * tells whether the next page can be fetched.
+ *
+ * @param text The search text.
+ * @param offset The number of results already provided for the text.
+ * @param token The token of the query.
+ */
+void EverythingSearch::searchPage(const QString &text, const int offset, const QueryToken &token)
+{
+    const int pageSize = std::min(m_pageSize, m_maxResults - offset);
+    if (pageSize <= 0)
+        return;
+    const FileSearchResults found = m_backend->search(text, offset, pageSize, token);
+    if (found.status == FileSearchResults::Status::Cancelled || token.isCancelled())
+        return;
+
+    QVector<ResultItem> results;
+    if (found.status == FileSearchResults::Status::Unavailable)
     {
         ResultItem item;
-        item.title = "Everything is not running";
+        item.title = m_backend->unavailableMessage();
         item.subtitle = "Everything Search";
         item.iconGlyph = QChar(0xf8b6); // Error.
         item.iconType = IconType::Font;
         results.append(item);
     }
-    else if (lastError == EVERYTHING_OK)
+    else if (found.status == FileSearchResults::Status::Ok)
     {
-        const DWORD numResults = Everything_GetNumResults();
-        for (DWORD resultIndex = 0; resultIndex < numResults; ++resultIndex)
+        results.reserve(found.entries.size());
+        for (qsizetype resultIndex = 0; resultIndex < found.entries.size(); ++resultIndex)
         {
-            const QString fileName = QString::fromWCharArray(Everything_GetResultFileNameW(resultIndex));
-            const QString filePath = QString::fromWCharArray(Everything_GetResultPathW(resultIndex));
-            const int runCount = static_cast<int>(Everything_GetResultRunCount(resultIndex));
-
             ResultItem item;
-            item.title = fileName;
-            item.subtitle = item.iconPath = filePath + "\\" + fileName;
+            item.title = found.nameAt(resultIndex).toString();
+            item.subtitle = item.iconPath = QString("%1\\%2").arg(found.directoryAt(resultIndex), found.nameAt(resultIndex));
             item.iconType = IconType::Thumbnail;
-            Action openAction;
-            openAction.description = "Open";
-            openAction.handler = [filePath, fileName]
-            {
-                ProcessUtils::startDetached("explorer", {filePath + "\\" + fileName});
-                Everything_IncRunCountFromFileNameW((filePath + "\\" + fileName).toStdWString().c_str());
-            };
-            Action openPathAction;
-            openPathAction.description = "Open path";
-            openPathAction.iconGlyph = QChar(0xe2c8); // Folder open.
-            openPathAction.handler = [filePath, fileName]
-            {
-                ProcessUtils::startDetached("explorer", {filePath});
-                Everything_IncRunCountFromFileNameW((filePath + "\\" + fileName).toStdWString().c_str());
-            };
-            openPathAction.shortcut = QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_E);
-            Action copyAction;
-            copyAction.description = "Copy";
-            copyAction.iconGlyph = QChar(0xe173); // File copy.
-            copyAction.handler = [filePath, fileName] { QApplication::clipboard()->setText(filePath + "\\" + fileName); };
-            copyAction.shortcut = QKeySequence(Qt::CTRL | Qt::Key_C);
-            Action copyPathAction;
-            copyPathAction.description = "Copy path";
-            copyPathAction.iconGlyph = QChar(0xebbd); // Folder copy.
-            copyPathAction.handler = [filePath] { QApplication::clipboard()->setText(filePath); };
-            copyPathAction.shortcut = QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_C);
-            item.actions = {openAction, openPathAction, copyAction, copyPathAction};
-            item.key = "everything_" + filePath + "\\" + fileName;
-            item.score = 1 + log(runCount + 1) * m_runCountWeight;
+            item.key = "everything_" + item.subtitle;
+            item.payload = item.subtitle;
+            item.score = 1 + std::log(found.entries.at(resultIndex).runCount + 1) * m_runCountWeight;
             results.append(item);
         }
     }
 
-    emit resultsReady(results, this);
+    emit resultsReady(results, this, token.generation());
+    if (found.status == FileSearchResults::Status::Ok && offset + found.entries.size() < std::min<qsizetype>(found.totalCount, m_maxResults))
+        emit moreResultsAvailable(this, token.generation());
 }
+
+/**
+ * Get the directory part of a full path.
+ *
+ * @param fullPath The full path of a file, with backslash separators.
+ * @return The path of the directory containing the file.
+ */
+QString EverythingSearch::directoryOf(const QString &fullPath) { return fullPath.left(fullPath.lastIndexOf('\\')); }
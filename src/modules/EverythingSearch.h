@@ -1,6 +1,9 @@
 #pragma once
 
+#include <QDir>
+#include <memory>
 #include "../common/IModule.h"
+#include "filesearch/FileSearchBackend.h"
 
 class EverythingSearch final : public IModule
 {
@@ -8,13 +11,28 @@ class EverythingSearch final : public IModule
 
 public:
     explicit EverythingSearch(QObject *parent = nullptr);
+    EverythingSearch(std::unique_ptr<FileSearchBackend> backend, QObject *parent = nullptr);
 
     [[nodiscard]] QString name() const override { return "Everything Search"; }
     [[nodiscard]] QChar iconGlyph() const override { return QChar(0xf385); } // Document search.
     [[nodiscard]] QJsonDocument defaultConfig() const override;
-    void query(const QString &text) override;
+    [[nodiscard]] const QVector<Action> &actions(const ResultItem &item) const override;
+    void initialize() override;
+    void stop() override;
+    void query(const QString &text, const QueryToken &token) override;
+    void fetchMore(const QString &text, int offset, const QueryToken &token) override;
 
 private:
+    [[nodiscard]] std::unique_ptr<FileSearchBackend> createBackend() const;
+    void searchPage(const QString &text, int offset, const QueryToken &token);
+
+    static QString directoryOf(const QString &fullPath);
+
+    QString m_backendName = "everything";
+    QStringList m_indexRoots = {QDir::homePath()};
     int m_maxResults = 50;
+    int m_pageSize = 10;
     double m_runCountWeight = 1.0;
+    std::unique_ptr<FileSearchBackend> m_backend;
+    QVector<Action> m_fileActions;
 };
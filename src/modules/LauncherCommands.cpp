@@ -3,11 +3,43 @@
 #include <QDesktopServices>
 #include <QStandardPaths>
 #include <QTimer>
+#include "../core/ConfigWatcher.h"
 #include "../utils/ProcessUtils.h"
 
-LauncherCommands::LauncherCommands(QObject *parent) : IModule(parent) {}
+LauncherCommands::LauncherCommands(QObject *parent) : IModule(parent)
+{
+    // Actions are stored by the key of the result.
+    Action aboutAction;
+    aboutAction.description = "Open GitHub page";
+    aboutAction.handler = [](const ResultItem &) { QDesktopServices::openUrl(QUrl("https://github.com/georgel2020/launcher")); };
+    m_commandActions["launcher_about"] = {aboutAction};
+    Action exitAction;
+    exitAction.description = "Exit";
+    exitAction.handler = [](const ResultItem &) { QApplication::quit(); };
+    Action reloadAction;
+    reloadAction.description = "Reload";
+    reloadAction.iconGlyph = QChar(0xe5d5); // Refresh.
+    reloadAction.handler = [](const ResultItem &) { ConfigWatcher::instance()->reloadAll(); }; // Reloads in place, without restarting.
+    reloadAction.shortcut = QKeySequence(Qt::CTRL | Qt::Key_R);
+    m_commandActions["launcher_exit"] = {exitAction, reloadAction};
+    Action configureAction;
+    configureAction.description = "Open configuration path";
+    configureAction.handler = [](const ResultItem &)
+    {
+        const QString configPath = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation).replace("/", "\\");
+        ProcessUtils::startDetached("explorer", {configPath});
+    };
+    m_commandActions["launcher_configure"] = {configureAction};
+}
+
+const QVector<Action> &LauncherCommands::actions(const ResultItem &item) const
+{
+    if (const auto iterator = m_commandActions.constFind(item.key); iterator != m_commandActions.constEnd())
+        return iterator.value();
+    return IModule::actions(item);
+}
 
-void LauncherCommands::query(const QString &text)
+void LauncherCommands::query(const QString &text, const QueryToken &token)
 {
     QVector<ResultItem> results;
 
@@ -30,10 +62,6 @@ void LauncherCommands::query(const QString &text)
         item.iconGlyph = QChar(0xe88e); // Info.
         item.iconType = IconType::Font;
         item.key = "launcher_about";
-        Action aboutAction;
-        aboutAction.description = "Open GitHub page";
-        aboutAction.handler = [] { QDesktopServices::openUrl(QUrl("https://github.com/georgel2020/launcher")); };
-        item.actions = {aboutAction};
         item.score = QString("about").startsWith(text, Qt::CaseInsensitive) ? 0.5 : 0.1;
         results.append(item);
     }
@@ -46,19 +74,6 @@ void LauncherCommands::query(const QString &text)
         item.iconGlyph = QChar(0xe879); // Exit to app.
         item.iconType = IconType::Font;
         item.key = "launcher_exit";
-        Action exitAction;
-        exitAction.description = "Exit";
-        exitAction.handler = [] { QApplication::quit(); };
-        Action reloadAction;
-        reloadAction.description = "Reload";
-        reloadAction.iconGlyph = QChar(0xe5d5); // Refresh.
-        reloadAction.handler = []
-        {
-            ProcessUtils::startDetached(QApplication::arguments()[0], {}); // Does not work in Debug mode, when the build is a console application.
-            QApplication::quit();
-        };
-        reloadAction.shortcut = QKeySequence(Qt::CTRL | Qt::Key_R);
-        item.actions = {exitAction, reloadAction};
         item.score = QString("exit").startsWith(text, Qt::CaseInsensitive) || QString("quit").startsWith(text, Qt::CaseInsensitive) ||
                 QString("reload").startsWith(text, Qt::CaseInsensitive)
             ? 2.0
@@ -73,17 +88,9 @@ void LauncherCommands::query(const QString &text)
         item.iconGlyph = QChar(0xe8b8); // Settings.
         item.iconType = IconType::Font;
         item.key = "launcher_configure";
-        Action configureAction;
-        configureAction.description = "Open configuration path";
-        configureAction.handler = []
-        {
-            const QString configPath = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation).replace("/", "\\");
-            ProcessUtils::startDetached("explorer", {configPath});
-        };
-        item.actions = {configureAction};
         item.score = QString("configure").startsWith(text, Qt::CaseInsensitive) ? 2.0 : 1.0;
         results.append(item);
     }
 
-    emit resultsReady(results, this);
+    emit resultsReady(results, this, token.generation());
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QHash>
 #include "../common/IModule.h"
 
 class LauncherCommands final : public IModule
@@ -11,5 +12,9 @@ public:
 
     [[nodiscard]] QString name() const override { return "Launcher Commands"; }
     [[nodiscard]] QChar iconGlyph() const override { return QChar(0xeb9b); } // Rocket launch.
-    void query(const QString &text) override;
+    [[nodiscard]] const QVector<Action> &actions(const ResultItem &item) const override;
+    void query(const QString &text, const QueryToken &token) override;
+
+private:
+    QHash<QString, QVector<Action>> m_commandActions;
 };
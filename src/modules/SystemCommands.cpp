@@ -2,9 +2,31 @@
 #include <windows.h>
 #include "../utils/ProcessUtils.h"
 
-SystemCommands::SystemCommands(QObject *parent) : IModule(parent) {}
+SystemCommands::SystemCommands(QObject *parent) : IModule(parent)
+{
+    // Actions are stored by the key of the result.
+    Action shutdownAction;
+    shutdownAction.description = "Shutdown";
+    shutdownAction.handler = [](const ResultItem &) { ProcessUtils::startDetached("slidetoshutdown"); };
+    m_commandActions["system_shutdown"] = {shutdownAction};
+    Action restartAction;
+    restartAction.description = "Restart";
+    restartAction.handler = [](const ResultItem &) { ProcessUtils::startDetached("shutdown", {"-r", "-t", "0"}); };
+    m_commandActions["system_restart"] = {restartAction};
+    Action lockAction;
+    lockAction.description = "Lock";
+    lockAction.handler = [](const ResultItem &) { LockWorkStation(); };
+    m_commandActions["system_lock"] = {lockAction};
+}
+
+const QVector<Action> &SystemCommands::actions(const ResultItem &item) const
+{
+    if (const auto iterator = m_commandActions.constFind(item.key); iterator != m_commandActions.constEnd())
+        return iterator.value();
+    return IModule::actions(item);
+}
 
-void SystemCommands::query(const QString &text)
+void SystemCommands::query(const QString &text, const QueryToken &token)
 {
     QVector<ResultItem> results;
 
@@ -16,10 +38,6 @@ void SystemCommands::query(const QString &text)
         item.iconGlyph = QChar(0xe8ac); // Power settings new.
         item.iconType = IconType::Font;
         item.key = "system_shutdown";
-        Action shutdownAction;
-        shutdownAction.description = "Shutdown";
-        shutdownAction.handler = [] { ProcessUtils::startDetached("slidetoshutdown"); };
-        item.actions = {shutdownAction};
         item.score = QString("shutdown").startsWith(text, Qt::CaseInsensitive) ? 2.0 : 1.0;
         results.append(item);
     }
@@ -31,10 +49,6 @@ void SystemCommands::query(const QString &text)
         item.iconGlyph = QChar(0xe5d5); // Refresh.
         item.iconType = IconType::Font;
         item.key = "system_restart";
-        Action restartAction;
-        restartAction.description = "Restart";
-        restartAction.handler = [] { ProcessUtils::startDetached("shutdown", {"-r", "-t", "0"}); };
-        item.actions = {restartAction};
         item.score = QString("restart").startsWith(text, Qt::CaseInsensitive) ? 2.0 : 1.0;
         results.append(item);
     }
@@ -46,13 +60,9 @@ void SystemCommands::query(const QString &text)
         item.iconGlyph = QChar(0xe897); // Lock.
         item.iconType = IconType::Font;
         item.key = "system_lock";
-        Action lockAction;
-        lockAction.description = "Lock";
-        lockAction.handler = [] { LockWorkStation(); };
-        item.actions = {lockAction};
         item.score = QString("lock").startsWith(text, Qt::CaseInsensitive) ? 2.0 : 1.0;
         results.append(item);
     }
 
-    emit resultsReady(results, this);
+    emit resultsReady(results, this, token.generation());
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QHash>
 #include "../common/IModule.h"
 
 class SystemCommands final : public IModule
@@ -11,5 +12,9 @@ public:
 
     [[nodiscard]] QString name() const override { return "System Commands"; }
     [[nodiscard]] QChar iconGlyph() const override { return QChar(0xeae7); } // Keyboard command key.
-    void query(const QString &text) override;
+    [[nodiscard]] const QVector<Action> &actions(const ResultItem &item) const override;
+    void query(const QString &text, const QueryToken &token) override;
+
+private:
+    QHash<QString, QVector<Action>> m_commandActions;
 };
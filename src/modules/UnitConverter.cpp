@@ -1,11 +1,48 @@
 #include "UnitConverter.h"
 #include <QApplication>
 #include <QClipboard>
-#include "../../third-party/units/units/units.hpp"
+#include <cmath>
 
-UnitConverter::UnitConverter(QObject *parent) : IModule(parent) {}
+namespace
+{
+    constexpr int UNIT_CACHE_SIZE = 256;
+    constexpr int CONVERSION_CACHE_SIZE = 256;
+
+    // Parsed at startup, so that the tables of the units library are built before the first query.
+    const QStringList COMMON_UNITS = {"m",  "cm",  "mm",  "km", "in", "ft",  "yd", "mi",   "g",    "kg",   "lb",   "oz",   "l",  "ml",
+                                      "floz", "gal", "s",   "min", "h",  "m/s", "km/h", "mph", "degC", "degF", "K",    "J",    "cal", "W"};
+} // namespace
+
+UnitConverter::UnitConverter(QObject *parent) : IModule(parent)
+{
+    m_units.setMaxCost(UNIT_CACHE_SIZE);
+    m_conversions.setMaxCost(CONVERSION_CACHE_SIZE);
 
-void UnitConverter::query(const QString &text)
+    // The title of a result is the converted measurement.
+    Action copyAction;
+    copyAction.description = "Copy result";
+    copyAction.handler = [](const ResultItem &item) { QApplication::clipboard()->setText(item.title); };
+    copyAction.shortcut = QKeySequence(Qt::CTRL | Qt::Key_C);
+    m_resultActions = {copyAction};
+}
+
+const QVector<Action> &UnitConverter::actions(const ResultItem &item) const
+{
+    if (item.key.isEmpty()) // Error messages have no actions.
+        return IModule::actions(item);
+    return m_resultActions;
+}
+
+/**
+ * Warm the tables of the units library and the unit cache with common units.
+ */
+void UnitConverter::initialize()
+{
+    for (const QString &unit : COMMON_UNITS)
+        m_units.insert(unit, new units::precise_unit(units::unit_from_string(unit.toStdString())));
+}
+
+void UnitConverter::query(const QString &text, const QueryToken &token)
 {
     const QStringList list = text.split(" ", Qt::SkipEmptyParts);
 
@@ -28,10 +65,12 @@ void UnitConverter::query(const QString &text)
     }
     else
         return;
-    const auto originalMeasurement = units::measurement_from_string(originalMeasurementStr.toStdString());
-    const auto convertedUnit = units::unit_from_string(convertedUnitStr.toStdString());
+    QString originalUnitStr;
+    const auto originalMeasurement = parseMeasurement(originalMeasurementStr, originalUnitStr);
+    const auto convertedUnit = parseUnit(convertedUnitStr);
+    const Conversion conversion = this->conversion(originalUnitStr, originalMeasurement.units(), convertedUnitStr, convertedUnit);
 
-    if (!originalMeasurement.units().is_convertible(convertedUnit))
+    if (!conversion.isConvertible)
     {
         ResultItem item;
         item.title = "Invalid unit conversion";
@@ -42,7 +81,8 @@ void UnitConverter::query(const QString &text)
     }
     else
     {
-        const QString resultString = QString::number(originalMeasurement.value_as(convertedUnit)) + " " + convertedUnitStr;
+        const double value = conversion.isLinear ? originalMeasurement.value() * conversion.factor : originalMeasurement.value_as(convertedUnit);
+        const QString resultString = QString::number(value) + " " + convertedUnitStr;
 
         ResultItem item;
         item.title = resultString;
@@ -50,13 +90,98 @@ void UnitConverter::query(const QString &text)
         item.iconGlyph = QChar(0xf6af); // Measuring tape.
         item.iconType = IconType::Font;
         item.key = "unit";
-        Action copyAction;
-        copyAction.description = "Copy result";
-        copyAction.handler = [resultString] { QApplication::clipboard()->setText(resultString); };
-        copyAction.shortcut = QKeySequence(Qt::CTRL | Qt::Key_C);
-        item.actions = {copyAction};
         results.append(item);
     }
 
-    emit resultsReady(results, this);
+    emit resultsReady(results, this, token.generation());
+}
+
+/**
+ * Parse a measurement, such as "3m/s" or "100 floz".
+ *
+ * A leading plain number followed by a space or a letter is split off so that
+ * only the unit is parsed, through the unit cache; anything else, such as the
+ * fraction in "1/2 cup", is left to the units library.
+ *
+ * @param text The measurement.
+ * @param unitText Set to the text of the unit when it was split off, cleared otherwise.
+ * @return The measurement.
+ */
+units::precise_measurement UnitConverter::parseMeasurement(const QString &text, QString &unitText)
+{
+    qsizetype length = 0;
+    while (length < text.size() && (text.at(length).isDigit() || text.at(length) == '.' || (length == 0 && (text.at(0) == '-' || text.at(0) == '+'))))
+        ++length;
+
+    bool isNumber = false;
+    const double value = QStringView(text).left(length).toDouble(&isNumber);
+    const bool isUnitNext = length < text.size() && (text.at(length).isSpace() || text.at(length).isLetter());
+    unitText = text.mid(length).trimmed();
+    if (!isNumber || !isUnitNext || unitText.isEmpty() || unitText.front().isDigit() || unitText.front() == 'e' || unitText.front() == 'E')
+    {
+        unitText.clear();
+        return units::measurement_from_string(text.toStdString()); // A fraction, an exponent or an expression.
+    }
+    return {value, parseUnit(unitText)};
+}
+
+/**
+ * Parse a unit, or get it from the cache.
+ *
+ * @param text The unit.
+ * @return The unit; an error unit if it cannot be parsed.
+ */
+units::precise_unit UnitConverter::parseUnit(const QString &text)
+{
+    if (const units::precise_unit *unit = m_units.object(text))
+        return *unit;
+    auto *unit = new units::precise_unit(units::unit_from_string(text.toStdString()));
+    m_units.insert(text, unit);
+    return *unit;
+}
+
+/**
+ * Get how to convert between two units, or get it from the cache.
+ *
+ * @param fromText The text of the unit to convert from; empty if the unit was not parsed on its own, which bypasses the cache.
+ * @param from The unit to convert from.
+ * @param toText The text of the unit to convert to.
+ * @param to The unit to convert to.
+ * @return The conversion.
+ */
+UnitConverter::Conversion UnitConverter::conversion(const QString &fromText, const units::precise_unit &from, const QString &toText,
+                                                    const units::precise_unit &to)
+{
+    if (fromText.isEmpty())
+        return computeConversion(from, to);
+
+    const QPair<QString, QString> key = {fromText, toText};
+    if (const Conversion *conversion = m_conversions.object(key))
+        return *conversion;
+    auto *conversion = new Conversion(computeConversion(from, to));
+    m_conversions.insert(key, conversion);
+    return *conversion;
+}
+
+/**
+ * Work out how to convert between two units.
+ *
+ * A conversion is linear when converting zero gives zero and converting two
+ * gives twice the factor, which rules out offsets and equation units; those
+ * are converted by the units library each time.
+ *
+ * @param from The unit to convert from.
+ * @param to The unit to convert to.
+ * @return The conversion.
+ */
+UnitConverter::Conversion UnitConverter::computeConversion(const units::precise_unit &from, const units::precise_unit &to)
+{
+    Conversion conversion = {from.is_convertible(to), false, 0.0};
+    if (conversion.isConvertible)
+    {
+        conversion.factor = units::convert(1.0, from, to);
+        conversion.isLinear = std::isfinite(conversion.factor) && units::convert(0.0, from, to) == 0.0 &&
+                              units::convert(2.0, from, to) == 2.0 * conversion.factor;
+    }
+    return conversion;
 }
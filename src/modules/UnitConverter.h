@@ -1,5 +1,7 @@
 #pragma once
 
+#include <QCache>
+#include "../../third-party/units/units/units.hpp"
 #include "../common/IModule.h"
 
 class UnitConverter final : public IModule
@@ -11,5 +13,25 @@ public:
 
     [[nodiscard]] QString name() const override { return "Unit Converter"; }
     [[nodiscard]] QChar iconGlyph() const override { return QChar(0xf6af); } // Measuring tape.
-    void query(const QString &text) override;
+    [[nodiscard]] const QVector<Action> &actions(const ResultItem &item) const override;
+    void initialize() override;
+    void query(const QString &text, const QueryToken &token) override;
+
+private:
+    // How to convert between two units; units with an offset or a scale that is not linear, such as degrees Celsius or decibels, have no factor.
+    struct Conversion
+    {
+        bool isConvertible;
+        bool isLinear;
+        double factor;
+    };
+
+    [[nodiscard]] units::precise_measurement parseMeasurement(const QString &text, QString &unitText);
+    [[nodiscard]] units::precise_unit parseUnit(const QString &text);
+    [[nodiscard]] Conversion conversion(const QString &fromText, const units::precise_unit &from, const QString &toText, const units::precise_unit &to);
+    [[nodiscard]] static Conversion computeConversion(const units::precise_unit &from, const units::precise_unit &to);
+
+    QVector<Action> m_resultActions;
+    QCache<QString, units::precise_unit> m_units; // Parsed units, by their text.
+    QCache<QPair<QString, QString>, Conversion> m_conversions; // By the texts of the units, from and to.
 };
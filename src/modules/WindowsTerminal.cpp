@@ -5,6 +5,23 @@
 #include "../utils/ProcessUtils.h"
 
 WindowsTerminal::WindowsTerminal(QObject *parent) : IModule(parent)
+{
+    // The payload of a result is the profile name.
+    Action openAction;
+    openAction.description = "Open";
+    openAction.handler = [](const ResultItem &item) { ProcessUtils::startDetached("wt", {"-p", item.payload.toString()}); };
+    Action openAdminAction;
+    openAdminAction.description = "Open as admin";
+    openAdminAction.iconGlyph = QChar(0xe9e0); // Shield.
+    openAdminAction.handler = [](const ResultItem &item) { ProcessUtils::startDetached("wt", {"-p", item.payload.toString()}, true); };
+    openAdminAction.shortcut = QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_Return);
+    m_profileActions = {openAction, openAdminAction};
+}
+
+/**
+ * Read the profiles from the settings of Windows Terminal.
+ */
+void WindowsTerminal::initialize()
 {
     const QString jsonPath =
         QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + R"(\Packages\Microsoft.WindowsTerminal_8wekyb3d8bbwe\LocalState\settings.json)";
@@ -29,7 +46,13 @@ WindowsTerminal::WindowsTerminal(QObject *parent) : IModule(parent)
     }
 }
 
-void WindowsTerminal::query(const QString &text)
+const QVector<Action> &WindowsTerminal::actions(const ResultItem &item) const
+{
+    Q_UNUSED(item)
+    return m_profileActions;
+}
+
+void WindowsTerminal::query(const QString &text, const QueryToken &token)
 {
     QVector<ResultItem> results;
 
@@ -43,19 +66,11 @@ void WindowsTerminal::query(const QString &text)
             item.iconGlyph = QChar(0xeb8e); // Terminal.
             item.iconType = IconType::Font;
             item.key = "terminal_" + profileName;
-            Action openAction;
-            openAction.description = "Open";
-            openAction.handler = [profileName] { ProcessUtils::startDetached("wt", {"-p", profileName}); };
-            Action openAdminAction;
-            openAdminAction.description = "Open as admin";
-            openAdminAction.iconGlyph = QChar(0xe9e0); // Shield.
-            openAdminAction.handler = [profileName] { ProcessUtils::startDetached("wt", {"-p", profileName}, true); };
-            openAdminAction.shortcut = QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_Return);
-            item.actions = {openAction, openAdminAction};
+            item.payload = profileName;
             item.score = profileName.startsWith(text, Qt::CaseInsensitive) ? 2.0 : 1.0;
             results.append(item);
         }
     }
 
-    emit resultsReady(results, this);
+    emit resultsReady(results, this, token.generation());
 }
@@ -11,8 +11,11 @@ public:
   
     [[nodiscard]] QString name() const override { return "Windows Terminal"; }
     [[nodiscard]] QChar iconGlyph() const override { return QChar(0xeb8e); } // Terminal.
-    void query(const QString& text) override;
+    [[nodiscard]] const QVector<Action> &actions(const ResultItem &item) const override;
+    void initialize() override;
+    void query(const QString& text, const QueryToken& token) override;
 
 private:
     QVector<QString> m_profileNames;
+    QVector<Action> m_profileActions;
 };
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <atomic>
+#include <functional>
+
+/**
+ * @class DirectoryWatcher
+ * @brief Follow the files and directories created, removed and renamed anywhere under a root.
+ *
+ * The notifications are read on a thread of the watcher, with
+ * ReadDirectoryChangesW on Windows and inotify on Linux, and handed over in
+ * batches on that thread.
+ */
+class DirectoryWatcher final
+{
+public:
+    enum class Action
+    {
+        Added,
+        Removed,
+        RenamedOldName,
+        RenamedNewName
+    };
+
+    using Changes = QVector<QPair<Action, QString>>; // The changes, with the paths relative to the root.
+
+    DirectoryWatcher(QString root, std::function<void(const Changes &)> onChanges, std::function<void()> onOverflow);
+    ~DirectoryWatcher();
+
+    DirectoryWatcher(const DirectoryWatcher &) = delete;
+    DirectoryWatcher &operator=(const DirectoryWatcher &) = delete;
+
+    [[nodiscard]] bool start();
+
+private:
+    void run();
+
+    QString m_root;
+    std::function<void(const Changes &)> m_onChanges;
+    std::function<void()> m_onOverflow; // Called when notifications were lost, so that the root must be crawled again.
+    std::atomic<bool> m_isStopping = false;
+    QThread *m_thread = nullptr;
+
+#ifdef Q_OS_WIN
+    void *m_handle = nullptr; // The root, opened for listing.
+#else
+    bool watchTree(const QString &relativePath);
+    void unwatchTree(const QString &relativePath);
+
+    int m_inotify = -1;
+    int m_stopEvent = -1; // An eventfd which wakes up the thread when the watcher stops.
+    QHash<int, QString> m_directories; // The paths of the watched directories relative to the root, by watch descriptor.
+#endif
+};
@@ -0,0 +1,181 @@
+#include "DirectoryWatcher.h"
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <utility>
+
+namespace
+{
+    constexpr uint32_t WATCH_MASK = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR | IN_DONT_FOLLOW | IN_EXCL_UNLINK;
+    constexpr size_t WATCH_BUFFER_SIZE = 64 * 1024;
+
+    QString joinPath(const QString &directory, const QString &name) { return directory.isEmpty() ? name : directory + '/' + name; }
+} // namespace
+
+DirectoryWatcher::DirectoryWatcher(QString root, std::function<void(const Changes &)> onChanges, std::function<void()> onOverflow) :
+    m_root(std::move(root)), m_onChanges(std::move(onChanges)), m_onOverflow(std::move(onOverflow))
+{
+}
+
+DirectoryWatcher::~DirectoryWatcher()
+{
+    m_isStopping = true;
+    if (m_thread)
+    {
+        const uint64_t wake = 1;
+        if (write(m_stopEvent, &wake, sizeof(wake)) < 0)
+            qWarning() << "File index: failed to wake the watcher of" << m_root;
+        m_thread->wait();
+        delete m_thread;
+    }
+    if (m_inotify >= 0)
+        close(m_inotify);
+    if (m_stopEvent >= 0)
+        close(m_stopEvent);
+}
+
+/**
+ * Watch the root and the directories under it, and start the thread waiting for their change notifications.
+ *
+ * inotify does not watch trees, so each directory gets its own watch, added by the thread as it starts; directories
+ * created later are watched as they appear.
+ *
+ * @return True if the root is watched; false if it cannot be.
+ */
+bool DirectoryWatcher::start()
+{
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    m_stopEvent = eventfd(0, EFD_CLOEXEC);
+    if (m_inotify < 0 || m_stopEvent < 0 || inotify_add_watch(m_inotify, QFile::encodeName(m_root).constData(), WATCH_MASK) < 0)
+        return false;
+    m_thread = QThread::create([this] { run(); });
+    m_thread->start();
+    return true;
+}
+
+/**
+ * Hand over the change notifications of the root until the watcher stops. Runs on the thread of the watcher.
+ */
+void DirectoryWatcher::run()
+{
+    watchTree({});
+
+    alignas(inotify_event) char buffer[WATCH_BUFFER_SIZE];
+    while (!m_isStopping)
+    {
+        pollfd descriptors[] = {{m_inotify, POLLIN, 0}, {m_stopEvent, POLLIN, 0}};
+        if (poll(descriptors, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        if (descriptors[1].revents != 0)
+            return;
+
+        Changes changes;
+        ssize_t size;
+        while ((size = read(m_inotify, buffer, sizeof(buffer))) > 0)
+        {
+            for (const char *data = buffer; data < buffer + size;)
+            {
+                const auto *event = reinterpret_cast<const inotify_event *>(data);
+                data += sizeof(inotify_event) + event->len;
+
+                // When the queue overflows, the changes are lost.
+                if (event->mask & IN_Q_OVERFLOW)
+                {
+                    changes.clear();
+                    m_onOverflow();
+                    continue;
+                }
+                if (event->mask & IN_IGNORED)
+                {
+                    m_directories.remove(event->wd);
+                    continue;
+                }
+                const auto directory = m_directories.constFind(event->wd);
+                if (directory == m_directories.cend() || event->len == 0)
+                    continue;
+
+                const QString path = joinPath(directory.value(), QFile::decodeName(event->name));
+                const bool isDirectory = event->mask & IN_ISDIR;
+                if (event->mask & IN_CREATE)
+                    changes.append({Action::Added, path});
+                else if (event->mask & IN_DELETE)
+                    changes.append({Action::Removed, path});
+                else if (event->mask & IN_MOVED_FROM)
+                    changes.append({Action::RenamedOldName, path});
+                else if (event->mask & IN_MOVED_TO)
+                    changes.append({Action::RenamedNewName, path});
+
+                // A directory moved away keeps its watches, which would report its changes under its old path.
+                if (isDirectory && (event->mask & IN_MOVED_FROM))
+                    unwatchTree(path);
+                else if (isDirectory && (event->mask & (IN_CREATE | IN_MOVED_TO)))
+                    watchTree(path);
+            }
+        }
+        if (!changes.isEmpty())
+            m_onChanges(changes);
+    }
+}
+
+/**
+ * Watch a directory and the directories under it, without following links.
+ *
+ * @param relativePath The path of the directory relative to the root; empty for the root.
+ * @return True if the directory itself is watched.
+ */
+bool DirectoryWatcher::watchTree(const QString &relativePath)
+{
+    const QString directory = relativePath.isEmpty() ? m_root : m_root + '/' + relativePath;
+    const auto watch = [this](const QString &path, const QString &relativePath)
+    {
+        const int descriptor = inotify_add_watch(m_inotify, QFile::encodeName(path).constData(), WATCH_MASK);
+        if (descriptor < 0)
+            return false;
+        m_directories.insert(descriptor, relativePath);
+        return true;
+    };
+    if (!watch(directory, relativePath))
+        return false;
+
+    QDirIterator iterator(directory, QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System | QDir::NoSymLinks, QDirIterator::Subdirectories);
+    while (iterator.hasNext() && !m_isStopping)
+    {
+        const QString path = iterator.next();
+        if (!watch(path, joinPath(relativePath, path.mid(directory.size() + 1))) && errno == ENOSPC)
+        {
+            qWarning() << "File index: out of inotify watches under" << m_root << "; raise fs.inotify.max_user_watches";
+            break;
+        }
+    }
+    return true;
+}
+
+/**
+ * Stop watching a directory and the directories under it.
+ *
+ * @param relativePath The path of the directory relative to the root.
+ */
+void DirectoryWatcher::unwatchTree(const QString &relativePath)
+{
+    const QString prefix = relativePath + '/';
+    for (auto iterator = m_directories.begin(); iterator != m_directories.end();)
+    {
+        if (iterator.value() == relativePath || iterator.value().startsWith(prefix))
+        {
+            inotify_rm_watch(m_inotify, iterator.key());
+            iterator = m_directories.erase(iterator);
+        }
+        else
+            ++iterator;
+    }
+}
@@ -0,0 +1,100 @@
+#include "DirectoryWatcher.h"
+#include <optional>
+#include <utility>
+#include <windows.h>
+
+namespace
+{
+    constexpr DWORD WATCH_BUFFER_SIZE = 64 * 1024; // The largest buffer ReadDirectoryChangesW accepts for network drives.
+    constexpr int WATCH_STOP_SLICE = 10; // ms between two attempts to cancel the wait of the watcher.
+
+    std::optional<DirectoryWatcher::Action> actionOf(const DWORD action)
+    {
+        switch (action)
+        {
+        case FILE_ACTION_ADDED:
+            return DirectoryWatcher::Action::Added;
+        case FILE_ACTION_REMOVED:
+            return DirectoryWatcher::Action::Removed;
+        case FILE_ACTION_RENAMED_OLD_NAME:
+            return DirectoryWatcher::Action::RenamedOldName;
+        case FILE_ACTION_RENAMED_NEW_NAME:
+            return DirectoryWatcher::Action::RenamedNewName;
+        default:
+            return std::nullopt;
+        }
+    }
+} // namespace
+
+DirectoryWatcher::DirectoryWatcher(QString root, std::function<void(const Changes &)> onChanges, std::function<void()> onOverflow) :
+    m_root(std::move(root)), m_onChanges(std::move(onChanges)), m_onOverflow(std::move(onOverflow))
+{
+}
+
+DirectoryWatcher::~DirectoryWatcher()
+{
+    // The thread may not be waiting yet when its wait is cancelled, so the cancellation is repeated until it stops.
+    m_isStopping = true;
+    if (m_thread)
+    {
+        do
+            CancelIoEx(m_handle, nullptr);
+        while (!m_thread->wait(WATCH_STOP_SLICE));
+        delete m_thread;
+    }
+    if (m_handle)
+        CloseHandle(m_handle);
+}
+
+/**
+ * Open the root and start the thread waiting for its change notifications.
+ *
+ * @return True if the root is watched; false if it cannot be opened.
+ */
+bool DirectoryWatcher::start()
+{
+    const HANDLE handle = CreateFileW(m_root.toStdWString().c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                      OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        return false;
+    m_handle = handle;
+    m_thread = QThread::create([this] { run(); });
+    m_thread->start();
+    return true;
+}
+
+/**
+ * Hand over the change notifications of the root until the watcher stops. Runs on the thread of the watcher.
+ */
+void DirectoryWatcher::run()
+{
+    QVector<DWORD> buffer(WATCH_BUFFER_SIZE / sizeof(DWORD)); // DWORD-aligned, as ReadDirectoryChangesW requires.
+    while (!m_isStopping)
+    {
+        DWORD size = 0;
+        if (!ReadDirectoryChangesW(m_handle, buffer.data(), WATCH_BUFFER_SIZE, true, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME, &size,
+                                   nullptr, nullptr))
+            return; // Cancelled, or the root is gone.
+
+        // When the buffer overflows, the changes are lost.
+        if (size == 0)
+        {
+            m_onOverflow();
+            continue;
+        }
+
+        Changes changes;
+        const auto *data = reinterpret_cast<const char *>(buffer.constData());
+        for (;;)
+        {
+            const auto *information = reinterpret_cast<const FILE_NOTIFY_INFORMATION *>(data);
+            if (const std::optional<Action> action = actionOf(information->Action))
+                changes.append({*action, QString::fromWCharArray(information->FileName, information->FileNameLength / sizeof(WCHAR))});
+            if (information->NextEntryOffset == 0)
+                break;
+            data += information->NextEntryOffset;
+        }
+        if (!changes.isEmpty())
+            m_onChanges(changes);
+    }
+}
@@ -0,0 +1,186 @@
+#include "EverythingBackend.h"
+#include <QDeadlineTimer>
+#include <algorithm>
+#include <atomic>
+#include <cwchar>
+#include <utility>
+#include "../../../third-party/everything-sdk/include/Everything.h"
+
+namespace
+{
+    constexpr wchar_t WINDOW_CLASS_NAME[] = L"LauncherEverythingReply";
+    constexpr int REPLY_WAIT_SLICE = 5; // ms between two checks of the cancellation.
+    constexpr int REPLY_TIMEOUT = 3000; // ms; Everything is considered gone past it.
+    constexpr qsizetype EXPECTED_RESULT_LENGTH = 64; // Characters of a name and its directory, to size the pool.
+} // namespace
+
+EverythingBackend::EverythingBackend() = default;
+
+EverythingBackend::~EverythingBackend()
+{
+    if (!m_replyThread)
+        return;
+    {
+        const QMutexLocker locker(&m_mutex);
+        if (m_window)
+            PostMessageW(m_window, WM_CLOSE, 0, 0);
+    }
+    m_replyThread->wait();
+    delete m_replyThread;
+}
+
+/**
+ * Start the reply thread and wait until its window exists.
+ */
+void EverythingBackend::initialize()
+{
+    QMutexLocker locker(&m_mutex);
+    m_replyThread = QThread::create([this] { runReplyLoop(); });
+    m_replyThread->start();
+    while (!m_window && m_replyThread->isRunning())
+        m_replied.wait(&m_mutex, REPLY_WAIT_SLICE);
+}
+
+FileSearchResults EverythingBackend::search(const QString &text, const int offset, const int maxResults, const QueryToken &token)
+{
+    FileSearchResults results;
+    HWND window;
+    DWORD replyId;
+    {
+        // Tag each query with its own id, so that a late reply to a cancelled query is ignored.
+        static std::atomic<DWORD> lastReplyId = 0;
+        const QMutexLocker locker(&m_mutex);
+        window = m_window;
+        replyId = m_replyId = std::max<DWORD>(1, ++lastReplyId);
+        m_hasReply = false;
+    }
+    if (!window)
+    {
+        results.status = FileSearchResults::Status::Failed;
+        return results;
+    }
+
+    // The lock is not held while sending, in case Everything replies before the query returns.
+    Everything_SetSearchW(text.toStdWString().c_str());
+    Everything_SetOffset(offset);
+    Everything_SetMax(maxResults);
+    Everything_SetSort(EVERYTHING_SORT_RUN_COUNT_DESCENDING);
+    Everything_SetRequestFlags(EVERYTHING_REQUEST_FILE_NAME | EVERYTHING_REQUEST_PATH | EVERYTHING_REQUEST_RUN_COUNT);
+    Everything_SetReplyWindow(window);
+    Everything_SetReplyID(replyId);
+    const bool isSent = Everything_QueryW(false);
+
+    QMutexLocker locker(&m_mutex);
+    if (!isSent)
+    {
+        m_replyId = 0;
+        results.status = Everything_GetLastError() == EVERYTHING_ERROR_IPC ? FileSearchResults::Status::Unavailable : FileSearchResults::Status::Failed;
+        return results;
+    }
+    const QDeadlineTimer deadline(REPLY_TIMEOUT);
+    while (!m_hasReply)
+    {
+        if (token.isCancelled() || deadline.hasExpired())
+        {
+            m_replyId = 0;
+            results.status = token.isCancelled() ? FileSearchResults::Status::Cancelled : FileSearchResults::Status::Unavailable;
+            return results;
+        }
+        m_replied.wait(&m_mutex, REPLY_WAIT_SLICE);
+    }
+    m_replyId = 0;
+    return std::move(m_reply);
+}
+
+void EverythingBackend::recordRun(const QString &fullPath) { Everything_IncRunCountFromFileNameW(fullPath.toStdWString().c_str()); }
+
+/**
+ * Create the message-only window receiving the replies and dispatch its messages until it is closed. Runs on the reply thread.
+ */
+void EverythingBackend::runReplyLoop()
+{
+    WNDCLASSEXW windowClass = {};
+    windowClass.cbSize = sizeof(windowClass);
+    windowClass.lpfnWndProc = windowProc;
+    windowClass.hInstance = GetModuleHandleW(nullptr);
+    windowClass.lpszClassName = WINDOW_CLASS_NAME;
+    RegisterClassExW(&windowClass); // Fails harmlessly when a previous backend registered it.
+
+    const HWND window = CreateWindowExW(0, WINDOW_CLASS_NAME, L"", 0, 0, 0, 0, 0, HWND_MESSAGE, nullptr, windowClass.hInstance, nullptr);
+    if (!window)
+        return;
+    SetWindowLongPtrW(window, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
+    {
+        const QMutexLocker locker(&m_mutex);
+        m_window = window;
+        m_replied.wakeAll();
+    }
+
+    MSG message;
+    while (GetMessageW(&message, nullptr, 0, 0) > 0)
+        DispatchMessageW(&message);
+
+    const QMutexLocker locker(&m_mutex);
+    m_window = nullptr;
+}
+
+LRESULT CALLBACK EverythingBackend::windowProc(const HWND window, const UINT message, const WPARAM wParam, const LPARAM lParam)
+{
+    auto *backend = reinterpret_cast<EverythingBackend *>(GetWindowLongPtrW(window, GWLP_USERDATA));
+    switch (message)
+    {
+    case WM_COPYDATA:
+        if (backend && backend->onReply(message, wParam, lParam))
+            return TRUE;
+        break;
+    case WM_CLOSE:
+        DestroyWindow(window);
+        return 0;
+    case WM_DESTROY:
+        PostQuitMessage(0);
+        return 0;
+    default:
+        break;
+    }
+    return DefWindowProcW(window, message, wParam, lParam);
+}
+
+/**
+ * Take the reply to the query waited for, if the message is that reply. Runs on the reply thread.
+ *
+ * @return True if the message was the reply.
+ */
+bool EverythingBackend::onReply(const UINT message, const WPARAM wParam, const LPARAM lParam)
+{
+    const QMutexLocker locker(&m_mutex);
+    if (m_replyId == 0 || !Everything_IsQueryReply(message, wParam, lParam, m_replyId))
+        return false;
+    m_reply = decodeResults();
+    m_hasReply = true;
+    m_replied.wakeAll();
+    return true;
+}
+
+/**
+ * Decode the results of the last reply in one pass.
+ *
+ * @return The results.
+ */
+FileSearchResults EverythingBackend::decodeResults()
+{
+    FileSearchResults results;
+    results.totalCount = Everything_GetTotResults();
+    const DWORD numResults = Everything_GetNumResults();
+    results.entries.reserve(numResults);
+    results.pool.reserve(numResults * EXPECTED_RESULT_LENGTH);
+    for (DWORD resultIndex = 0; resultIndex < numResults; ++resultIndex)
+    {
+        const wchar_t *fileName = Everything_GetResultFileNameW(resultIndex);
+        const wchar_t *path = Everything_GetResultPathW(resultIndex);
+        if (!fileName || !path)
+            continue;
+        results.append(QStringView(fileName, static_cast<qsizetype>(std::wcslen(fileName))), QStringView(path, static_cast<qsizetype>(std::wcslen(path))),
+                       Everything_GetResultRunCount(resultIndex));
+    }
+    return results;
+}
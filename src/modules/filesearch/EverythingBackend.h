@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+#include <windows.h>
+#include "FileSearchBackend.h"
+
+/**
+ * @class EverythingBackend
+ * @brief Search files with Everything, without blocking on its IPC.
+ *
+ * Queries are sent without waiting; Everything replies to a message-only window
+ * owned by a dedicated thread, which decodes the reply while the searching
+ * thread waits for it, giving up as soon as the query is cancelled.
+ */
+class EverythingBackend final : public FileSearchBackend
+{
+public:
+    EverythingBackend();
+    ~EverythingBackend() override;
+
+    EverythingBackend(const EverythingBackend &) = delete;
+    EverythingBackend &operator=(const EverythingBackend &) = delete;
+
+    void initialize() override;
+    [[nodiscard]] FileSearchResults search(const QString &text, int offset, int maxResults, const QueryToken &token) override;
+    void recordRun(const QString &fullPath) override;
+    [[nodiscard]] QString unavailableMessage() const override { return "Everything is not running"; }
+
+private:
+    static LRESULT CALLBACK windowProc(HWND window, UINT message, WPARAM wParam, LPARAM lParam);
+
+    void runReplyLoop();
+    bool onReply(UINT message, WPARAM wParam, LPARAM lParam);
+
+    [[nodiscard]] static FileSearchResults decodeResults();
+
+    QThread *m_replyThread = nullptr;
+    HWND m_window = nullptr; // The message-only window receiving the replies; set once the reply thread is running.
+
+    QMutex m_mutex;
+    QWaitCondition m_replied;
+    DWORD m_replyId = 0; // The id of the query waited for; 0 when none is.
+    bool m_hasReply = false;
+    FileSearchResults m_reply;
+};
@@ -0,0 +1,626 @@
+#include "FileIndexBackend.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSaveFile>
+#include <QSet>
+#include <QThread>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <utility>
+
+namespace
+{
+    // The index file is a binary image of the name table and its trigram index; the trigram index is mapped, the rest is copied.
+    constexpr quint32 INDEX_MAGIC = 0x5849464C; // "LFIX".
+    constexpr quint32 INDEX_VERSION = 1;
+
+    struct IndexHeader
+    {
+        quint32 magic;
+        quint32 version;
+        char rootsHash[20]; // The SHA-1 of the roots, so that the index is crawled again when they change.
+        quint32 directoryCount;
+        quint32 entryCount;
+        quint32 reserved;
+        quint64 namesOffset; // The names, in UTF-16.
+        quint64 namesLength; // In UTF-16 code units.
+        quint64 pathsOffset; // The paths of the directories, in UTF-16.
+        quint64 pathsLength;
+        quint64 directoriesOffset;
+        quint64 entriesOffset;
+        quint64 trigramsOffset; // The frozen TrigramIndex.
+        quint64 trigramsSize;
+    };
+
+    struct IndexDirectory
+    {
+        quint32 path, pathLength;
+    };
+
+    constexpr quint16 ENTRY_DIRECTORY = 0x1;
+    constexpr quint16 ENTRY_REMOVED = 0x2;
+
+    constexpr qsizetype CANCELLATION_CHECK_INTERVAL = 16384; // Entries scanned between two checks of the cancellation.
+
+    QString joinPath(const QString &directory, const QString &name)
+    {
+        return directory.endsWith(QDir::separator()) ? directory + name : directory + QDir::separator() + name;
+    }
+
+    QByteArray hashOf(const QStringList &roots) { return QCryptographicHash::hash(roots.join('\n').toUtf8(), QCryptographicHash::Sha1); }
+} // namespace
+
+FileIndexBackend::FileIndexBackend(QStringList roots, QString indexPath) : m_roots(std::move(roots)), m_indexPath(std::move(indexPath))
+{
+    for (QString &root : m_roots)
+        root = QDir::toNativeSeparators(QDir::cleanPath(root));
+    m_crawler.setMaxThreadCount(1);
+}
+
+FileIndexBackend::~FileIndexBackend()
+{
+    stop();
+    m_watchers.clear(); // Each watcher waits for its thread.
+    m_crawler.waitForDone();
+
+    if (m_isModified && !save())
+        qWarning() << "File index: failed to save";
+}
+
+/**
+ * Load the saved index, then follow the changes of the roots and crawl them on the crawler thread.
+ *
+ * The crawl does not hold up the module: until it is done, the saved index, or an empty one on the first run, is searched.
+ */
+void FileIndexBackend::initialize()
+{
+    QElapsedTimer timer;
+    timer.start();
+    if (load())
+        qInfo() << "File index: loaded" << m_index.entries.size() << "entries in" << timer.elapsed() << "ms";
+    if (m_isStopping)
+        return;
+
+    // Started before the crawl, so that the changes made during the crawl are replayed on its result.
+    watchRoots();
+    queueRecrawl();
+}
+
+/**
+ * Abort the crawls, running and queued; the watchers are stopped by the destructor.
+ */
+void FileIndexBackend::stop()
+{
+    m_isStopping = true;
+    m_crawler.clear();
+}
+
+FileSearchResults FileIndexBackend::search(const QString &text, const int offset, const int maxResults, const QueryToken &token)
+{
+    FileSearchResults results;
+    const QStringList terms = foldCase(text).split(' ', Qt::SkipEmptyParts);
+    if (terms.isEmpty())
+        return results;
+
+    const QReadLocker locker(&m_lock);
+    const Index &index = m_index;
+
+    // As in Everything, the words separated by spaces must all appear in the name. The longest word narrows the
+    // candidates through the trigram index. When every word is shorter than a trigram, the index only knows the 1 and 2
+    // character prefixes of the words of the names, so the longest word must also start a word of the name: the first
+    // keystrokes look up a prefix instead of scanning every name.
+    const QString &longestTerm = *std::max_element(terms.cbegin(), terms.cend(), [](const QString &left, const QString &right) { return left.size() < right.size(); });
+    const QVector<quint32> candidates = index.trigrams.candidates(longestTerm);
+
+    QVector<quint32> matches;
+    for (qsizetype candidateIndex = 0; candidateIndex < candidates.size(); ++candidateIndex)
+    {
+        if (candidateIndex % CANCELLATION_CHECK_INTERVAL == 0 && token.isCancelled())
+        {
+            results.status = FileSearchResults::Status::Cancelled;
+            return results;
+        }
+        const quint32 id = candidates.at(candidateIndex);
+        const Entry &entry = index.entries.at(id);
+        if (entry.flags & ENTRY_REMOVED)
+            continue;
+        const QStringView name = QStringView(index.foldedNames).mid(entry.name, entry.nameLength);
+        if (std::all_of(terms.cbegin(), terms.cend(), [name](const QString &term) { return name.contains(term); }))
+            matches.append(id);
+    }
+
+    // Ties keep the crawl order, so that the pages of a query never overlap.
+    const auto byRunCount = [&index](const quint32 left, const quint32 right)
+    { return index.entries.at(left).runCount != index.entries.at(right).runCount ? index.entries.at(left).runCount > index.entries.at(right).runCount : left < right; };
+    const qsizetype first = std::clamp<qsizetype>(offset, 0, matches.size());
+    const qsizetype last = std::min<qsizetype>(first + std::max(0, maxResults), matches.size());
+    std::partial_sort(matches.begin(), matches.begin() + last, matches.end(), byRunCount);
+
+    results.totalCount = static_cast<quint32>(matches.size());
+    results.entries.reserve(last - first);
+    for (qsizetype matchIndex = first; matchIndex < last; ++matchIndex)
+    {
+        const Entry &entry = index.entries.at(matches.at(matchIndex));
+        results.append(QStringView(index.names).mid(entry.name, entry.nameLength), index.directories.at(entry.parent), entry.runCount);
+    }
+    return results;
+}
+
+void FileIndexBackend::recordRun(const QString &fullPath)
+{
+    const QWriteLocker locker(&m_lock);
+    const QString key = foldCase(QDir::toNativeSeparators(fullPath));
+    const quint32 runCount = ++m_runCounts[key];
+    if (const qsizetype id = findEntry(m_index, fullPath); id >= 0)
+        m_index.entries[id].runCount = runCount;
+    m_isModified = true;
+}
+
+/**
+ * Crawl the roots into a new index and swap it in, then save it. Runs on a worker thread; searches go on meanwhile.
+ */
+void FileIndexBackend::recrawl()
+{
+    m_isRecrawlQueued = false;
+    {
+        const QWriteLocker locker(&m_lock);
+        m_isCrawling = true;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    Index index;
+    addListings(index, crawl(m_roots, m_isStopping));
+    if (m_isStopping)
+        return;
+    const qsizetype entryCount = index.entries.size();
+
+    QVector<QPair<QString, Changes>> deferredChanges;
+    {
+        const QWriteLocker locker(&m_lock);
+        for (auto iterator = m_runCounts.cbegin(); iterator != m_runCounts.cend(); ++iterator)
+            if (const qsizetype id = findEntry(index, iterator.key()); id >= 0)
+                index.entries[id].runCount = iterator.value();
+        m_index = std::move(index);
+        m_indexFile.close(); // The previous index, which may have been mapped from it, is gone.
+        m_isModified = true;
+        m_isCrawling = false;
+        deferredChanges.swap(m_deferredChanges);
+    }
+    for (const auto &[root, changes] : std::as_const(deferredChanges))
+        applyChanges(root, changes);
+    qInfo() << "File index: crawled" << entryCount << "entries in" << timer.elapsed() << "ms";
+
+    if (!save())
+        qWarning() << "File index: failed to save";
+}
+
+/**
+ * Queue a crawl of the roots on the crawler thread, unless one is queued already.
+ */
+void FileIndexBackend::queueRecrawl()
+{
+    if (!m_isRecrawlQueued.exchange(true))
+        m_crawler.start([this] { recrawl(); });
+}
+
+/**
+ * Start following the changes of each root. When notifications are lost, the roots are crawled again.
+ */
+void FileIndexBackend::watchRoots()
+{
+    for (const QString &root : std::as_const(m_roots))
+    {
+        const auto onChanges = [this, root](const Changes &changes) { applyChanges(root, changes); };
+        auto watcher = std::make_unique<DirectoryWatcher>(root, onChanges, [this] { queueRecrawl(); });
+        if (!watcher->start())
+        {
+            qWarning() << "File index: failed to watch" << root;
+            continue;
+        }
+        m_watchers.push_back(std::move(watcher));
+    }
+}
+
+/**
+ * Apply change notifications to the index.
+ *
+ * @param root The root the changes happened under.
+ * @param changes The changes.
+ */
+void FileIndexBackend::applyChanges(const QString &root, const Changes &changes)
+{
+    {
+        const QWriteLocker locker(&m_lock);
+        if (m_isCrawling)
+            m_deferredChanges.append({root, changes});
+    }
+
+    for (const auto &[action, relativePath] : changes)
+    {
+        const QString fullPath = joinPath(root, relativePath);
+        const QString directory = fullPath.left(fullPath.lastIndexOf(QDir::separator()));
+        const QString name = fullPath.mid(directory.size() + 1);
+        if (action == DirectoryWatcher::Action::Removed || action == DirectoryWatcher::Action::RenamedOldName)
+        {
+            const QWriteLocker locker(&m_lock);
+            if (const qsizetype id = findEntry(m_index, fullPath); id >= 0)
+            {
+                if (m_index.entries.at(id).flags & ENTRY_DIRECTORY)
+                    removeTree(m_index, fullPath);
+                removeEntry(m_index, static_cast<quint32>(id));
+                m_isModified = true;
+            }
+        }
+        else
+        {
+            const QFileInfo fileInfo(fullPath);
+            if (!fileInfo.exists() && !fileInfo.isSymLink())
+                continue; // Removed meanwhile.
+            const bool isDirectory = fileInfo.isDir() && !fileInfo.isSymLink() && !fileInfo.isJunction();
+            const QVector<Listing> listings = isDirectory ? crawl({fullPath}, m_isStopping) : QVector<Listing>(); // A moved directory arrives with its content.
+
+            const QWriteLocker locker(&m_lock);
+            if (findEntry(m_index, fullPath) >= 0)
+                continue;
+            addEntry(m_index, name, directoryIdOf(m_index, directory), isDirectory);
+            addListings(m_index, listings);
+            m_isModified = true;
+        }
+    }
+}
+
+/**
+ * Load the saved index, if it was crawled from the current roots.
+ *
+ * The names are copied, and the trigram index is mapped from the file.
+ *
+ * @return True if the index was loaded; false if the roots must be crawled.
+ */
+bool FileIndexBackend::load()
+{
+    m_indexFile.setFileName(m_indexPath);
+    if (!m_indexFile.open(QIODevice::ReadOnly))
+        return false;
+
+    const qint64 size = m_indexFile.size();
+    const uchar *data = m_indexFile.map(0, size);
+    IndexHeader header;
+    const auto fail = [this]
+    {
+        m_index = {};
+        m_indexFile.close(); // Also unmaps the file.
+        return false;
+    };
+    if (!data || size < static_cast<qint64>(sizeof(header)))
+        return fail();
+    std::memcpy(&header, data, sizeof(header));
+
+    const auto fits = [size](const quint64 offset, const quint64 bytes, const quint64 alignment)
+    { return offset % alignment == 0 && offset <= static_cast<quint64>(size) && bytes <= static_cast<quint64>(size) - offset; };
+    if (header.magic != INDEX_MAGIC || header.version != INDEX_VERSION || hashOf(m_roots) != QByteArray(header.rootsHash, sizeof(header.rootsHash)) ||
+        !fits(header.namesOffset, header.namesLength * sizeof(QChar), alignof(QChar)) || !fits(header.pathsOffset, header.pathsLength * sizeof(QChar), alignof(QChar)) ||
+        !fits(header.directoriesOffset, header.directoryCount * sizeof(IndexDirectory), alignof(IndexDirectory)) ||
+        !fits(header.entriesOffset, header.entryCount * sizeof(Entry), alignof(Entry)) || !fits(header.trigramsOffset, header.trigramsSize, alignof(quint64)))
+        return fail();
+
+    m_index.names = QString(reinterpret_cast<const QChar *>(data + header.namesOffset), static_cast<qsizetype>(header.namesLength));
+    m_index.foldedNames = foldCase(m_index.names);
+
+    const auto *paths = reinterpret_cast<const QChar *>(data + header.pathsOffset);
+    const auto *directories = reinterpret_cast<const IndexDirectory *>(data + header.directoriesOffset);
+    m_index.directories.reserve(header.directoryCount);
+    for (quint32 directoryId = 0; directoryId < header.directoryCount; ++directoryId)
+    {
+        const IndexDirectory &directory = directories[directoryId];
+        if (static_cast<quint64>(directory.path) + directory.pathLength > header.pathsLength)
+            return fail();
+        m_index.directories.append(QString(paths + directory.path, directory.pathLength));
+        m_index.directoryIds.insert(foldCase(m_index.directories.last()), directoryId);
+    }
+
+    const auto *entries = reinterpret_cast<const Entry *>(data + header.entriesOffset);
+    m_index.entries = QVector<Entry>(entries, entries + header.entryCount);
+    // The entries and the trigram ids are used as indexes by the searches, so a corrupted index is crawled again.
+    const bool areEntriesValid = std::all_of(m_index.entries.cbegin(), m_index.entries.cend(), [&header](const Entry &entry)
+    { return static_cast<quint64>(entry.name) + entry.nameLength <= header.namesLength && entry.parent < header.directoryCount; });
+    if (!areEntriesValid || !m_index.trigrams.loadFrozen(data + header.trigramsOffset, static_cast<qsizetype>(header.trigramsSize), header.entryCount))
+    {
+        qWarning() << "File index: the saved index is corrupted, crawling again";
+        return fail();
+    }
+
+    for (qsizetype id = 0; id < m_index.entries.size(); ++id)
+        if (const Entry &entry = m_index.entries.at(id); entry.runCount > 0 && !(entry.flags & ENTRY_REMOVED))
+            m_runCounts.insert(foldCase(pathOf(m_index, static_cast<quint32>(id))), entry.runCount);
+    return true;
+}
+
+/**
+ * Write the index next to the module configuration.
+ *
+ * @return True if the index was written; false otherwise.
+ */
+bool FileIndexBackend::save()
+{
+    QSaveFile file(m_indexPath);
+    {
+        const QReadLocker locker(&m_lock);
+        QString paths;
+        QVector<IndexDirectory> directories;
+        directories.reserve(m_index.directories.size());
+        for (const QString &directory : std::as_const(m_index.directories))
+        {
+            directories.append({static_cast<quint32>(paths.size()), static_cast<quint32>(directory.size())});
+            paths.append(directory);
+        }
+        const QByteArray trigrams = m_index.trigrams.freeze();
+
+        // Lay out the sections after the header, each aligned to 8 bytes.
+        IndexHeader header = {};
+        header.magic = INDEX_MAGIC;
+        header.version = INDEX_VERSION;
+        const QByteArray rootsHash = hashOf(m_roots);
+        std::memcpy(header.rootsHash, rootsHash.constData(), sizeof(header.rootsHash));
+        header.directoryCount = static_cast<quint32>(directories.size());
+        header.entryCount = static_cast<quint32>(m_index.entries.size());
+        quint64 end = sizeof(header);
+        const auto allocate = [&end](const quint64 bytes)
+        {
+            const quint64 offset = (end + 7) & ~quint64(7);
+            end = offset + bytes;
+            return offset;
+        };
+        header.namesLength = m_index.names.size();
+        header.namesOffset = allocate(m_index.names.size() * sizeof(QChar));
+        header.pathsLength = paths.size();
+        header.pathsOffset = allocate(paths.size() * sizeof(QChar));
+        header.directoriesOffset = allocate(directories.size() * sizeof(IndexDirectory));
+        header.entriesOffset = allocate(m_index.entries.size() * sizeof(Entry));
+        header.trigramsSize = trigrams.size();
+        header.trigramsOffset = allocate(trigrams.size());
+
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+        const auto writeSection = [&file](const quint64 offset, const void *section, const quint64 bytes)
+        {
+            file.write(QByteArray(static_cast<qsizetype>(offset - file.pos()), '\0'));
+            file.write(static_cast<const char *>(section), static_cast<qint64>(bytes));
+        };
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        writeSection(header.namesOffset, m_index.names.constData(), m_index.names.size() * sizeof(QChar));
+        writeSection(header.pathsOffset, paths.constData(), paths.size() * sizeof(QChar));
+        writeSection(header.directoriesOffset, directories.constData(), directories.size() * sizeof(IndexDirectory));
+        writeSection(header.entriesOffset, m_index.entries.constData(), m_index.entries.size() * sizeof(Entry));
+        writeSection(header.trigramsOffset, trigrams.constData(), trigrams.size());
+    }
+
+    // The file can only be replaced once it is no longer mapped. It is only still mapped when the backend is destroyed,
+    // as a crawl replaces the index loaded from it.
+    const QWriteLocker locker(&m_lock);
+    if (m_indexFile.isOpen())
+    {
+        m_index = {};
+        m_indexFile.close();
+    }
+    if (!file.commit())
+        return false;
+    m_isModified = false;
+    return true;
+}
+
+/**
+ * List the roots and all directories under them, in parallel.
+ *
+ * Symbolic links and junctions are listed but not followed.
+ *
+ * @param roots The full paths of the roots.
+ * @param isStopping Set to stop early, leaving the listings incomplete.
+ * @return The listings, in no particular order.
+ */
+QVector<FileIndexBackend::Listing> FileIndexBackend::crawl(const QStringList &roots, const std::atomic<bool> &isStopping)
+{
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(std::max(2, QThread::idealThreadCount()));
+    QMutex mutex;
+    QVector<Listing> listings;
+
+    std::function<void(const QString &)> visit = [&](const QString &directory)
+    {
+        if (isStopping)
+            return;
+        Listing listing = listDirectory(directory);
+        for (qsizetype childIndex = 0; childIndex < listing.names.size(); ++childIndex)
+            if (listing.isDirectory.at(childIndex))
+                threadPool.start([&visit, path = joinPath(directory, listing.names.at(childIndex))] { visit(path); });
+        const QMutexLocker locker(&mutex);
+        listings.append(std::move(listing));
+    };
+    for (const QString &root : roots)
+        threadPool.start([&visit, root] { visit(root); });
+    threadPool.waitForDone();
+    return listings;
+}
+
+/**
+ * List the entries of a directory.
+ *
+ * @param directory The full path of the directory.
+ * @return The listing.
+ */
+FileIndexBackend::Listing FileIndexBackend::listDirectory(const QString &directory)
+{
+    Listing listing;
+    listing.directory = directory;
+    QDirIterator iterator(directory, QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System);
+    while (iterator.hasNext())
+    {
+        iterator.next();
+        const QFileInfo fileInfo = iterator.fileInfo();
+        listing.names.append(iterator.fileName());
+        listing.isDirectory.append(fileInfo.isDir() && !fileInfo.isSymLink() && !fileInfo.isJunction());
+    }
+    return listing;
+}
+
+/**
+ * Add the listed entries to an index.
+ *
+ * @param index The index.
+ * @param listings The listings of the directories.
+ */
+void FileIndexBackend::addListings(Index &index, const QVector<Listing> &listings)
+{
+    for (const Listing &listing : listings)
+    {
+        const quint32 parent = directoryIdOf(index, listing.directory);
+        for (qsizetype childIndex = 0; childIndex < listing.names.size(); ++childIndex)
+            addEntry(index, listing.names.at(childIndex), parent, listing.isDirectory.at(childIndex));
+    }
+}
+
+/**
+ * Add an entry to an index.
+ *
+ * @param index The index.
+ * @param name The name of the file or the directory.
+ * @param parent The id of the directory holding it.
+ * @param isDirectory Whether the entry is a directory.
+ * @return The id of the entry.
+ */
+quint32 FileIndexBackend::addEntry(Index &index, const QString &name, const quint32 parent, const bool isDirectory)
+{
+    const auto id = static_cast<quint32>(index.entries.size());
+    const auto nameLength = static_cast<quint16>(std::min<qsizetype>(name.size(), std::numeric_limits<quint16>::max()));
+    index.entries.append({static_cast<quint32>(index.names.size()), nameLength, isDirectory ? ENTRY_DIRECTORY : quint16(0), parent, 0});
+    index.names.append(QStringView(name).left(nameLength));
+    index.foldedNames.append(foldCase(QStringView(name).left(nameLength)));
+    index.trigrams.insert(id, {name});
+    return id;
+}
+
+/**
+ * Remove an entry from an index. Its id stays allocated.
+ *
+ * @param index The index.
+ * @param id The id of the entry.
+ */
+void FileIndexBackend::removeEntry(Index &index, const quint32 id)
+{
+    Entry &entry = index.entries[id];
+    if (entry.flags & ENTRY_REMOVED)
+        return;
+    entry.flags |= ENTRY_REMOVED;
+    index.trigrams.remove(id, {index.names.mid(entry.name, entry.nameLength)});
+}
+
+/**
+ * Remove everything under a directory from an index.
+ *
+ * @param index The index.
+ * @param directory The full path of the directory.
+ */
+void FileIndexBackend::removeTree(Index &index, const QString &directory)
+{
+    const QString prefix = foldCase(directory);
+    QSet<quint32> removedDirectories;
+    for (auto iterator = index.directoryIds.begin(); iterator != index.directoryIds.end();)
+    {
+        if (iterator.key() == prefix || (iterator.key().startsWith(prefix) && iterator.key().at(prefix.size()) == QDir::separator()))
+        {
+            removedDirectories.insert(iterator.value());
+            iterator = index.directoryIds.erase(iterator);
+        }
+        else
+            ++iterator;
+    }
+    if (removedDirectories.isEmpty())
+        return;
+    for (qsizetype id = 0; id < index.entries.size(); ++id)
+        if (removedDirectories.contains(index.entries.at(id).parent))
+            removeEntry(index, static_cast<quint32>(id));
+}
+
+/**
+ * Get the id of a directory in an index, adding it if needed.
+ *
+ * @param index The index.
+ * @param directory The full path of the directory.
+ * @return The id of the directory.
+ */
+quint32 FileIndexBackend::directoryIdOf(Index &index, const QString &directory)
+{
+    const QString key = foldCase(directory);
+    if (const auto iterator = index.directoryIds.constFind(key); iterator != index.directoryIds.cend())
+        return iterator.value();
+    const auto id = static_cast<quint32>(index.directories.size());
+    index.directories.append(directory);
+    index.directoryIds.insert(key, id);
+    return id;
+}
+
+/**
+ * Find the entry of a path in an index.
+ *
+ * @param index The index.
+ * @param fullPath The full path of the file or the directory, in any case.
+ * @return The id of the entry; -1 if it is not in the index.
+ */
+qsizetype FileIndexBackend::findEntry(const Index &index, const QString &fullPath)
+{
+    const QString path = foldCase(QDir::toNativeSeparators(fullPath));
+    const qsizetype separator = path.lastIndexOf(QDir::separator());
+    const auto directory = index.directoryIds.constFind(path.left(separator));
+    if (separator < 0 || directory == index.directoryIds.cend())
+        return -1;
+
+    const QStringView name = QStringView(path).mid(separator + 1);
+    const auto matches = [&index, &directory, name](const quint32 id)
+    {
+        const Entry &entry = index.entries.at(id);
+        return entry.parent == directory.value() && !(entry.flags & ENTRY_REMOVED) && QStringView(index.foldedNames).mid(entry.name, entry.nameLength) == name;
+    };
+    if (name.size() >= 3)
+    {
+        for (const quint32 id : index.trigrams.candidates(name.toString()))
+            if (matches(id))
+                return id;
+        return -1;
+    }
+    for (qsizetype id = 0; id < index.entries.size(); ++id)
+        if (matches(static_cast<quint32>(id)))
+            return id;
+    return -1;
+}
+
+/**
+ * Get the full path of an entry.
+ *
+ * @param index The index.
+ * @param id The id of the entry.
+ * @return The full path.
+ */
+QString FileIndexBackend::pathOf(const Index &index, const quint32 id)
+{
+    const Entry &entry = index.entries.at(id);
+    return joinPath(index.directories.at(entry.parent), index.names.mid(entry.name, entry.nameLength));
+}
+
+/**
+ * Lower the case of a text character by character, so that the result has the same length.
+ *
+ * @param text The text.
+ * @return The text in lower case.
+ */
+QString FileIndexBackend::foldCase(const QStringView text)
+{
+    QString folded(text.size(), Qt::Uninitialized);
+    std::transform(text.begin(), text.end(), folded.begin(), [](const QChar character) { return character.toLower(); });
+    return folded;
+}
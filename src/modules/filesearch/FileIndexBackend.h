@@ -0,0 +1,106 @@
+#pragma once
+
+#include <QFile>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QStringList>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "../../utils/TrigramIndex.h"
+#include "DirectoryWatcher.h"
+#include "FileSearchBackend.h"
+
+/**
+ * @class FileIndexBackend
+ * @brief Search files by name with a built-in index, standing in for Everything.
+ *
+ * The configured roots are crawled in parallel into a compact name table with
+ * a trigram index, kept up to date from the change notifications of each root,
+ * and saved next to the module configuration. At startup the saved index is
+ * searched at once while a fresh crawl catches up with the changes made while
+ * the launcher was not running; on the first run, the index is empty until the
+ * first crawl is done.
+ */
+class FileIndexBackend final : public FileSearchBackend
+{
+public:
+    FileIndexBackend(QStringList roots, QString indexPath);
+    ~FileIndexBackend() override;
+
+    FileIndexBackend(const FileIndexBackend &) = delete;
+    FileIndexBackend &operator=(const FileIndexBackend &) = delete;
+
+    void initialize() override;
+    void stop() override;
+    [[nodiscard]] FileSearchResults search(const QString &text, int offset, int maxResults, const QueryToken &token) override;
+    void recordRun(const QString &fullPath) override;
+    [[nodiscard]] QString unavailableMessage() const override { return "The file index is unavailable"; }
+
+private:
+    // Names are stored as an offset and a length in the names of the index.
+    struct Entry
+    {
+        quint32 name;
+        quint16 nameLength;
+        quint16 flags;
+        quint32 parent; // The id of the directory holding the entry.
+        quint32 runCount;
+    };
+
+    struct Index
+    {
+        QStringList directories; // The full paths of the directories, by id.
+        QHash<QString, quint32> directoryIds; // By lowercased path.
+        QString names;
+        QString foldedNames; // The names in lower case, at the same offsets.
+        QVector<Entry> entries; // Removed entries are kept, so that the ids in the trigram index stay valid.
+        TrigramIndex trigrams;
+    };
+
+    // The entries of a directory, as listed by the crawl.
+    struct Listing
+    {
+        QString directory;
+        QStringList names;
+        QVector<bool> isDirectory;
+    };
+
+    using Changes = DirectoryWatcher::Changes;
+
+    void recrawl();
+    void queueRecrawl();
+    void watchRoots();
+    void applyChanges(const QString &root, const Changes &changes);
+
+    [[nodiscard]] bool load();
+    [[nodiscard]] bool save();
+
+    [[nodiscard]] static QVector<Listing> crawl(const QStringList &roots, const std::atomic<bool> &isStopping);
+    [[nodiscard]] static Listing listDirectory(const QString &directory);
+    static void addListings(Index &index, const QVector<Listing> &listings);
+    static quint32 addEntry(Index &index, const QString &name, quint32 parent, bool isDirectory);
+    static void removeEntry(Index &index, quint32 id);
+    static void removeTree(Index &index, const QString &directory);
+    [[nodiscard]] static quint32 directoryIdOf(Index &index, const QString &directory);
+    [[nodiscard]] static qsizetype findEntry(const Index &index, const QString &fullPath);
+    [[nodiscard]] static QString pathOf(const Index &index, quint32 id);
+    [[nodiscard]] static QString foldCase(QStringView text);
+
+    QStringList m_roots;
+    QString m_indexPath;
+
+    QReadWriteLock m_lock; // Guards the index and the run counts.
+    Index m_index;
+    QHash<QString, quint32> m_runCounts; // By lowercased full path, so that they survive a new crawl.
+    bool m_isModified = false;
+    bool m_isCrawling = false;
+    QVector<QPair<QString, Changes>> m_deferredChanges; // The changes made during a crawl, replayed on its result.
+
+    QFile m_indexFile; // Mapped while the trigram index loaded from it is in use.
+    std::atomic<bool> m_isStopping = false;
+    std::atomic<bool> m_isRecrawlQueued = false;
+    std::vector<std::unique_ptr<DirectoryWatcher>> m_watchers;
+    QThreadPool m_crawler; // A single thread, for the crawls.
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include "../../common/QueryToken.h"
+
+/**
+ * @struct FileSearchResults
+ * @brief Hold the results of a file search, decoded in one pass into a compact buffer.
+ *
+ * The names and the directories of all results share one string pool, so that
+ * a page of results costs two allocations however many rows it holds.
+ */
+struct FileSearchResults
+{
+    enum class Status
+    {
+        Ok,
+        Unavailable, // The backend cannot answer, e.g. Everything is not running.
+        Failed,
+        Cancelled
+    };
+
+    // Offsets into the pool; Windows paths never exceed 32767 characters.
+    struct Entry
+    {
+        quint32 name, directory;
+        quint16 nameLength, directoryLength;
+        quint32 runCount;
+    };
+
+    Status status = Status::Ok;
+    quint32 totalCount = 0; // The number of matching files, of which the entries are a page.
+    QString pool;
+    QVector<Entry> entries;
+
+    [[nodiscard]] QStringView nameAt(const qsizetype index) const { return QStringView(pool).mid(entries.at(index).name, entries.at(index).nameLength); }
+    [[nodiscard]] QStringView directoryAt(const qsizetype index) const
+    {
+        return QStringView(pool).mid(entries.at(index).directory, entries.at(index).directoryLength);
+    }
+
+    void append(const QStringView name, const QStringView directory, const quint32 runCount)
+    {
+        const auto offset = static_cast<quint32>(pool.size());
+        entries.append({offset, offset + static_cast<quint32>(name.size()), static_cast<quint16>(name.size()), static_cast<quint16>(directory.size()), runCount});
+        pool.append(name);
+        pool.append(directory);
+    }
+};
+
+/**
+ * @class FileSearchBackend
+ * @brief Search files by name for EverythingSearch.
+ *
+ * A backend is constructed on the GUI thread, initialized once on a worker
+ * thread, then searched on worker threads; searches never overlap.
+ */
+class FileSearchBackend
+{
+public:
+    virtual ~FileSearchBackend() = default;
+
+    /**
+     * Do the heavy initialization of the backend. Called on a worker thread.
+     */
+    virtual void initialize() {}
+
+    /**
+     * Ask the backend to end its initialization and its background work early, as it is about to be destroyed.
+     * Called on the GUI thread, possibly while initialize or a search runs on a worker thread.
+     */
+    virtual void stop() {}
+
+    /**
+     * Search a page of files, sorted by run count, most run first. Called on a worker thread.
+     *
+     * @param text The search text, in the syntax of Everything.
+     * @param offset The number of matching files to skip.
+     * @param maxResults The maximum number of results.
+     * @param token The token of the query; the search returns Cancelled soon after it is cancelled.
+     * @return The results.
+     */
+    [[nodiscard]] virtual FileSearchResults search(const QString &text, int offset, int maxResults, const QueryToken &token) = 0;
+
+    /**
+     * Record that a file was opened, so that it ranks higher. Called on the GUI thread.
+     *
+     * @param fullPath The full path of the file.
+     */
+    virtual void recordRun(const QString &fullPath) { Q_UNUSED(fullPath) }
+
+    /**
+     * Get the message shown when the backend is unavailable.
+     *
+     * @return The message.
+     */
+    [[nodiscard]] virtual QString unavailableMessage() const = 0;
+};
@@ -0,0 +1,90 @@
+#include "SyntheticFileSearchBackend.h"
+#include <QRandomGenerator>
+#include <algorithm>
+#include <array>
+
+namespace
+{
+    constexpr quint32 CORPUS_SEED = 0x4C41554E; // "LAUN".
+    constexpr int FILES_PER_DIRECTORY = 64;
+    constexpr int MAX_DIRECTORY_COUNT = 65536;
+    constexpr qsizetype CANCELLATION_CHECK_INTERVAL = 16384; // Files scanned between two checks of the cancellation.
+
+    constexpr std::array<const char *, 32> WORDS = {
+        "Report", "Invoice", "Photo",  "Backup", "Project", "Draft",   "Notes",   "Budget",  "Config",  "Archive", "Music",
+        "Video",  "Setup",   "Readme", "Data",   "Export",  "Summary", "Meeting", "Design",  "Release", "Test",    "Source",
+        "Build",  "Cache",   "Log",    "Shader", "Model",   "Script",  "Library", "Manual",  "Letter",  "Scan"};
+    constexpr std::array<const char *, 16> EXTENSIONS = {"txt", "pdf", "docx", "xlsx", "jpg", "png", "mp3", "mp4",
+                                                         "zip", "exe", "dll", "cpp", "h",    "json", "md",  "log"};
+} // namespace
+
+SyntheticFileSearchBackend::SyntheticFileSearchBackend(const int fileCount) : m_fileCount(std::max(0, fileCount)) {}
+
+/**
+ * Generate the corpus: files named like "Budget Notes 1234.xlsx" in nested directories,
+ * of which one in eight has been run a few times.
+ */
+void SyntheticFileSearchBackend::initialize()
+{
+    QRandomGenerator random(CORPUS_SEED);
+    const auto word = [&random] { return QLatin1String(WORDS.at(random.bounded(static_cast<quint32>(WORDS.size())))); };
+
+    const int directoryCount = std::clamp(m_fileCount / FILES_PER_DIRECTORY, 1, MAX_DIRECTORY_COUNT);
+    m_directories.reserve(directoryCount);
+    for (int directoryIndex = 0; directoryIndex < directoryCount; ++directoryIndex)
+        m_directories.append(QString("C:\\Synthetic\\%1 %2\\%3").arg(word()).arg(directoryIndex / 256).arg(word()) + QString::number(directoryIndex % 256));
+
+    m_files.reserve(m_fileCount);
+    m_names.reserve(static_cast<qsizetype>(m_fileCount) * 24);
+    for (int fileIndex = 0; fileIndex < m_fileCount; ++fileIndex)
+    {
+        const auto name = static_cast<quint32>(m_names.size());
+        m_names.append(word());
+        m_names.append(' ');
+        m_names.append(word());
+        m_names.append(' ');
+        m_names.append(QString::number(fileIndex));
+        m_names.append('.');
+        m_names.append(QLatin1String(EXTENSIONS.at(random.bounded(static_cast<quint32>(EXTENSIONS.size())))));
+        const quint32 runCount = random.bounded(8) == 0 ? random.bounded(1, 32) : 0;
+        m_files.append({name, static_cast<quint16>(m_names.size() - name), static_cast<quint16>(random.bounded(directoryCount)), runCount});
+    }
+    m_foldedNames = m_names.toLower();
+}
+
+FileSearchResults SyntheticFileSearchBackend::search(const QString &text, const int offset, const int maxResults, const QueryToken &token)
+{
+    FileSearchResults results;
+
+    // As in Everything, the words separated by spaces must all appear in the name, in any case.
+    const QStringList terms = text.toLower().split(' ', Qt::SkipEmptyParts);
+    QVector<qsizetype> matches;
+    for (qsizetype fileIndex = 0; fileIndex < m_files.size(); ++fileIndex)
+    {
+        if (fileIndex % CANCELLATION_CHECK_INTERVAL == 0 && token.isCancelled())
+        {
+            results.status = FileSearchResults::Status::Cancelled;
+            return results;
+        }
+        const File &file = m_files.at(fileIndex);
+        const QStringView name = QStringView(m_foldedNames).mid(file.name, file.nameLength);
+        if (std::all_of(terms.cbegin(), terms.cend(), [name](const QString &term) { return name.contains(term); }))
+            matches.append(fileIndex);
+    }
+
+    // Ties keep the corpus order, so that the pages of a query never overlap.
+    const auto byRunCount = [this](const qsizetype left, const qsizetype right)
+    { return m_files.at(left).runCount != m_files.at(right).runCount ? m_files.at(left).runCount > m_files.at(right).runCount : left < right; };
+    const qsizetype first = std::clamp<qsizetype>(offset, 0, matches.size());
+    const qsizetype last = std::min<qsizetype>(first + std::max(0, maxResults), matches.size());
+    std::partial_sort(matches.begin(), matches.begin() + last, matches.end(), byRunCount);
+
+    results.totalCount = static_cast<quint32>(matches.size());
+    results.entries.reserve(last - first);
+    for (qsizetype matchIndex = first; matchIndex < last; ++matchIndex)
+    {
+        const File &file = m_files.at(matches.at(matchIndex));
+        results.append(QStringView(m_names).mid(file.name, file.nameLength), m_directories.at(file.directory), file.runCount);
+    }
+    return results;
+}
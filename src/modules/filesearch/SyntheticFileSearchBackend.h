@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QStringList>
+#include "FileSearchBackend.h"
+
+/**
+ * @class SyntheticFileSearchBackend
+ * @brief Search a generated corpus of files in process, standing in for Everything.
+ *
+ * The corpus is the same on every run, so that the latency, the cancellation
+ * and the throughput of EverythingSearch can be measured without Everything.
+ */
+class SyntheticFileSearchBackend final : public FileSearchBackend
+{
+public:
+    explicit SyntheticFileSearchBackend(int fileCount);
+
+    void initialize() override;
+    [[nodiscard]] FileSearchResults search(const QString &text, int offset, int maxResults, const QueryToken &token) override;
+    [[nodiscard]] QString unavailableMessage() const override { return "The synthetic corpus is unavailable"; }
+
+private:
+    struct File
+    {
+        quint32 name;
+        quint16 nameLength;
+        quint16 directory;
+        quint32 runCount;
+    };
+
+    int m_fileCount;
+    QString m_names; // The names of all files, back to back.
+    QString m_foldedNames; // m_names in lower case, for case-insensitive matching.
+    QStringList m_directories;
+    QVector<File> m_files;
+};
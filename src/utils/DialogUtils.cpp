@@ -1,12 +1,26 @@
 #include "DialogUtils.h"
+#include <QApplication>
 #include <QMessageBox>
+#include <QThread>
 
 void DialogUtils::showError(const QString &message) { showDialog(QMessageBox::Critical, message); }
 
 void DialogUtils::showWarning(const QString &message) { showDialog(QMessageBox::Warning, message); }
 
+/**
+ * Show a message box. May be called from any thread; the box is always shown on the GUI thread.
+ *
+ * @param icon The icon of the message box.
+ * @param message The message.
+ */
 void DialogUtils::showDialog(const QMessageBox::Icon &icon, const QString &message)
 {
+    if (QThread::currentThread() != qApp->thread())
+    {
+        QMetaObject::invokeMethod(qApp, [icon, message] { showDialog(icon, message); }, Qt::QueuedConnection);
+        return;
+    }
+
     QMessageBox msgBox;
     msgBox.setWindowIcon(QIcon(":/icons/launcher.png"));
     msgBox.setWindowTitle("Launcher");
@@ -0,0 +1,217 @@
+#include "FuzzyMatcher.h"
+#include <QVarLengthArray>
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+    // Scoring scheme of fzf.
+    constexpr int SCORE_MATCH = 16;
+    constexpr int SCORE_GAP_START = -3;
+    constexpr int SCORE_GAP_EXTENSION = -1;
+    constexpr int BONUS_BOUNDARY = SCORE_MATCH / 2;
+    constexpr int BONUS_NON_WORD = SCORE_MATCH / 2;
+    constexpr int BONUS_CAMEL_123 = BONUS_BOUNDARY + SCORE_GAP_EXTENSION;
+    constexpr int BONUS_CONSECUTIVE = -(SCORE_GAP_START + SCORE_GAP_EXTENSION);
+    constexpr int BONUS_FIRST_CHAR_MULTIPLIER = 2;
+    constexpr int NO_MATCH = std::numeric_limits<int>::min() / 2;
+
+    enum class CharClass
+    {
+        NonWord,
+        Lower,
+        Upper,
+        Number
+    };
+
+    CharClass charClassOf(const QChar &character)
+    {
+        if (character.isUpper())
+            return CharClass::Upper;
+        if (character.isDigit())
+            return CharClass::Number;
+        if (character.isLetter())
+            return CharClass::Lower;
+        return CharClass::NonWord;
+    }
+
+    int bonusFor(const CharClass &previous, const CharClass &current)
+    {
+        if (previous == CharClass::NonWord && current != CharClass::NonWord)
+            return BONUS_BOUNDARY; // Start of a word, including the start of the string.
+        if ((previous == CharClass::Lower && current == CharClass::Upper) || (previous != CharClass::Number && current == CharClass::Number))
+            return BONUS_CAMEL_123;
+        if (current == CharClass::NonWord)
+            return BONUS_NON_WORD;
+        return 0;
+    }
+} // namespace
+
+FuzzyMatcher::FuzzyMatcher(const QString &pattern)
+{
+    m_pattern.reserve(pattern.size());
+    for (const QChar &character : pattern)
+    {
+        m_pattern.append(character.toLower());
+        m_charMask |= charBit(m_pattern.back());
+    }
+
+    // The score of contiguous characters starting a word, such as a prefix, which carry the bonus of the word start.
+    const int length = static_cast<int>(m_pattern.size());
+    m_perfectScore = length * SCORE_MATCH + BONUS_BOUNDARY * BONUS_FIRST_CHAR_MULTIPLIER + (length - 1) * std::max(BONUS_BOUNDARY, BONUS_CONSECUTIVE);
+}
+
+/**
+ * Prepare a string for fuzzy matching.
+ *
+ * Should be called once when the string is loaded, not on every query.
+ *
+ * @param text The original string.
+ * @return The lowercased string with its per-position bonuses and character mask.
+ */
+FuzzyMatcher::Target FuzzyMatcher::prepare(const QString &text)
+{
+    Target target;
+    target.text.reserve(text.size());
+    target.bonuses.resize(text.size());
+
+    CharClass previous = CharClass::NonWord;
+    for (int position = 0; position < text.size(); ++position)
+    {
+        const CharClass current = charClassOf(text.at(position));
+        target.bonuses[position] = static_cast<char>(bonusFor(previous, current));
+        previous = current;
+
+        target.text.append(text.at(position).toLower()); // Lowercase per character to keep the length.
+        target.charMask |= charBit(target.text.back());
+    }
+
+    return target;
+}
+
+/**
+ * Match the pattern as a subsequence of a target and score the match.
+ *
+ * Targets missing any character of the pattern are rejected with the character
+ * mask, and targets not containing the pattern as a subsequence are rejected
+ * with a scan for each character, before the scoring pass runs.
+ *
+ * Matches get bonuses at word boundaries, camelCase humps and digits, and for
+ * consecutive characters; gaps are penalized. As in fzf, consecutive characters
+ * keep the bonus of the start of their run, so a prefix scores as well as a
+ * match of word initials, however long it is.
+ *
+ * @param target The prepared target.
+ * @return 0 if the pattern does not match; otherwise a score between 1 and 2,
+ * where 2 is a run of contiguous characters starting a word, such as a prefix.
+ */
+double FuzzyMatcher::match(const Target &target) const
+{
+    if (m_pattern.isEmpty())
+        return 1.0;
+    if ((m_charMask & ~target.charMask) != 0)
+        return 0.0;
+
+    int first, last;
+    if (!findSpan(target.text, first, last))
+        return 0.0;
+
+    // Only the span between the first and the last possible matching positions is scored.
+    const int width = last - first + 1;
+    QVarLengthArray<int, 256> rowA(width), rowB(width);
+    QVarLengthArray<int, 256> runBonusA(width), runBonusB(width); // The bonus of the start of the run of consecutive characters ending at each column.
+    int *previousRow = rowA.data();
+    int *currentRow = rowB.data();
+    int *previousRunBonus = runBonusA.data();
+    int *currentRunBonus = runBonusB.data();
+
+    for (int patternIndex = 0; patternIndex < m_pattern.size(); ++patternIndex)
+    {
+        const QChar patternChar = m_pattern.at(patternIndex);
+        int gapScore = NO_MATCH; // Best score of the previous character followed by a gap.
+        for (int column = 0; column < width; ++column)
+        {
+            if (patternIndex > 0 && column >= 2)
+                gapScore = std::max(gapScore + SCORE_GAP_EXTENSION, previousRow[column - 2] + SCORE_GAP_START);
+
+            const int position = first + column;
+            if (target.text.at(position) != patternChar)
+            {
+                currentRow[column] = NO_MATCH;
+                continue;
+            }
+
+            const int bonus = target.bonuses.at(position);
+            currentRunBonus[column] = bonus;
+            if (patternIndex == 0)
+            {
+                currentRow[column] = SCORE_MATCH + bonus * BONUS_FIRST_CHAR_MULTIPLIER;
+                continue;
+            }
+
+            int best = NO_MATCH;
+            if (column >= 1 && previousRow[column - 1] > NO_MATCH)
+            {
+                // A new word starts a new run; otherwise the run carries the bonus of its start.
+                const int runBonus = bonus == BONUS_BOUNDARY ? bonus : std::max(bonus, previousRunBonus[column - 1]);
+                best = previousRow[column - 1] + std::max(runBonus, BONUS_CONSECUTIVE);
+                currentRunBonus[column] = runBonus;
+            }
+            if (gapScore > NO_MATCH && gapScore + bonus > best)
+            {
+                best = gapScore + bonus;
+                currentRunBonus[column] = bonus;
+            }
+            currentRow[column] = best > NO_MATCH ? best + SCORE_MATCH : NO_MATCH;
+        }
+        std::swap(previousRow, currentRow);
+        std::swap(previousRunBonus, currentRunBonus);
+    }
+
+    const int score = *std::max_element(previousRow, previousRow + width);
+    if (score <= NO_MATCH)
+        return 0.0;
+    return 1.0 + std::clamp(static_cast<double>(score) / m_perfectScore, 0.01, 1.0);
+}
+
+/**
+ * Map a character to a bit of the character mask.
+ *
+ * @param character A lowercased character.
+ * @return A single bit; letters and digits have their own bits, other characters share the remaining ones.
+ */
+quint64 FuzzyMatcher::charBit(const QChar &character)
+{
+    const char16_t code = character.unicode();
+    if (code >= u'a' && code <= u'z')
+        return 1ULL << (code - u'a');
+    if (code >= u'0' && code <= u'9')
+        return 1ULL << (26 + code - u'0');
+    return 1ULL << (36 + code % 28);
+}
+
+/**
+ * Check that the pattern is a subsequence of a text and find the span to score.
+ *
+ * @param text The lowercased text.
+ * @param first Set to the first position of the first pattern character.
+ * @param last Set to the last position of the last pattern character.
+ * @return True if the text contains the pattern as a subsequence.
+ */
+bool FuzzyMatcher::findSpan(const QString &text, int &first, int &last) const
+{
+    qsizetype position = text.indexOf(m_pattern.front());
+    if (position < 0)
+        return false;
+    first = static_cast<int>(position);
+
+    for (qsizetype patternIndex = 1; patternIndex < m_pattern.size(); ++patternIndex)
+    {
+        position = text.indexOf(m_pattern.at(patternIndex), position + 1);
+        if (position < 0)
+            return false;
+    }
+
+    last = static_cast<int>(text.lastIndexOf(m_pattern.back()));
+    return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+class FuzzyMatcher final
+{
+public:
+    /**
+     * @struct Target
+     * @brief A string prepared once for repeated fuzzy matching.
+     *
+     * Members:
+     *
+     * - text: The lowercased string.
+     * - bonuses: The bonus of a match at each position (word boundary, camelCase, etc.).
+     * - charMask: A bitmask of the characters present in the string.
+     */
+    struct Target
+    {
+        QString text;
+        QByteArray bonuses;
+        quint64 charMask = 0;
+    };
+
+    explicit FuzzyMatcher(const QString &pattern);
+
+    [[nodiscard]] static Target prepare(const QString &text);
+    [[nodiscard]] double match(const Target &target) const;
+
+private:
+    [[nodiscard]] static quint64 charBit(const QChar &character);
+    [[nodiscard]] bool findSpan(const QString &text, int &first, int &last) const;
+
+    QString m_pattern;
+    quint64 m_charMask = 0;
+    int m_perfectScore = 0;
+};
@@ -0,0 +1,149 @@
+#include "PaintUtils.h"
+#include <QPainter>
+#include <QPixmapCache>
+#include <QtMath>
+#include <algorithm>
+#include <qdrawutil.h>
+
+/**
+ * Draw the drop shadow of a rounded rectangle.
+ *
+ * The shadow is stretched from a nine-slice pixmap, which is blurred once per
+ * corner radius, blur radius, color and device pixel ratio and then cached.
+ *
+ * @param painter The painter to draw with.
+ * @param rect The rectangle casting the shadow.
+ * @param cornerRadius The corner radius of the rectangle.
+ * @param blurRadius The blur radius of the shadow, as for QGraphicsDropShadowEffect.
+ * @param offset The vertical offset of the shadow.
+ * @param color The color of the shadow.
+ */
+void PaintUtils::drawShadow(QPainter *painter, const QRect &rect, const int cornerRadius, const int blurRadius, const int offset, const QColor &color)
+{
+    const int extent = shadowExtent(blurRadius);
+    const int margin = extent + cornerRadius;
+    const QPixmap shadow = shadowPixmap(cornerRadius, blurRadius, color, painter->device()->devicePixelRatioF());
+    qDrawBorderPixmap(painter, rect.translated(0, offset).adjusted(-extent, -extent, extent, extent), QMargins(margin, margin, margin, margin), shadow);
+}
+
+/**
+ * Fill a rounded rectangle.
+ *
+ * @param painter The painter to draw with.
+ * @param rect The rectangle.
+ * @param cornerRadius The corner radius.
+ * @param color The fill color.
+ */
+void PaintUtils::drawRoundedRect(QPainter *painter, const QRect &rect, const int cornerRadius, const QColor &color)
+{
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(color);
+    painter->drawRoundedRect(QRectF(rect), cornerRadius, cornerRadius);
+    painter->restore();
+}
+
+/**
+ * Get how far a shadow reaches beyond the rectangle casting it.
+ *
+ * @param blurRadius The blur radius of the shadow.
+ * @return The extent in device-independent pixels, not counting the offset.
+ */
+int PaintUtils::shadowExtent(const int blurRadius) { return blurRadius / 2; }
+
+/**
+ * Get the nine-slice pixmap of a shadow.
+ *
+ * The pixmap holds the smallest blurred rounded rectangle whose corners fit in
+ * the slices, so that its one-pixel center can be stretched to any size.
+ *
+ * @param cornerRadius The corner radius of the rectangle casting the shadow.
+ * @param blurRadius The blur radius of the shadow.
+ * @param color The color of the shadow.
+ * @param devicePixelRatio The device pixel ratio of the target.
+ * @return The pixmap, with slice margins of shadowExtent(blurRadius) + cornerRadius.
+ */
+QPixmap PaintUtils::shadowPixmap(const int cornerRadius, const int blurRadius, const QColor &color, const qreal devicePixelRatio)
+{
+    const QString cacheKey = QString("shadow|%1|%2|%3|%4").arg(cornerRadius).arg(blurRadius).arg(color.rgba()).arg(devicePixelRatio);
+    QPixmap pixmap;
+    if (QPixmapCache::find(cacheKey, &pixmap))
+        return pixmap;
+
+    const int extent = shadowExtent(blurRadius);
+    const int logicalSize = 2 * (extent + cornerRadius) + 1;
+    const int size = qCeil(logicalSize * devicePixelRatio);
+    QImage image(size, size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    {
+        QPainter maskPainter(&image);
+        maskPainter.setRenderHint(QPainter::Antialiasing);
+        maskPainter.scale(devicePixelRatio, devicePixelRatio);
+        maskPainter.setPen(Qt::NoPen);
+        maskPainter.setBrush(Qt::black);
+        maskPainter.drawRoundedRect(QRectF(extent, extent, logicalSize - 2 * extent, logicalSize - 2 * extent), cornerRadius, cornerRadius);
+    }
+
+    QVector<uchar> alpha(static_cast<qsizetype>(size) * size);
+    for (int y = 0; y < size; ++y)
+    {
+        const auto *line = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+        for (int x = 0; x < size; ++x)
+            alpha[y * size + x] = static_cast<uchar>(qAlpha(line[x]));
+    }
+
+    // Three box blurs approximate a Gaussian blur, and together spread the edge by the extent.
+    const int boxRadius = std::max(1, qRound(extent * devicePixelRatio / 3));
+    for (int pass = 0; pass < 3; ++pass)
+        boxBlur(alpha, size, size, boxRadius);
+
+    for (int y = 0; y < size; ++y)
+    {
+        auto *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < size; ++x)
+            line[x] = qPremultiply(qRgba(color.red(), color.green(), color.blue(), alpha[y * size + x] * color.alpha() / 255));
+    }
+
+    pixmap = QPixmap::fromImage(image);
+    pixmap.setDevicePixelRatio(devicePixelRatio);
+    QPixmapCache::insert(cacheKey, pixmap);
+    return pixmap;
+}
+
+/**
+ * Blur an alpha mask with a box filter, horizontally then vertically.
+ *
+ * @param alpha The mask, row by row; blurred in place.
+ * @param width The width of the mask.
+ * @param height The height of the mask.
+ * @param radius The radius of the box; the box is 2 * radius + 1 pixels wide.
+ */
+void PaintUtils::boxBlur(QVector<uchar> &alpha, const int width, const int height, const int radius)
+{
+    const int window = 2 * radius + 1;
+    QVector<uchar> line(std::max(width, height));
+
+    // Keep a running sum over the box, treating the pixels outside the mask as transparent.
+    const auto blurLine = [&](uchar *first, const int length, const int stride)
+    {
+        for (int index = 0; index < length; ++index)
+            line[index] = first[index * stride];
+        int sum = 0;
+        for (int index = 0; index <= std::min(radius, length - 1); ++index)
+            sum += line[index];
+        for (int index = 0; index < length; ++index)
+        {
+            first[index * stride] = static_cast<uchar>(sum / window);
+            if (index + radius + 1 < length)
+                sum += line[index + radius + 1];
+            if (index - radius >= 0)
+                sum -= line[index - radius];
+        }
+    };
+
+    for (int y = 0; y < height; ++y)
+        blurLine(alpha.data() + static_cast<qsizetype>(y) * width, width, 1);
+    for (int x = 0; x < width; ++x)
+        blurLine(alpha.data() + x, height, width);
+}
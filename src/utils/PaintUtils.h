@@ -0,0 +1,21 @@
+#pragma once
+
+#include <QColor>
+#include <QPixmap>
+
+class QPainter;
+
+class PaintUtils final
+{
+public:
+    PaintUtils() = delete;
+
+    static void drawShadow(QPainter *painter, const QRect &rect, int cornerRadius, int blurRadius, int offset, const QColor &color);
+    static void drawRoundedRect(QPainter *painter, const QRect &rect, int cornerRadius, const QColor &color);
+
+    [[nodiscard]] static int shadowExtent(int blurRadius);
+
+private:
+    [[nodiscard]] static QPixmap shadowPixmap(int cornerRadius, int blurRadius, const QColor &color, qreal devicePixelRatio);
+    static void boxBlur(QVector<uchar> &alpha, int width, int height, int radius);
+};
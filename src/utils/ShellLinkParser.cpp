@@ -0,0 +1,269 @@
+#include "ShellLinkParser.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QRegularExpression>
+#include <QThreadPool>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    // Shell link header (MS-SHLLINK 2.1).
+    constexpr qint64 HEADER_SIZE = 0x4C;
+    constexpr uchar LINK_CLSID[16] = {0x01, 0x14, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46};
+
+    // Link flags (MS-SHLLINK 2.1.1).
+    constexpr quint32 HAS_LINK_TARGET_ID_LIST = 0x00000001;
+    constexpr quint32 HAS_LINK_INFO = 0x00000002;
+    constexpr quint32 HAS_NAME = 0x00000004;
+    constexpr quint32 HAS_RELATIVE_PATH = 0x00000008;
+    constexpr quint32 HAS_WORKING_DIR = 0x00000010;
+    constexpr quint32 HAS_ARGUMENTS = 0x00000020;
+    constexpr quint32 HAS_ICON_LOCATION = 0x00000040;
+    constexpr quint32 IS_UNICODE = 0x00000080;
+
+    // Link info (MS-SHLLINK 2.3).
+    constexpr qint64 LINK_INFO_MIN_SIZE = 0x1C;
+    constexpr quint32 LINK_INFO_UNICODE_HEADER_SIZE = 0x24;
+    constexpr quint32 VOLUME_ID_AND_LOCAL_BASE_PATH = 0x00000001;
+
+    // Extra data blocks (MS-SHLLINK 2.5).
+    constexpr quint32 ENVIRONMENT_VARIABLE_DATA_BLOCK = 0xA0000001;
+    constexpr quint32 ICON_ENVIRONMENT_DATA_BLOCK = 0xA0000007;
+    constexpr qint64 ENVIRONMENT_DATA_BLOCK_SIZE = 0x314;
+    constexpr qint64 ENVIRONMENT_TARGET_UNICODE_OFFSET = 8 + 260;
+
+    quint16 readUInt16(const uchar *data) { return qFromLittleEndian<quint16>(data); }
+    quint32 readUInt32(const uchar *data) { return qFromLittleEndian<quint32>(data); }
+
+    QString readUtf16(const uchar *data, const qint64 count)
+    {
+        QString text(count, Qt::Uninitialized);
+        for (qint64 index = 0; index < count; ++index)
+            text[index] = QChar(readUInt16(data + 2 * index));
+        return text;
+    }
+
+    QString readAnsiString(const uchar *data, const qint64 offset, const qint64 end)
+    {
+        qint64 length = 0;
+        while (offset + length < end && data[offset + length] != 0)
+            ++length;
+        return QString::fromLocal8Bit(reinterpret_cast<const char *>(data + offset), length);
+    }
+
+    QString readUnicodeString(const uchar *data, const qint64 offset, const qint64 end)
+    {
+        qint64 length = 0;
+        while (offset + 2 * length + 1 < end && readUInt16(data + offset + 2 * length) != 0)
+            ++length;
+        return readUtf16(data + offset, length);
+    }
+} // namespace
+
+/**
+ * Parse a shell link file.
+ *
+ * The file is memory-mapped and parsed in place; no shell or COM API is used.
+ *
+ * @param shortcutPath The path to the .lnk file.
+ * @param link The parsed fields, if successful.
+ * @return True if the file is a valid shell link with a target path; false otherwise.
+ */
+bool ShellLinkParser::parse(const QString &shortcutPath, ShellLink &link)
+{
+    QFile file(shortcutPath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    link.shortcutPath = shortcutPath;
+    const qint64 size = file.size();
+    if (uchar *data = file.map(0, size))
+    {
+        const bool result = parse(data, size, link);
+        file.unmap(data);
+        return result;
+    }
+
+    // Fall back to reading the whole file in one call.
+    const QByteArray bytes = file.readAll();
+    return parse(reinterpret_cast<const uchar *>(bytes.constData()), bytes.size(), link);
+}
+
+/**
+ * Parse the bytes of a shell link (MS-SHLLINK binary format).
+ *
+ * The target is taken from the local base path of the link info, then from the
+ * environment variable data block, then from the relative path. Targets only
+ * described by the ID list are not resolved.
+ *
+ * @param data The content of the .lnk file.
+ * @param size The size of the content in bytes.
+ * @param link The parsed fields, if successful. Its shortcut path is used to resolve a relative target.
+ * @return True if the content is a valid shell link with a target path; false otherwise.
+ */
+bool ShellLinkParser::parse(const uchar *data, const qint64 size, ShellLink &link)
+{
+    if (size < HEADER_SIZE || readUInt32(data) != HEADER_SIZE || std::memcmp(data + 4, LINK_CLSID, sizeof(LINK_CLSID)) != 0)
+        return false;
+
+    const quint32 flags = readUInt32(data + 20);
+    link.iconIndex = static_cast<qint32>(readUInt32(data + 56));
+    qint64 offset = HEADER_SIZE;
+
+    // Link target ID list.
+    if (flags & HAS_LINK_TARGET_ID_LIST)
+    {
+        if (offset + 2 > size)
+            return false;
+        offset += 2 + readUInt16(data + offset);
+    }
+
+    // Link info.
+    QString localPath;
+    if (flags & HAS_LINK_INFO)
+    {
+        if (offset + LINK_INFO_MIN_SIZE > size)
+            return false;
+        const qint64 infoEnd = offset + readUInt32(data + offset);
+        const quint32 infoHeaderSize = readUInt32(data + offset + 4);
+        const quint32 infoFlags = readUInt32(data + offset + 8);
+        if (infoEnd > size || infoEnd < offset + LINK_INFO_MIN_SIZE)
+            return false;
+
+        if (infoFlags & VOLUME_ID_AND_LOCAL_BASE_PATH)
+        {
+            if (infoHeaderSize >= LINK_INFO_UNICODE_HEADER_SIZE && offset + LINK_INFO_UNICODE_HEADER_SIZE <= infoEnd)
+                localPath = readUnicodeString(data, offset + readUInt32(data + offset + 28), infoEnd) +
+                    readUnicodeString(data, offset + readUInt32(data + offset + 32), infoEnd);
+            else
+                localPath = readAnsiString(data, offset + readUInt32(data + offset + 16), infoEnd) +
+                    readAnsiString(data, offset + readUInt32(data + offset + 24), infoEnd);
+        }
+        offset = infoEnd;
+    }
+
+    // String data, in the order defined by the format.
+    const bool isUnicode = flags & IS_UNICODE;
+    const auto readStringData = [&](const quint32 flag, QString *text)
+    {
+        if (!(flags & flag))
+            return true;
+        if (offset + 2 > size)
+            return false;
+        const quint16 count = readUInt16(data + offset);
+        const qint64 bytes = isUnicode ? 2 * count : count;
+        if (offset + 2 + bytes > size)
+            return false;
+        if (text)
+            *text = isUnicode ? readUtf16(data + offset + 2, count) : QString::fromLocal8Bit(reinterpret_cast<const char *>(data + offset + 2), count);
+        offset += 2 + bytes;
+        return true;
+    };
+    QString relativePath;
+    if (!readStringData(HAS_NAME, nullptr) || !readStringData(HAS_RELATIVE_PATH, &relativePath) || !readStringData(HAS_WORKING_DIR, nullptr) ||
+        !readStringData(HAS_ARGUMENTS, &link.arguments) || !readStringData(HAS_ICON_LOCATION, &link.iconLocation))
+        return false;
+
+    // Extra data blocks, terminated by a block smaller than 4 bytes.
+    QString environmentTarget;
+    while (offset + 8 <= size)
+    {
+        const qint64 blockSize = readUInt32(data + offset);
+        if (blockSize < 8 || offset + blockSize > size)
+            break;
+
+        const quint32 signature = readUInt32(data + offset + 4);
+        if (blockSize >= ENVIRONMENT_DATA_BLOCK_SIZE && signature == ENVIRONMENT_VARIABLE_DATA_BLOCK)
+            environmentTarget = readUnicodeString(data, offset + ENVIRONMENT_TARGET_UNICODE_OFFSET, offset + blockSize);
+        else if (blockSize >= ENVIRONMENT_DATA_BLOCK_SIZE && signature == ICON_ENVIRONMENT_DATA_BLOCK)
+            link.iconLocation = readUnicodeString(data, offset + ENVIRONMENT_TARGET_UNICODE_OFFSET, offset + blockSize);
+        offset += blockSize;
+    }
+
+    if (!localPath.isEmpty())
+        link.targetPath = localPath;
+    else if (!environmentTarget.isEmpty())
+        link.targetPath = expandEnvironmentStrings(environmentTarget);
+    else if (!relativePath.isEmpty() && !link.shortcutPath.isEmpty())
+    {
+        // The relative path uses backslashes, which QDir only treats as separators on Windows.
+        const QString directory = QFileInfo(link.shortcutPath).absolutePath();
+        link.targetPath = QDir::toNativeSeparators(QDir::cleanPath(directory + '/' + relativePath.replace('\\', '/')));
+    }
+    link.iconLocation = expandEnvironmentStrings(link.iconLocation);
+
+    return !link.targetPath.isEmpty();
+}
+
+/**
+ * Find and parse all shell links under a set of directories.
+ *
+ * The directories are walked in parallel: the top level subdirectories of each
+ * root are scanned as separate tasks on a thread pool.
+ *
+ * @param roots The directories to scan recursively.
+ * @return The successfully parsed links, sorted by shortcut path.
+ */
+QVector<ShellLinkParser::ShellLink> ShellLinkParser::scanDirectories(const QStringList &roots)
+{
+    QThreadPool threadPool;
+    QMutex mutex;
+    QVector<ShellLink> links;
+
+    const auto scan = [&mutex, &links](const QString &directory, const QDirIterator::IteratorFlags iteratorFlags)
+    {
+        QVector<ShellLink> found;
+        QDirIterator iterator(directory, {"*.lnk"}, QDir::Files, iteratorFlags);
+        while (iterator.hasNext())
+        {
+            ShellLink link;
+            if (parse(iterator.next(), link))
+                found.append(link);
+        }
+
+        const QMutexLocker locker(&mutex);
+        links.append(found);
+    };
+
+    for (const QString &root : roots)
+    {
+        threadPool.start([&scan, root] { scan(root, QDirIterator::NoIteratorFlags); });
+        for (const QString &subdirectory : QDir(root).entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+            threadPool.start([&scan, directory = QDir(root).filePath(subdirectory)] { scan(directory, QDirIterator::Subdirectories); });
+    }
+    threadPool.waitForDone();
+
+    std::sort(links.begin(), links.end(), [](const ShellLink &left, const ShellLink &right) { return left.shortcutPath < right.shortcutPath; });
+    return links;
+}
+
+/**
+ * Expand %VARIABLE% references with the values of the environment.
+ *
+ * @param text The text to expand.
+ * @return The expanded text; unknown variables are kept as they are.
+ */
+QString ShellLinkParser::expandEnvironmentStrings(const QString &text)
+{
+    if (!text.contains('%'))
+        return text;
+
+    static const QRegularExpression regex("%([^%]+)%");
+    QString result;
+    qsizetype lastEnd = 0;
+    for (auto iterator = regex.globalMatch(text); iterator.hasNext();)
+    {
+        const QRegularExpressionMatch match = iterator.next();
+        result.append(text.mid(lastEnd, match.capturedStart() - lastEnd));
+        const QString name = match.captured(1);
+        result.append(qEnvironmentVariableIsSet(name.toLocal8Bit().constData()) ? qEnvironmentVariable(name.toLocal8Bit().constData()) : match.captured(0));
+        lastEnd = match.capturedEnd();
+    }
+    result.append(text.mid(lastEnd));
+    return result;
+}
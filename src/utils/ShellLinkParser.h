@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class ShellLinkParser final
+{
+public:
+    /**
+     * @struct ShellLink
+     * @brief The fields read from a shell link (.lnk) file.
+     *
+     * Members:
+     *
+     * - shortcutPath: The path to the .lnk file itself.
+     * - targetPath: The resolved path of the link target.
+     * - arguments: The command line arguments.
+     * - iconLocation: The path to the icon, with environment variables expanded; empty if not set.
+     * - iconIndex: The index of the icon within the icon location.
+     */
+    struct ShellLink
+    {
+        QString shortcutPath;
+        QString targetPath;
+        QString arguments;
+        QString iconLocation;
+        int iconIndex = 0;
+    };
+
+    ShellLinkParser() = delete;
+
+    static bool parse(const QString &shortcutPath, ShellLink &link);
+    static bool parse(const uchar *data, qint64 size, ShellLink &link);
+    static QVector<ShellLink> scanDirectories(const QStringList &roots);
+
+private:
+    static QString expandEnvironmentStrings(const QString &text);
+};
@@ -0,0 +1,405 @@
+#include "TrigramIndex.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+    // The kind of a gram is stored above the 48 bits holding its characters.
+    constexpr quint64 KIND_TRIGRAM = 0;
+    constexpr quint64 KIND_PREFIX_1 = 1ULL << 48;
+    constexpr quint64 KIND_PREFIX_2 = 2ULL << 48;
+
+    quint64 packGram(const quint64 kind, const QString &text, const qsizetype position, const int length)
+    {
+        quint64 gram = kind;
+        for (int offset = 0; offset < length; ++offset)
+            gram |= static_cast<quint64>(text.at(position + offset).unicode()) << (16 * (length - 1 - offset));
+        return gram;
+    }
+
+    QString toLowerPerChar(const QString &text)
+    {
+        QString lower;
+        lower.reserve(text.size());
+        for (const QChar &character : text)
+            lower.append(character.toLower());
+        return lower;
+    }
+
+    bool isWordStart(const QString &text, const qsizetype position)
+    {
+        const QChar current = text.at(position);
+        if (!current.isLetterOrNumber())
+            return false;
+        if (position == 0)
+            return true;
+        const QChar previous = text.at(position - 1);
+        return !previous.isLetterOrNumber() || (previous.isLower() && current.isUpper()) || (!previous.isDigit() && current.isDigit());
+    }
+} // namespace
+
+/**
+ * Add an entry to the index.
+ *
+ * @param id The id of the entry; must not be in the index already.
+ * @param texts The texts of the entry in original case, such as its name and keywords.
+ */
+void TrigramIndex::insert(const quint32 id, const QVector<QString> &texts)
+{
+    for (const quint64 gram : gramsOf(texts))
+    {
+        QVector<quint32> &posting = m_postings[gram];
+        if (const auto iterator = std::lower_bound(posting.begin(), posting.end(), id); iterator == posting.end() || *iterator != id)
+            posting.insert(iterator, id);
+    }
+
+    if (const auto iterator = std::lower_bound(m_ids.begin(), m_ids.end(), id); iterator == m_ids.end() || *iterator != id)
+        m_ids.insert(iterator, id);
+}
+
+/**
+ * Remove an entry from the index.
+ *
+ * @param id The id of the entry.
+ * @param texts The same texts the entry was inserted with.
+ */
+void TrigramIndex::remove(const quint32 id, const QVector<QString> &texts)
+{
+    for (const quint64 gram : gramsOf(texts))
+    {
+        const auto postingIterator = m_postings.find(gram);
+        if (postingIterator == m_postings.end())
+            continue;
+
+        QVector<quint32> &posting = postingIterator.value();
+        if (const auto iterator = std::lower_bound(posting.begin(), posting.end(), id); iterator != posting.end() && *iterator == id)
+            posting.erase(iterator);
+        if (posting.isEmpty())
+            m_postings.erase(postingIterator);
+    }
+
+    if (const auto iterator = std::lower_bound(m_ids.begin(), m_ids.end(), id); iterator != m_ids.end() && *iterator == id)
+        m_ids.erase(iterator);
+    if (isFrozenId(id))
+        m_removedIds.insert(id); // The frozen postings are read-only, so the id is filtered out of the candidates instead.
+}
+
+/**
+ * Remove all entries.
+ */
+void TrigramIndex::clear()
+{
+    m_postings.clear();
+    m_ids.clear();
+    m_removedIds.clear();
+    m_frozenGrams = nullptr;
+    m_frozenIds = nullptr;
+    m_frozenOffsets = nullptr;
+    m_frozenPostings = nullptr;
+    m_frozenGramCount = 0;
+    m_frozenIdCount = 0;
+    m_frozenSize = 0;
+}
+
+/**
+ * Serialize the index into a flat, position-independent block.
+ *
+ * Layout, in native byte order: the id count and the gram count as quint32,
+ * the sorted grams as quint64, the sorted ids, then the posting offsets
+ * (gram count + 1 entries) and the postings as quint32.
+ *
+ * @return The block, to be passed to loadFrozen later.
+ */
+QByteArray TrigramIndex::freeze() const
+{
+    QVector<quint64> grams(m_postings.keyBegin(), m_postings.keyEnd());
+    grams.append(QVector<quint64>(m_frozenGrams, m_frozenGrams + m_frozenGramCount));
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+
+    QVector<quint32> offsets = {0};
+    QVector<quint32> postings;
+    QVector<quint64> nonEmptyGrams;
+    for (const quint64 gram : grams)
+    {
+        const Posting frozen = frozenPosting(gram);
+        const QVector<quint32> inserted = m_postings.value(gram);
+        const qsizetype start = postings.size();
+        std::set_union(frozen.begin, frozen.end, inserted.cbegin(), inserted.cend(), std::back_inserter(postings));
+        postings.erase(std::remove_if(postings.begin() + start, postings.end(), [this](const quint32 id) { return m_removedIds.contains(id); }),
+                       postings.end());
+        if (postings.size() == start)
+            continue;
+        nonEmptyGrams.append(gram);
+        offsets.append(static_cast<quint32>(postings.size()));
+    }
+
+    const auto idCount = static_cast<quint32>(m_ids.size());
+    const auto gramCount = static_cast<quint32>(nonEmptyGrams.size());
+    QByteArray data;
+    data.append(reinterpret_cast<const char *>(&idCount), sizeof(idCount));
+    data.append(reinterpret_cast<const char *>(&gramCount), sizeof(gramCount));
+    data.append(reinterpret_cast<const char *>(nonEmptyGrams.constData()), nonEmptyGrams.size() * static_cast<qsizetype>(sizeof(quint64)));
+    data.append(reinterpret_cast<const char *>(m_ids.constData()), m_ids.size() * static_cast<qsizetype>(sizeof(quint32)));
+    data.append(reinterpret_cast<const char *>(offsets.constData()), offsets.size() * static_cast<qsizetype>(sizeof(quint32)));
+    data.append(reinterpret_cast<const char *>(postings.constData()), postings.size() * static_cast<qsizetype>(sizeof(quint32)));
+    return data;
+}
+
+/**
+ * Replace the index with a block produced by freeze, without copying its postings.
+ *
+ * The block must stay valid and unchanged, and be aligned to 8 bytes, as long
+ * as the index is used. Entries can still be inserted and removed afterwards.
+ *
+ * The whole block is checked once, so that a torn or corrupted block cannot
+ * yield ids the caller does not have, nor break the binary searches and the
+ * intersections of the lookups, which rely on the grams, the ids and each
+ * posting being sorted.
+ *
+ * @param data The block, typically memory-mapped.
+ * @param size The size of the block in bytes.
+ * @param idBound The number of entries of the caller; every id must be below it.
+ * @return True if the block is well-formed; false otherwise, leaving the index empty.
+ */
+bool TrigramIndex::loadFrozen(const uchar *data, const qsizetype size, const quint32 idBound)
+{
+    clear();
+    if (size < 2 * static_cast<qsizetype>(sizeof(quint32)) || reinterpret_cast<quintptr>(data) % alignof(quint64) != 0)
+        return false;
+
+    quint32 idCount, gramCount;
+    std::memcpy(&idCount, data, sizeof(idCount));
+    std::memcpy(&gramCount, data + sizeof(idCount), sizeof(gramCount));
+    const qsizetype gramsOffset = 2 * sizeof(quint32);
+    const qsizetype idsOffset = gramsOffset + static_cast<qsizetype>(gramCount) * sizeof(quint64);
+    const qsizetype offsetsOffset = idsOffset + static_cast<qsizetype>(idCount) * sizeof(quint32);
+    const qsizetype postingsOffset = offsetsOffset + (static_cast<qsizetype>(gramCount) + 1) * sizeof(quint32);
+    if (postingsOffset > size)
+        return false;
+
+    const auto *offsets = reinterpret_cast<const quint32 *>(data + offsetsOffset);
+    for (quint32 gramIndex = 0; gramIndex < gramCount; ++gramIndex)
+        if (offsets[gramIndex] > offsets[gramIndex + 1])
+            return false;
+    if (offsets[0] != 0 || postingsOffset + static_cast<qsizetype>(offsets[gramCount]) * static_cast<qsizetype>(sizeof(quint32)) > size)
+        return false;
+
+    // Strictly increasing, so also free of duplicates, and below the bound.
+    const auto isSortedBelow = [idBound](const quint32 *begin, const quint32 *end)
+    { return begin == end || (std::adjacent_find(begin, end, std::greater_equal<>()) == end && *(end - 1) < idBound); };
+    const auto *grams = reinterpret_cast<const quint64 *>(data + gramsOffset);
+    const auto *ids = reinterpret_cast<const quint32 *>(data + idsOffset);
+    const auto *postings = reinterpret_cast<const quint32 *>(data + postingsOffset);
+    if (std::adjacent_find(grams, grams + gramCount, std::greater_equal<>()) != grams + gramCount || !isSortedBelow(ids, ids + idCount))
+        return false;
+    for (quint32 gramIndex = 0; gramIndex < gramCount; ++gramIndex)
+        if (!isSortedBelow(postings + offsets[gramIndex], postings + offsets[gramIndex + 1]))
+            return false;
+
+    m_frozenGrams = grams;
+    m_frozenIds = ids;
+    m_frozenOffsets = offsets;
+    m_frozenPostings = postings;
+    m_frozenGramCount = gramCount;
+    m_frozenIdCount = idCount;
+    m_frozenSize = size;
+    m_ids = QVector<quint32>(m_frozenIds, m_frozenIds + m_frozenIdCount);
+    return true;
+}
+
+/**
+ * Find the entries which may match a query.
+ *
+ * Queries of 3 or more characters are split into trigrams; 1 or 2 characters
+ * are looked up as the prefix of a word. The posting lists of all grams are
+ * intersected, starting from the shortest one.
+ *
+ * The result is a superset of the entries containing the query as a substring or
+ * as word initials, and the candidates still need to be scored. Fuzzy matches
+ * with gaps between the characters are not found here.
+ *
+ * @param query The search text.
+ * @return The sorted ids of the candidates; all ids if the query is empty.
+ */
+QVector<quint32> TrigramIndex::candidates(const QString &query) const
+{
+    const QVector<quint64> grams = gramsOfQuery(query);
+    if (grams.isEmpty())
+        return m_ids;
+
+    std::vector<QVector<quint32>> unions; // Storage for grams with both frozen and inserted postings.
+    unions.reserve(grams.size());
+    QVector<Posting> postings;
+    postings.reserve(grams.size());
+    for (const quint64 gram : grams)
+    {
+        const Posting frozen = frozenPosting(gram);
+        const auto iterator = m_postings.constFind(gram);
+        if (iterator == m_postings.constEnd())
+        {
+            if (frozen.size() == 0)
+                return {};
+            postings.append(frozen);
+            continue;
+        }
+
+        const QVector<quint32> &inserted = iterator.value();
+        if (frozen.size() == 0)
+        {
+            postings.append({inserted.constData(), inserted.constData() + inserted.size()});
+            continue;
+        }
+        QVector<quint32> &merged = unions.emplace_back();
+        std::set_union(frozen.begin, frozen.end, inserted.cbegin(), inserted.cend(), std::back_inserter(merged));
+        postings.append({merged.constData(), merged.constData() + merged.size()});
+    }
+    std::sort(postings.begin(), postings.end(), [](const Posting &left, const Posting &right) { return left.size() < right.size(); });
+
+    QVector<quint32> result(postings.front().begin, postings.front().end);
+    QVector<quint32> intersection;
+    for (qsizetype postingIndex = 1; postingIndex < postings.size() && !result.isEmpty(); ++postingIndex)
+    {
+        const Posting &posting = postings.at(postingIndex);
+        intersection.clear();
+        std::set_intersection(result.cbegin(), result.cend(), posting.begin, posting.end, std::back_inserter(intersection));
+        std::swap(result, intersection);
+    }
+
+    if (!m_removedIds.isEmpty())
+        result.removeIf([this](const quint32 id) { return m_removedIds.contains(id); });
+    return result;
+}
+
+/**
+ * Get the number of entries in the index.
+ *
+ * @return The number of entries.
+ */
+qsizetype TrigramIndex::entryCount() const { return m_ids.size(); }
+
+/**
+ * Estimate the memory used by the index.
+ *
+ * @return The approximate number of heap bytes, including the hash table
+ * overhead; the frozen part is not counted, as it is mapped from a file.
+ */
+qsizetype TrigramIndex::memoryUsage() const
+{
+    constexpr qsizetype nodeOverhead = sizeof(quint64) + sizeof(QVector<quint32>) + 2 * sizeof(void *);
+    qsizetype bytes = m_ids.capacity() * static_cast<qsizetype>(sizeof(quint32));
+    for (auto iterator = m_postings.cbegin(); iterator != m_postings.cend(); ++iterator)
+        bytes += nodeOverhead + iterator.value().capacity() * static_cast<qsizetype>(sizeof(quint32));
+    bytes += m_removedIds.capacity() * static_cast<qsizetype>(sizeof(quint32) + sizeof(void *));
+    return bytes;
+}
+
+/**
+ * Get the size of the frozen part, which memoryUsage does not count.
+ *
+ * @return The size in bytes of the block passed to loadFrozen; 0 if none is loaded.
+ */
+qsizetype TrigramIndex::frozenSize() const { return m_frozenSize; }
+
+/**
+ * Find the frozen posting of a gram.
+ *
+ * @param gram The gram.
+ * @return The sorted ids of the frozen posting; empty if the gram is not frozen.
+ */
+TrigramIndex::Posting TrigramIndex::frozenPosting(const quint64 gram) const
+{
+    const quint64 *end = m_frozenGrams + m_frozenGramCount;
+    const quint64 *iterator = std::lower_bound(m_frozenGrams, end, gram);
+    if (iterator == end || *iterator != gram)
+        return {};
+    const qsizetype gramIndex = iterator - m_frozenGrams;
+    return {m_frozenPostings + m_frozenOffsets[gramIndex], m_frozenPostings + m_frozenOffsets[gramIndex + 1]};
+}
+
+/**
+ * Check whether an id is in the frozen part.
+ *
+ * @param id The id.
+ * @return True if the id was loaded with the frozen part.
+ */
+bool TrigramIndex::isFrozenId(const quint32 id) const { return std::binary_search(m_frozenIds, m_frozenIds + m_frozenIdCount, id); }
+
+/**
+ * Collect the distinct grams of the texts of an entry.
+ *
+ * @param texts The texts of the entry in original case.
+ * @return The sorted distinct grams.
+ */
+QVector<quint64> TrigramIndex::gramsOf(const QVector<QString> &texts)
+{
+    QVector<quint64> grams;
+    for (const QString &text : texts)
+        addTextGrams(text, grams);
+
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+/**
+ * Collect the grams to look up for a query.
+ *
+ * @param query The search text.
+ * @return The sorted distinct grams; empty if the query is empty.
+ */
+QVector<quint64> TrigramIndex::gramsOfQuery(const QString &query)
+{
+    const QString lower = toLowerPerChar(query);
+    if (lower.isEmpty())
+        return {};
+    if (lower.size() == 1)
+        return {packGram(KIND_PREFIX_1, lower, 0, 1)};
+    if (lower.size() == 2)
+        return {packGram(KIND_PREFIX_2, lower, 0, 2)};
+
+    QVector<quint64> grams;
+    grams.reserve(lower.size() - 2);
+    for (qsizetype position = 0; position + 3 <= lower.size(); ++position)
+        grams.append(packGram(KIND_TRIGRAM, lower, position, 3));
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+/**
+ * Append the grams of a text: its trigrams, and the 1 and 2 character prefixes of its words.
+ *
+ * The initials of the words are indexed the same way as another text, so that
+ * "vsc" finds "Visual Studio Code".
+ *
+ * @param text A text in original case, to detect camelCase words.
+ * @param grams The list to append to.
+ */
+void TrigramIndex::addTextGrams(const QString &text, QVector<quint64> &grams)
+{
+    const QString lower = toLowerPerChar(text);
+    QString initials;
+
+    for (qsizetype position = 0; position < lower.size(); ++position)
+    {
+        if (position + 3 <= lower.size())
+            grams.append(packGram(KIND_TRIGRAM, lower, position, 3));
+
+        if (!isWordStart(text, position))
+            continue;
+        grams.append(packGram(KIND_PREFIX_1, lower, position, 1));
+        if (position + 2 <= lower.size())
+            grams.append(packGram(KIND_PREFIX_2, lower, position, 2));
+        initials.append(lower.at(position));
+    }
+
+    if (initials.size() < 2)
+        return;
+    grams.append(packGram(KIND_PREFIX_2, initials, 0, 2));
+    for (qsizetype position = 0; position + 3 <= initials.size(); ++position)
+        grams.append(packGram(KIND_TRIGRAM, initials, position, 3));
+}
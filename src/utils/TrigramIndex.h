@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+class TrigramIndex final
+{
+public:
+    void insert(quint32 id, const QVector<QString> &texts);
+    void remove(quint32 id, const QVector<QString> &texts);
+    void clear();
+    [[nodiscard]] QByteArray freeze() const;
+    bool loadFrozen(const uchar *data, qsizetype size, quint32 idBound);
+
+    [[nodiscard]] QVector<quint32> candidates(const QString &query) const;
+    [[nodiscard]] qsizetype entryCount() const;
+    [[nodiscard]] qsizetype memoryUsage() const;
+    [[nodiscard]] qsizetype frozenSize() const;
+
+private:
+    struct Posting
+    {
+        const quint32 *begin = nullptr;
+        const quint32 *end = nullptr;
+
+        [[nodiscard]] qsizetype size() const { return end - begin; }
+    };
+
+    [[nodiscard]] Posting frozenPosting(quint64 gram) const;
+    [[nodiscard]] bool isFrozenId(quint32 id) const;
+    [[nodiscard]] static QVector<quint64> gramsOf(const QVector<QString> &texts);
+    [[nodiscard]] static QVector<quint64> gramsOfQuery(const QString &query);
+    static void addTextGrams(const QString &text, QVector<quint64> &grams);
+
+    QHash<quint64, QVector<quint32>> m_postings; // The postings inserted since the frozen part was loaded.
+    QVector<quint32> m_ids;
+    QSet<quint32> m_removedIds; // The ids removed from the frozen part.
+
+    // The frozen part, a view on memory owned by the caller of loadFrozen.
+    const quint64 *m_frozenGrams = nullptr;
+    const quint32 *m_frozenIds = nullptr;
+    const quint32 *m_frozenOffsets = nullptr;
+    const quint32 *m_frozenPostings = nullptr;
+    qsizetype m_frozenGramCount = 0;
+    qsizetype m_frozenIdCount = 0;
+    qsizetype m_frozenSize = 0; // The size of the frozen block in bytes.
+};
@@ -1,24 +1,33 @@
 #include "ResultItemDelegate.h"
 #include <QAbstractItemView>
 #include <QApplication>
-#include <QFileIconProvider>
-#include <QFileInfo>
 #include <QFontMetrics>
-#include <QIcon>
 #include <QModelIndex>
 #include <QMouseEvent>
 #include <QPainter>
 #include <QPainterPath>
+#include <QPixmapCache>
 #include <QStyle>
 #include <QStyleOptionViewItem>
 #include <QVariant>
+#include <algorithm>
 #include "../common/Constants.h"
+#include "../common/IModule.h"
+#include "../core/IconCache.h"
 #include "../core/ThemeManager.h"
+#include "ResultListModel.h"
 
-ResultItemDelegate::ResultItemDelegate(QAbstractItemView *view, QObject *parent) : QStyledItemDelegate(parent)
+ResultItemDelegate::ResultItemDelegate(QAbstractItemView *view, QObject *parent) :
+    QStyledItemDelegate(parent), m_titleMetrics(m_titleFont), m_subtitleMetrics(m_subtitleFont)
 {
     // Store the abstract item view to trigger repaint.
     m_view = view;
+
+    // Repaint the placeholders once their icons are loaded.
+    connect(IconCache::instance(), &IconCache::iconReady, this, [this] { m_view->viewport()->update(); });
+
+    // Room for the rows of a full list in every state, at high DPI.
+    QPixmapCache::setCacheLimit(std::max(QPixmapCache::cacheLimit(), 32 * 1024));
 }
 
 /**
@@ -29,6 +38,9 @@ ResultItemDelegate::ResultItemDelegate(QAbstractItemView *view, QObject *parent)
  * and action buttons. Handle selection and hover states with appropriate
  * visual indications.
  *
+ * The rendered row is cached as a pixmap for each state, keyed by the row
+ * identity and width, so repainting an unchanged row is a single blit.
+ *
  * @param painter The QPainter object used for rendering the item.
  * @param option The style options for the item.
  * @param index The QModelIndex representing the item being rendered.
@@ -41,31 +53,101 @@ void ResultItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &op
         return;
     }
 
+    updateStyle(option.font);
+
     // Get the ResultItem data.
     const QVariant data = index.data(Qt::UserRole);
-
     const auto item = data.value<ResultItem>();
-
-    painter->save();
-    painter->setRenderHint(QPainter::Antialiasing);
+    const QVector<Action> &actions = IModule::actionsOf(item);
 
     const bool isHovered = option.state & QStyle::State_MouseOver;
     const bool isSelected = option.state & QStyle::State_Selected;
+    const qreal devicePixelRatio = painter->device()->devicePixelRatioF();
+
+    // Icons come from the cache only; a placeholder is painted until the icon is loaded.
+    QPixmap icon;
+    if (item.iconType == IconType::Thumbnail || item.iconType == IconType::Image)
+        icon = IconCache::instance()->icon(item.iconPath, item.iconType, ICON_SIZE, devicePixelRatio);
+
+    const QString cacheKey = QString("result|%1|%2|%3|%4|%5|%6|%7")
+                                 .arg(index.data(ResultListModel::SequenceRole).toULongLong())
+                                 .arg(option.rect.width())
+                                 .arg(isSelected ? m_selectedActionIndex + 1 : 0)
+                                 .arg(isHovered ? m_hoveredActionIndex + 1 : 0)
+                                 .arg(devicePixelRatio)
+                                 .arg(icon.cacheKey())
+                                 .arg(m_themeGeneration);
+    QPixmap row;
+    if (!QPixmapCache::find(cacheKey, &row))
+    {
+        // Rendered on the list background, so that the text keeps subpixel antialiasing.
+        row = QPixmap(option.rect.size() * devicePixelRatio);
+        row.setDevicePixelRatio(devicePixelRatio);
+        row.fill(ThemeManager::defaultBackColor());
+        QPainter rowPainter(&row);
+        rowPainter.setRenderHint(QPainter::Antialiasing);
+        paintRow(&rowPainter, QRect(QPoint(), option.rect.size()), item, actions, icon, isSelected, isHovered);
+        rowPainter.end();
+        QPixmapCache::insert(cacheKey, row);
+    }
+    painter->drawPixmap(option.rect.topLeft(), row);
+}
+
+/**
+ * Build the fonts and metrics of the rows, if the base font or the theme changed.
+ *
+ * @param baseFont The font of the view.
+ */
+void ResultItemDelegate::updateStyle(const QFont &baseFont) const
+{
+    if (m_isStyleReady && baseFont == m_baseFont && m_themeGeneration == ThemeManager::generation())
+        return;
+
+    m_baseFont = baseFont;
+    m_titleFont = baseFont;
+    m_titleFont.setBold(true);
+    m_titleFont.setPixelSize(TITLE_FONT_SIZE);
+    m_titleMetrics = QFontMetrics(m_titleFont);
+    m_subtitleFont = baseFont;
+    m_subtitleFont.setPixelSize(SUBTITLE_FONT_SIZE);
+    m_subtitleMetrics = QFontMetrics(m_subtitleFont);
+    m_glyphFont = QFont();
+    m_glyphFont.setFamily("Material Symbols Rounded");
+    m_glyphFont.setPixelSize(ICON_SIZE);
+    m_themeGeneration = ThemeManager::generation();
+    m_isStyleReady = true;
+}
+
+/**
+ * Render the content of a row: background, icon, title, subtitle and action buttons.
+ *
+ * @param painter The QPainter object used for rendering the row.
+ * @param rect The rect of the row.
+ * @param item The result item of the row.
+ * @param actions The actions of the item.
+ * @param icon The icon of a thumbnail or image item; null to draw a placeholder.
+ * @param isSelected Whether the row is selected.
+ * @param isHovered Whether the row is hovered.
+ */
+void ResultItemDelegate::paintRow(QPainter *painter, const QRect &rect, const ResultItem &item, const QVector<Action> &actions, const QPixmap &icon,
+                                  const bool isSelected, const bool isHovered) const
+{
     const bool isPrimaryHovered = isHovered && m_hoveredActionIndex == 0;
     const bool isPrimarySelected = isSelected && m_selectedActionIndex == 0;
+    const QColor textColor = isPrimarySelected ? ThemeManager::accentTextColor() : ThemeManager::defaultTextColor();
 
     // Calculate rects for different components.
-    const int visibleActionCount = (isSelected || isHovered) ? static_cast<int>(item.actions.size()) : 1; // Including the primary action.
-    const QRect iconRect = getIconRect(option.rect);
-    const QRect titleRect = getTitleRect(option.rect, visibleActionCount);
-    const QRect subtitleRect = getSubtitleRect(option.rect, visibleActionCount);
-    const QRect actionsRect = getActionsRect(option.rect, visibleActionCount);
+    const int visibleActionCount = (isSelected || isHovered) ? static_cast<int>(actions.size()) : 1; // Including the primary action.
+    const QRect iconRect = getIconRect(rect);
+    const QRect titleRect = getTitleRect(rect, visibleActionCount);
+    const QRect subtitleRect = getSubtitleRect(rect, visibleActionCount);
+    const QRect actionsRect = getActionsRect(rect, visibleActionCount);
 
     // Draw selection background if hovered or selected.
     if (isPrimaryHovered || isPrimarySelected)
     {
         QPainterPath path;
-        path.addRoundedRect(option.rect, CORNER_RADIUS_M, CORNER_RADIUS_M);
+        path.addRoundedRect(rect, CORNER_RADIUS_M, CORNER_RADIUS_M);
         painter->setPen(Qt::NoPen);
         painter->fillPath(path, isPrimarySelected ? ThemeManager::accentBackColor() : ThemeManager::activeBackColor());
         painter->drawPath(path);
@@ -75,44 +157,26 @@ void ResultItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &op
     switch (item.iconType)
     {
     case IconType::Font:
-    {
-        drawIconGlyph(painter, iconRect, item.iconGlyph, isPrimarySelected ? ThemeManager::accentTextColor() : ThemeManager::defaultTextColor());
+        drawIconGlyph(painter, iconRect, item.iconGlyph, m_glyphFont, textColor);
         break;
-    }
     case IconType::Thumbnail:
-    {
-        const QFileIconProvider iconProvider;
-        const QFileInfo iconInfo(item.iconPath);
-        const QIcon fileIcon = iconProvider.icon(iconInfo);
-        drawIcon(painter, iconRect, fileIcon);
-        break;
-    }
     case IconType::Image:
-    {
-        const QIcon imageIcon(item.iconPath);
-        drawIcon(painter, iconRect, QIcon(imageIcon));
+        if (icon.isNull())
+            drawIconGlyph(painter, iconRect, QChar(0xe66d), m_glyphFont, textColor); // Draft.
+        else
+            drawIcon(painter, iconRect, icon);
         break;
-    }
     default:
         break;
     }
 
-    // Draw title.
-    QFont titleFont = option.font;
-    titleFont.setBold(true);
-    titleFont.setPixelSize(TITLE_FONT_SIZE);
-    drawText(painter, titleRect, item.title, titleFont, isPrimarySelected ? ThemeManager::accentTextColor() : ThemeManager::defaultTextColor());
-
-    // Draw subtitle.
-    QFont subtitleFont = option.font;
-    subtitleFont.setPixelSize(SUBTITLE_FONT_SIZE);
-    drawText(painter, subtitleRect, item.subtitle, subtitleFont, isPrimarySelected ? ThemeManager::accentTextColor() : ThemeManager::defaultTextColor());
+    // Draw title and subtitle.
+    drawText(painter, titleRect, item.title, m_titleFont, m_titleMetrics, textColor);
+    drawText(painter, subtitleRect, item.subtitle, m_subtitleFont, m_subtitleMetrics, textColor);
 
     // Draw action buttons.
     if (isSelected || isHovered) // Action buttons are hidden by default.
-        drawActionButtons(painter, actionsRect, item.actions, m_selectedActionIndex, m_hoveredActionIndex, isSelected, isHovered);
-
-    painter->restore();
+        drawActionButtons(painter, actionsRect, actions, m_glyphFont, m_selectedActionIndex, m_hoveredActionIndex, isSelected, isHovered);
 }
 
 /**
@@ -159,10 +223,11 @@ bool ResultItemDelegate::editorEvent(QEvent *event, QAbstractItemModel *model, c
 
     // Get the ResultItem data.
     const QVariant data = index.data(Qt::UserRole);
-    auto item = data.value<ResultItem>();
+    const auto item = data.value<ResultItem>();
+    const QVector<Action> &actions = IModule::actionsOf(item);
 
-    const QRect actionsRect = getActionsRect(option.rect, static_cast<int>(item.actions.size()));
-    const int buttonIndex = getActionButtonIndex(mouseEvent->pos(), actionsRect, static_cast<int>(item.actions.size()));
+    const QRect actionsRect = getActionsRect(option.rect, static_cast<int>(actions.size()));
+    const int buttonIndex = getActionButtonIndex(mouseEvent->pos(), actionsRect, static_cast<int>(actions.size()));
 
     if (event->type() == QEvent::MouseMove)
     {
@@ -170,19 +235,19 @@ bool ResultItemDelegate::editorEvent(QEvent *event, QAbstractItemModel *model, c
         m_view->viewport()->update();
 
         // Emit action description for hovered action
-        if (buttonIndex >= 0 && buttonIndex < item.actions.size())
-            emit actionDescriptionChanged(item.actions[buttonIndex].description);
+        if (buttonIndex >= 0 && buttonIndex < actions.size())
+            emit actionDescriptionChanged(actions[buttonIndex].description);
         else
             emit actionDescriptionChanged("");
         return QStyledItemDelegate::editorEvent(event, model, option, index);
     }
 
-    if ((buttonIndex >= 1 && buttonIndex < item.actions.size() && event->type() == QEvent::MouseButtonPress) ||
+    if ((buttonIndex >= 1 && buttonIndex < actions.size() && event->type() == QEvent::MouseButtonPress) ||
         (buttonIndex == 0 && event->type() == QEvent::MouseButtonDblClick))
     {
-        if (item.actions[buttonIndex].handler)
+        if (actions[buttonIndex].handler)
         {
-            item.actions[buttonIndex].handler();
+            actions[buttonIndex].handler(item);
             emit hideWindow();
             return true;
         }
@@ -214,27 +279,30 @@ void ResultItemDelegate::setCurrentActionIndex(const int index) const
     {
         const QVariant data = m_view->currentIndex().data(Qt::UserRole);
         const auto item = data.value<ResultItem>();
+        const QVector<Action> &actions = IModule::actionsOf(item);
 
-        if (index >= 0 && index < item.actions.size())
-            emit const_cast<ResultItemDelegate*>(this)->actionDescriptionChanged(item.actions[index].description);
+        if (index >= 0 && index < actions.size())
+            emit const_cast<ResultItemDelegate*>(this)->actionDescriptionChanged(actions[index].description);
         else
             emit const_cast<ResultItemDelegate*>(this)->actionDescriptionChanged("");
     }
 }
 
 /**
- * Draw a QIcon at the given location.
+ * Draw an icon at the given location.
  *
  * @param painter The QPainter object used for rendering the item.
  * @param rect The QRect specifying where to paint the icon.
- * @param icon The QIcon to be rendered.
+ * @param icon The QPixmap to be rendered, centered if smaller than the rect.
  */
-void ResultItemDelegate::drawIcon(QPainter *painter, const QRect &rect, const QIcon &icon)
+void ResultItemDelegate::drawIcon(QPainter *painter, const QRect &rect, const QPixmap &icon)
 {
-    if (!icon.isNull())
-    {
-        icon.paint(painter, rect, Qt::AlignCenter);
-    }
+    if (icon.isNull())
+        return;
+
+    QRect iconRect(QPoint(), icon.deviceIndependentSize().toSize().boundedTo(rect.size()));
+    iconRect.moveCenter(rect.center());
+    painter->drawPixmap(iconRect, icon);
 }
 
 /**
@@ -242,15 +310,13 @@ void ResultItemDelegate::drawIcon(QPainter *painter, const QRect &rect, const QI
  *
  * @param painter The QPainter object used for rendering the item.
  * @param rect The QRect specifying where to paint the icon.
- * @param icon The QIcon to be rendered.
+ * @param icon The glyph to be rendered.
+ * @param font The icon font.
  * @param color The color of the icon.
  */
-void ResultItemDelegate::drawIconGlyph(QPainter *painter, const QRect &rect, const QChar &icon, const QColor &color)
+void ResultItemDelegate::drawIconGlyph(QPainter *painter, const QRect &rect, const QChar &icon, const QFont &font, const QColor &color)
 {
-    QFont iconFont;
-    iconFont.setFamily("Material Symbols Rounded");
-    iconFont.setPixelSize(ICON_SIZE);
-    painter->setFont(iconFont);
+    painter->setFont(font);
     painter->setPen(color);
     painter->drawText(rect, Qt::AlignCenter, QString(icon));
 }
@@ -262,11 +328,12 @@ void ResultItemDelegate::drawIconGlyph(QPainter *painter, const QRect &rect, con
  * @param rect The QRect specifying where to paint the text.
  * @param text The text to be rendered.
  * @param font The font of the text.
+ * @param metrics The metrics of the font.
  * @param color The color of the text.
  */
-void ResultItemDelegate::drawText(QPainter *painter, const QRect &rect, const QString &text, const QFont &font, const QColor &color)
+void ResultItemDelegate::drawText(QPainter *painter, const QRect &rect, const QString &text, const QFont &font, const QFontMetrics &metrics,
+                                  const QColor &color)
 {
-    const QFontMetrics metrics(font);
     const QString elidedText = metrics.elidedText(text, Qt::ElideRight, rect.width());
     painter->setFont(font);
     painter->setPen(color);
@@ -279,13 +346,14 @@ void ResultItemDelegate::drawText(QPainter *painter, const QRect &rect, const QS
  * @param painter The QPainter object used for rendering the item.
  * @param rect The QRect specifying where to paint the action buttons.
  * @param actions The action button structures.
+ * @param glyphFont The font of the action icons.
  * @param currentActionIndex The current action index.
  * @param hoveredActionIndex The hovered action index.
  * @param isSelected Whether the current result item is selected.
  * @param isHovered Whether the current result item is hovered.
  */
-void ResultItemDelegate::drawActionButtons(QPainter *painter, const QRect &rect, const QVector<Action> &actions, const int &currentActionIndex,
-                                           const int &hoveredActionIndex, const bool &isSelected, const bool &isHovered)
+void ResultItemDelegate::drawActionButtons(QPainter *painter, const QRect &rect, const QVector<Action> &actions, const QFont &glyphFont,
+                                           const int &currentActionIndex, const int &hoveredActionIndex, const bool &isSelected, const bool &isHovered)
 {
     if (actions.size() == 1) // Only one primary action.
         return;
@@ -312,7 +380,7 @@ void ResultItemDelegate::drawActionButtons(QPainter *painter, const QRect &rect,
         painter->drawRoundedRect(buttonRect, CORNER_RADIUS_S, CORNER_RADIUS_S);
 
         // Paint the icon separately to control the size.
-        drawIconGlyph(painter, buttonRect, actions[actionIndex].iconGlyph,
+        drawIconGlyph(painter, buttonRect, actions[actionIndex].iconGlyph, glyphFont,
                       (isSelected && currentActionIndex == actionIndex) ? ThemeManager::accentTextColor() : ThemeManager::defaultTextColor());
     }
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QFontMetrics>
 #include <QStyledItemDelegate>
 #include "../common/Action.h"
 #include "../common/ResultItem.h"
@@ -19,10 +20,14 @@ public:
     void setCurrentActionIndex(int index) const;
 
 private:
-    static void drawIcon(QPainter *painter, const QRect &rect, const QIcon &icon);
-    static void drawIconGlyph(QPainter *painter, const QRect &rect, const QChar &icon, const QColor &color);
-    static void drawText(QPainter *painter, const QRect &rect, const QString &text, const QFont &font, const QColor &color);
-    static void drawActionButtons(QPainter *painter, const QRect &rect, const QVector<Action> &actions,
+    void updateStyle(const QFont &baseFont) const;
+    void paintRow(QPainter *painter, const QRect &rect, const ResultItem &item, const QVector<Action> &actions, const QPixmap &icon, bool isSelected,
+                  bool isHovered) const;
+
+    static void drawIcon(QPainter *painter, const QRect &rect, const QPixmap &icon);
+    static void drawIconGlyph(QPainter *painter, const QRect &rect, const QChar &icon, const QFont &font, const QColor &color);
+    static void drawText(QPainter *painter, const QRect &rect, const QString &text, const QFont &font, const QFontMetrics &metrics, const QColor &color);
+    static void drawActionButtons(QPainter *painter, const QRect &rect, const QVector<Action> &actions, const QFont &glyphFont,
                                   const int &currentActionIndex = 0, const int &hoveredActionIndex = 0, const bool &isSelected = false,
                                   const bool &isHovered = false);
 
@@ -37,6 +42,16 @@ private:
     mutable int m_selectedActionIndex = 0;
     mutable int m_hoveredActionIndex = 0;
 
+    // Built once per base font and theme.
+    mutable QFont m_baseFont;
+    mutable QFont m_titleFont;
+    mutable QFont m_subtitleFont;
+    mutable QFont m_glyphFont;
+    mutable QFontMetrics m_titleMetrics;
+    mutable QFontMetrics m_subtitleMetrics;
+    mutable quint64 m_themeGeneration = 0;
+    mutable bool m_isStyleReady = false;
+
 signals:
     void hideWindow();
     void actionDescriptionChanged(const QString &description);
@@ -0,0 +1,202 @@
+#include "ResultListModel.h"
+#include <algorithm>
+#include <utility>
+#include "../core/HistoryManager.h"
+
+ResultListModel::ResultListModel(QObject *parent) : QAbstractListModel(parent) {}
+
+int ResultListModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return static_cast<int>(m_rows.size() - m_gapSize);
+}
+
+QVariant ResultListModel::data(const QModelIndex &index, const int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount())
+        return {};
+
+    const Row &row = rowAt(index.row());
+    if (role == Qt::UserRole)
+        return QVariant::fromValue(row.item);
+    if (role == SequenceRole)
+        return row.sequence;
+    if (role == Qt::DisplayRole)
+        return row.item.title;
+    return {};
+}
+
+bool ResultListModel::canFetchMore(const QModelIndex &parent) const { return !parent.isValid() && m_canFetchMore; }
+
+/**
+ * Request the next page of results, once until the modules report more again.
+ *
+ * @param parent The parent index; only the root has rows.
+ */
+void ResultListModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent))
+        return;
+    m_canFetchMore = false;
+    emit moreRequested();
+}
+
+/**
+ * Set whether a module has more results than the rows, to be fetched when the
+ * view reaches the last row.
+ *
+ * @param canFetchMore True if more results can be fetched.
+ */
+void ResultListModel::setCanFetchMore(const bool canFetchMore) { m_canFetchMore = canFetchMore; }
+
+/**
+ * Get the result item at a row.
+ *
+ * @param row A valid row index.
+ * @return A reference to the result item; invalidated by the next model change.
+ */
+const ResultItem &ResultListModel::item(const int row) const { return rowAt(row).item; }
+
+/**
+ * Set the query the next merged results answer, to boost the results usually
+ * picked after typing it.
+ *
+ * @param query The query as typed.
+ */
+void ResultListModel::setQuery(const QString &query) { m_prefixBoosts = HistoryManager::getPrefixBoosts(query); }
+
+/**
+ * Merge batches of results into the ranked rows.
+ *
+ * The rank of every result is computed once here. Each batch is sorted on its
+ * own, then all batches are merged with the existing rows in a single pass
+ * (k-way merge). Only the ranges of rows which are actually inserted are
+ * reported to the view, so rows already shown are neither moved nor re-sorted
+ * in the view; in memory, each row is moved at most once per merge.
+ *
+ * Among results with equal rank, existing rows come first, followed by the
+ * batches in the given order.
+ *
+ * @param batches The batches of results to merge.
+ */
+void ResultListModel::mergeBatches(QVector<QVector<ResultItem>> batches)
+{
+    QVector<QVector<Row>> sortedBatches;
+    sortedBatches.reserve(batches.size());
+    for (QVector<ResultItem> &batch : batches)
+    {
+        if (batch.isEmpty())
+            continue;
+
+        QVector<Row> rows;
+        rows.reserve(batch.size());
+        for (ResultItem &item : batch)
+        {
+            double rank = item.priority * item.score * HistoryManager::getHistoryScore(item.key);
+            if (!m_prefixBoosts.isEmpty() && !item.key.isEmpty())
+                rank *= m_prefixBoosts.value(HistoryManager::hashOf(item.key), 1.0);
+            rows.append({std::move(item), rank, m_nextSequence++});
+        }
+        std::sort(rows.begin(), rows.end(), ranksBefore);
+        sortedBatches.append(std::move(rows));
+    }
+
+    struct Cursor
+    {
+        int batch;
+        int position;
+    };
+    std::vector<Cursor> heap;
+    for (int batchIndex = 0; batchIndex < sortedBatches.size(); ++batchIndex)
+        heap.push_back({batchIndex, 0});
+
+    // The heap keeps the best ranked head of all batches on top.
+    const auto heapOrder = [&sortedBatches](const Cursor &left, const Cursor &right)
+    { return ranksBefore(sortedBatches[right.batch][right.position], sortedBatches[left.batch][left.position]); };
+    std::make_heap(heap.begin(), heap.end(), heapOrder);
+
+    // The existing rows are moved to the end of the grown buffer, and the gap in front of them is filled range by range,
+    // so that every row is moved at most once however many ranges are inserted.
+    const qsizetype existingCount = m_rows.size();
+    qsizetype incomingCount = 0;
+    for (const QVector<Row> &rows : std::as_const(sortedBatches))
+        incomingCount += rows.size();
+    m_rows.resize(existingCount + incomingCount);
+    std::move_backward(m_rows.begin(), m_rows.begin() + existingCount, m_rows.end());
+    m_gapStart = 0;
+    m_gapSize = incomingCount;
+
+    int row = 0;
+    while (!heap.empty())
+    {
+        // Skip the existing rows which stay in front of the next result.
+        const Row &next = sortedBatches[heap.front().batch][heap.front().position];
+        while (row < rowCount() && ranksBefore(rowAt(row), next))
+            ++row;
+
+        // Collect all results which go in front of the current row as one contiguous range.
+        QVector<Row> range;
+        while (!heap.empty())
+        {
+            if (row < rowCount() && ranksBefore(rowAt(row), sortedBatches[heap.front().batch][heap.front().position]))
+                break;
+
+            std::pop_heap(heap.begin(), heap.end(), heapOrder);
+            Cursor &cursor = heap.back();
+            range.append(std::move(sortedBatches[cursor.batch][cursor.position]));
+            if (++cursor.position < sortedBatches[cursor.batch].size())
+                std::push_heap(heap.begin(), heap.end(), heapOrder);
+            else
+                heap.pop_back();
+        }
+
+        // Close the gap up to the row, then fill its front with the range.
+        for (; m_gapStart < row; ++m_gapStart)
+            m_rows[m_gapStart] = std::move(m_rows[m_gapStart + m_gapSize]);
+        const int count = static_cast<int>(range.size());
+        beginInsertRows(QModelIndex(), row, row + count - 1);
+        std::move(range.begin(), range.end(), m_rows.begin() + row);
+        m_gapStart += count;
+        m_gapSize -= count;
+        endInsertRows();
+        row += count;
+    }
+    m_gapStart = 0;
+}
+
+/**
+ * Remove all rows; no more results can be fetched until they are reported again.
+ */
+void ResultListModel::clear()
+{
+    m_canFetchMore = false;
+    if (m_rows.isEmpty())
+        return;
+
+    beginResetModel();
+    m_rows.clear();
+    endResetModel();
+}
+
+/**
+ * Compare two rows by their precomputed sort key.
+ *
+ * @param left The first row.
+ * @param right The second row.
+ * @return True if the first row is ranked before the second.
+ */
+bool ResultListModel::ranksBefore(const Row &left, const Row &right)
+{
+    if (left.rank != right.rank)
+        return left.rank > right.rank;
+    return left.sequence < right.sequence;
+}
+
+/**
+ * Get a row by its index in the view, skipping the gap left open while batches are merged.
+ *
+ * @param row A valid row index.
+ * @return The row.
+ */
+const ResultListModel::Row &ResultListModel::rowAt(const int row) const { return m_rows.at(row < m_gapStart ? row : row + m_gapSize); }
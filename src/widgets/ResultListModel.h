@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QHash>
+#include "../common/ResultItem.h"
+
+class ResultListModel final : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    static constexpr int SequenceRole = Qt::UserRole + 1; // A number identifying the row for as long as it is in the model.
+
+    explicit ResultListModel(QObject *parent = nullptr);
+
+    [[nodiscard]] int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    [[nodiscard]] QVariant data(const QModelIndex &index, int role) const override;
+    [[nodiscard]] bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    [[nodiscard]] const ResultItem &item(int row) const;
+    void setQuery(const QString &query);
+    void mergeBatches(QVector<QVector<ResultItem>> batches);
+    void setCanFetchMore(bool canFetchMore);
+    void clear();
+
+signals:
+    void moreRequested(); // Emitted when the view needs the next page of results.
+
+private:
+    /**
+     * @struct Row
+     * @brief A result item with its sort key.
+     *
+     * The rank (priority * score * history score * prefix boost) is computed
+     * once when the row is merged. The sequence number breaks ties in arrival order.
+     */
+    struct Row
+    {
+        ResultItem item;
+        double rank = 0.0;
+        quint64 sequence = 0;
+    };
+
+    [[nodiscard]] const Row &rowAt(int row) const;
+    [[nodiscard]] static bool ranksBefore(const Row &left, const Row &right);
+
+    QVector<Row> m_rows; // While batches are merged, the rows not placed yet sit after a gap of m_gapSize rows at m_gapStart.
+    qsizetype m_gapStart = 0;
+    qsizetype m_gapSize = 0;
+    QHash<quint64, double> m_prefixBoosts; // The boosts of the keys usually picked after typing the query, by hash of key.
+    quint64 m_nextSequence = 0;
+    bool m_canFetchMore = false;
+};
@@ -0,0 +1,168 @@
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTest>
+#include <limits>
+#include <memory>
+#include "../src/modules/filesearch/FileIndexBackend.h"
+
+namespace
+{
+    /**
+     * Create an empty file, and the directories holding it.
+     *
+     * @param path The path of the file.
+     * @return True if the file was created.
+     */
+    bool createFile(const QString &path)
+    {
+        QFile file(path);
+        return QDir().mkpath(QFileInfo(path).absolutePath()) && file.open(QIODevice::WriteOnly);
+    }
+
+    quint32 countOf(FileIndexBackend &backend, const QString &text) { return backend.search(text, 0, 10, QueryToken()).totalCount; }
+} // namespace
+
+/**
+ * @class FileIndexBackendTest
+ * @brief Crawl a small tree with the built-in file index, search it, and follow its changes.
+ *
+ * The tree holds "Budget Report.xlsx", and "Meeting Notes.txt" and
+ * "Budget Draft.docx" in notes/ and notes/deep/.
+ */
+class FileIndexBackendTest final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void search_data();
+    void search();
+    void followChanges();
+    void saveAndLoad();
+    void loadCorrupted();
+
+private:
+    [[nodiscard]] std::unique_ptr<FileIndexBackend> crawledBackend() const;
+
+    std::unique_ptr<QTemporaryDir> m_root;
+    std::unique_ptr<QTemporaryDir> m_data; // Holds the saved index, away from the crawled tree.
+};
+
+void FileIndexBackendTest::init()
+{
+    m_root = std::make_unique<QTemporaryDir>();
+    m_data = std::make_unique<QTemporaryDir>();
+    QVERIFY(m_root->isValid() && m_data->isValid());
+    QVERIFY(createFile(m_root->filePath("Budget Report.xlsx")));
+    QVERIFY(createFile(m_root->filePath("notes/Meeting Notes.txt")));
+    QVERIFY(createFile(m_root->filePath("notes/deep/Budget Draft.docx")));
+}
+
+void FileIndexBackendTest::search_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<quint32>("count");
+    QTest::newRow("one word") << "budget" << 2u;
+    QTest::newRow("any case") << "BUDGET" << 2u;
+    QTest::newRow("two words") << "budget draft" << 1u;
+    QTest::newRow("files and directories") << "notes" << 2u;
+    QTest::newRow("extension") << "txt" << 1u;
+    QTest::newRow("one character") << "n" << 2u;
+    QTest::newRow("two short words") << "bu dr" << 1u;
+    QTest::newRow("short word inside a word") << "ee" << 0u;
+    QTest::newRow("short word inside a word, with a longer word") << "notes ee" << 1u;
+    QTest::newRow("no match") << "invoice" << 0u;
+}
+
+void FileIndexBackendTest::search()
+{
+    QFETCH(QString, text);
+    QFETCH(quint32, count);
+    const std::unique_ptr<FileIndexBackend> backend = crawledBackend();
+    QVERIFY(backend);
+    QCOMPARE(countOf(*backend, text), count);
+}
+
+void FileIndexBackendTest::followChanges()
+{
+    const std::unique_ptr<FileIndexBackend> backend = crawledBackend();
+    QVERIFY(backend);
+
+    QVERIFY(createFile(m_root->filePath("Invoice 42.pdf")));
+    QTRY_COMPARE(countOf(*backend, "invoice"), 1u);
+
+    QVERIFY(QDir(m_root->path()).rename("Invoice 42.pdf", "Receipt 42.pdf"));
+    QTRY_COMPARE(countOf(*backend, "receipt"), 1u);
+    QCOMPARE(countOf(*backend, "invoice"), 0u);
+
+    // A removed directory takes its content with it.
+    QVERIFY(QDir(m_root->filePath("notes")).removeRecursively());
+    QTRY_COMPARE(countOf(*backend, "notes"), 0u);
+    QCOMPARE(countOf(*backend, "draft"), 0u);
+
+    // A directory moved in arrives with its content.
+    const QTemporaryDir outside;
+    QVERIFY(createFile(outside.filePath("Archive/Scan 7.png")));
+    QVERIFY(QDir().rename(outside.filePath("Archive"), m_root->filePath("Archive")));
+    QTRY_COMPARE(countOf(*backend, "scan"), 1u);
+    QCOMPARE(countOf(*backend, "archive"), 1u);
+
+    // Files created in it afterwards are followed too.
+    QVERIFY(createFile(m_root->filePath("Archive/Scan 8.png")));
+    QTRY_COMPARE(countOf(*backend, "scan"), 2u);
+}
+
+void FileIndexBackendTest::saveAndLoad()
+{
+    {
+        const std::unique_ptr<FileIndexBackend> backend = crawledBackend();
+        QVERIFY(backend);
+        backend->recordRun(m_root->filePath("notes/deep/Budget Draft.docx"));
+    }
+    QVERIFY(QFileInfo::exists(m_data->filePath("index")));
+
+    // The saved index is searched at once, with the most run files first.
+    FileIndexBackend backend({m_root->path()}, m_data->filePath("index"));
+    backend.initialize();
+    const FileSearchResults results = backend.search("budget", 0, 10, QueryToken());
+    QCOMPARE(results.totalCount, 2u);
+    QCOMPARE(results.nameAt(0).toString(), QString("Budget Draft.docx"));
+    QCOMPARE(results.directoryAt(0).toString(), QDir::toNativeSeparators(m_root->filePath("notes/deep")));
+    QCOMPARE(results.entries.at(0).runCount, 1u);
+}
+
+void FileIndexBackendTest::loadCorrupted()
+{
+    QVERIFY(crawledBackend());
+
+    // The trigram index is the last section of the file, and its last posting holds the last id; one past every entry is out of bounds.
+    QFile file(m_data->filePath("index"));
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.seek(file.size() - static_cast<qint64>(sizeof(quint32))));
+    const quint32 id = std::numeric_limits<quint32>::max();
+    QCOMPARE(file.write(reinterpret_cast<const char *>(&id), sizeof(id)), static_cast<qint64>(sizeof(id)));
+    file.close();
+
+    // The index is crawled again instead.
+    QTest::ignoreMessage(QtWarningMsg, "File index: the saved index is corrupted, crawling again");
+    QVERIFY(crawledBackend());
+}
+
+/**
+ * Create a backend for the tree, and wait for its first crawl.
+ *
+ * @return The backend; null if the crawl did not finish in time.
+ */
+std::unique_ptr<FileIndexBackend> FileIndexBackendTest::crawledBackend() const
+{
+    auto backend = std::make_unique<FileIndexBackend>(QStringList({m_root->path()}), m_data->filePath("index"));
+    backend->initialize();
+    if (!QTest::qWaitFor([&backend] { return countOf(*backend, "budget") == 2; }))
+        return nullptr;
+    return backend;
+}
+
+QTEST_GUILESS_MAIN(FileIndexBackendTest)
+#include "FileIndexBackendTest.moc"
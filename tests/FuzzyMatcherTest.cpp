@@ -0,0 +1,69 @@
+#include <QTest>
+#include "../src/utils/FuzzyMatcher.h"
+
+/**
+ * @class FuzzyMatcherTest
+ * @brief Score patterns against app names, and compare the scores of the bonuses.
+ */
+class FuzzyMatcherTest final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void match_data();
+    void match();
+    void ranking_data();
+    void ranking();
+};
+
+void FuzzyMatcherTest::match_data()
+{
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<double>("score");
+    QTest::newRow("empty pattern") << "" << "Visual Studio Code" << 1.0;
+    QTest::newRow("prefix") << "vis" << "Visual Studio Code" << 2.0;
+    QTest::newRow("whole name") << "code" << "Code" << 2.0;
+    QTest::newRow("word after the first") << "stud" << "Visual Studio Code" << 2.0;
+    QTest::newRow("word initials") << "vsc" << "Visual Studio Code" << 1.8;
+    QTest::newRow("any case") << "VSC" << "Visual Studio Code" << 1.8;
+    QTest::newRow("character missing, rejected by the mask") << "xyz" << "Visual Studio Code" << 0.0;
+    QTest::newRow("characters out of order, rejected by the scan") << "cv" << "Visual Studio Code" << 0.0;
+    QTest::newRow("character repeated fewer times") << "visuall" << "Visual Studio Code" << 0.0;
+}
+
+void FuzzyMatcherTest::match()
+{
+    QFETCH(QString, pattern);
+    QFETCH(QString, text);
+    QFETCH(double, score);
+    QCOMPARE(FuzzyMatcher(pattern).match(FuzzyMatcher::prepare(text)), score);
+}
+
+void FuzzyMatcherTest::ranking_data()
+{
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<QString>("better");
+    QTest::addColumn<QString>("worse");
+    QTest::newRow("camelCase hump") << "fb" << "FooBar" << "Foobar";
+    QTest::newRow("camelCase hump, later") << "ps" << "PowerShell" << "Photoshop";
+    QTest::newRow("word boundary") << "code" << "Visual Studio Code" << "Unicode Tool";
+    QTest::newRow("word boundary over camelCase hump") << "code" << "Visual Studio Code" << "VisualStudioCode";
+    QTest::newRow("prefix over word initials") << "vsc" << "vscode" << "Visual Studio Code";
+    QTest::newRow("shorter gap") << "vc" << "Visual Code" << "Visual Studio Code";
+}
+
+void FuzzyMatcherTest::ranking()
+{
+    QFETCH(QString, pattern);
+    QFETCH(QString, better);
+    QFETCH(QString, worse);
+    const FuzzyMatcher matcher(pattern);
+    const double betterScore = matcher.match(FuzzyMatcher::prepare(better));
+    const double worseScore = matcher.match(FuzzyMatcher::prepare(worse));
+    QVERIFY2(worseScore > 0, qPrintable(worse));
+    QVERIFY2(betterScore > worseScore, qPrintable(QString("%1 > %2").arg(betterScore).arg(worseScore)));
+}
+
+QTEST_GUILESS_MAIN(FuzzyMatcherTest)
+#include "FuzzyMatcherTest.moc"
@@ -0,0 +1,106 @@
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTest>
+#include "../src/utils/ShellLinkParser.h"
+
+/**
+ * @class ShellLinkParserTest
+ * @brief Parse the shortcuts in data/, which cover each way a link can name its target.
+ */
+class ShellLinkParserTest final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void localPath();
+    void unicodeLocalPath();
+    void relativePath();
+    void environmentTarget();
+    void invalid_data();
+    void invalid();
+    void truncated();
+    void scanDirectories();
+};
+
+void ShellLinkParserTest::initTestCase()
+{
+    qputenv("LAUNCHER_TEST_ROOT", "D:\\Tools");
+    QVERIFY(!QFINDTESTDATA("data").isEmpty());
+}
+
+void ShellLinkParserTest::localPath()
+{
+    ShellLinkParser::ShellLink link;
+    QVERIFY(ShellLinkParser::parse(QFINDTESTDATA("data/local.lnk"), link));
+    QCOMPARE(link.targetPath, QString("C:\\Program Files\\App\\app.exe"));
+    QCOMPARE(link.arguments, QString("--new-window"));
+    QCOMPARE(link.iconLocation, QString("C:\\Program Files\\App\\app.ico"));
+    QCOMPARE(link.iconIndex, 2);
+}
+
+void ShellLinkParserTest::unicodeLocalPath()
+{
+    ShellLinkParser::ShellLink link;
+    QVERIFY(ShellLinkParser::parse(QFINDTESTDATA("data/unicode.lnk"), link));
+    QCOMPARE(link.targetPath, QStringLiteral(u"C:\\Programme\\\u00C4rzte\\\u00E9diteur.exe"));
+}
+
+void ShellLinkParserTest::relativePath()
+{
+    const QString shortcutPath = QFINDTESTDATA("data/relative.lnk");
+    ShellLinkParser::ShellLink link;
+    QVERIFY(ShellLinkParser::parse(shortcutPath, link));
+    QCOMPARE(link.targetPath, QDir::toNativeSeparators(QDir::cleanPath(QFileInfo(shortcutPath).absolutePath() + "/../App/app.exe")));
+}
+
+void ShellLinkParserTest::environmentTarget()
+{
+    ShellLinkParser::ShellLink link;
+    QVERIFY(ShellLinkParser::parse(QFINDTESTDATA("data/environment.lnk"), link));
+    QCOMPARE(link.targetPath, QString("D:\\Tools\\Tool\\tool.exe"));
+    QCOMPARE(link.iconLocation, QString("D:\\Tools\\Tool\\tool.ico"));
+}
+
+void ShellLinkParserTest::invalid_data()
+{
+    QTest::addColumn<QString>("fileName");
+    QTest::newRow("truncated in the link info") << "truncated.lnk";
+    QTest::newRow("wrong class id") << "corrupt.lnk";
+    QTest::newRow("target only in the ID list") << "idlist.lnk";
+}
+
+void ShellLinkParserTest::invalid()
+{
+    QFETCH(QString, fileName);
+    ShellLinkParser::ShellLink link;
+    QVERIFY(!ShellLinkParser::parse(QFINDTESTDATA("data/" + fileName), link));
+}
+
+void ShellLinkParserTest::truncated()
+{
+    QFile file(QFINDTESTDATA("data/local.lnk"));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray bytes = file.readAll();
+
+    // Every prefix cut before the terminal block must be rejected without reading past its end.
+    ShellLinkParser::ShellLink link;
+    for (qsizetype size = 0; size < bytes.size() - 4; ++size)
+    {
+        const QByteArray prefix = bytes.left(size); // A copy, so that sanitizers catch reads past the end.
+        QVERIFY2(!ShellLinkParser::parse(reinterpret_cast<const uchar *>(prefix.constData()), prefix.size(), link), qPrintable(QString::number(size)));
+    }
+}
+
+void ShellLinkParserTest::scanDirectories()
+{
+    const QVector<ShellLinkParser::ShellLink> links = ShellLinkParser::scanDirectories({QFINDTESTDATA("data")});
+    QStringList fileNames;
+    for (const ShellLinkParser::ShellLink &link : links)
+        fileNames.append(QFileInfo(link.shortcutPath).fileName());
+    QCOMPARE(fileNames, QStringList({"environment.lnk", "local.lnk", "relative.lnk", "unicode.lnk"}));
+}
+
+QTEST_GUILESS_MAIN(ShellLinkParserTest)
+#include "ShellLinkParserTest.moc"